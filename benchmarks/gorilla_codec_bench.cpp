@@ -0,0 +1,180 @@
+// Compression ratio and decode throughput of the Gorilla history blocks on
+// real traces. Usage:
+//   gorilla_codec_bench                  capture 30 s of live CPU/RAM/disk
+//   gorilla_codec_bench --capture N      capture N seconds
+//   gorilla_codec_bench trace.csv ...    replay recorded "timestamp_us,value" files
+#include "monitoring/collector_backend.h"
+#include "monitoring/gorilla_codec.h"
+#include "monitoring/metric_history.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Monitor;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr auto kCapturePeriod = std::chrono::milliseconds(100);
+constexpr uint32_t kRowsPerBlock = SeriesTable::kDefaultRowsPerBlock;
+constexpr size_t kMinDecodedSamples = 20'000'000;
+
+struct Trace {
+    std::string name;
+    std::vector<int64_t> timestampsUs;
+    std::vector<float> values;
+};
+
+bool LoadTrace(const char* path, Trace& trace) {
+    std::ifstream in(path);
+    if (!in) return false;
+    
+    trace.name = path;
+    std::string line;
+    while (std::getline(in, line)) {
+        long long timestamp = 0;
+        float value = 0.0f;
+        if (std::sscanf(line.c_str(), "%lld,%f", &timestamp, &value) == 2) {
+            trace.timestampsUs.push_back(timestamp);
+            trace.values.push_back(value);
+        }
+    }
+    return !trace.values.empty();
+}
+
+std::vector<Trace> CaptureTraces(int seconds) {
+    auto backend = CreateDefaultBackend();
+    std::vector<Trace> traces;
+    
+    std::vector<CPUCoreInfo> cores;
+    RAMInfo ram{};
+    std::vector<DiskInfo> disks;
+    
+    backend->CollectCPU(cores);
+    backend->CollectDisks(disks);
+    
+    traces.push_back({"ram.usedGB", {}, {}});
+    for (const auto& core : cores) {
+        traces.push_back({"cpu.core" + std::to_string(core.coreID) + ".usage", {}, {}});
+    }
+    for (const auto& disk : disks) {
+        traces.push_back({"disk." + disk.name + ".writeMBps", {}, {}});
+    }
+    
+    std::fprintf(stderr, "capturing %d s from the %s backend...\n", seconds, backend->GetName());
+    
+    auto next = Clock::now();
+    auto end = next + std::chrono::seconds(seconds);
+    while (next < end) {
+        next += kCapturePeriod;
+        std::this_thread::sleep_until(next);
+        int64_t now = MetricHistory::NowUs();
+        
+        size_t t = 0;
+        if (backend->CollectRAM(ram)) {
+            traces[t].timestampsUs.push_back(now);
+            traces[t].values.push_back(ram.usedGB);
+        }
+        t++;
+        
+        backend->CollectCPU(cores);
+        for (size_t i = 0; i < cores.size() && t < traces.size(); i++, t++) {
+            traces[t].timestampsUs.push_back(now);
+            traces[t].values.push_back(cores[i].usage);
+        }
+        
+        backend->CollectDisks(disks);
+        for (size_t i = 0; i < disks.size() && t < traces.size(); i++, t++) {
+            traces[t].timestampsUs.push_back(now);
+            traces[t].values.push_back(disks[i].writeMBps);
+        }
+    }
+    
+    return traces;
+}
+
+void Measure(const Trace& trace) {
+    size_t samples = trace.values.size();
+    
+    std::vector<CompressedBlock> blocks;
+    BlockBuilder builder(1);
+    for (size_t i = 0; i < samples; i++) {
+        builder.Append(trace.timestampsUs[i], std::span<const float>(&trace.values[i], 1));
+        if (builder.GetRowCount() >= kRowsPerBlock) blocks.push_back(builder.Seal());
+    }
+    if (builder.GetRowCount() > 0) blocks.push_back(builder.Seal());
+    
+    size_t timestampBytes = 0;
+    size_t valueBytes = 0;
+    for (const auto& block : blocks) {
+        timestampBytes += block.timestamps.size() * sizeof(uint64_t);
+        valueBytes += block.columns[0].size() * sizeof(uint64_t);
+    }
+    
+    std::vector<int64_t> decodedTimes;
+    std::vector<float> decodedValues;
+    decodedTimes.reserve(samples);
+    decodedValues.reserve(samples);
+    
+    for (const auto& block : blocks) {
+        block.DecodeColumn(0, std::numeric_limits<int64_t>::min(), decodedTimes, decodedValues);
+    }
+    
+    bool exact = decodedTimes == trace.timestampsUs &&
+                 std::memcmp(decodedValues.data(), trace.values.data(), samples * sizeof(float)) == 0;
+    
+    size_t rounds = std::max<size_t>(1, kMinDecodedSamples / samples);
+    auto start = Clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        decodedTimes.clear();
+        decodedValues.clear();
+        for (const auto& block : blocks) {
+            block.DecodeColumn(0, std::numeric_limits<int64_t>::min(), decodedTimes, decodedValues);
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    double samplesPerSec = rounds * samples / seconds;
+    
+    std::printf("%-28s %8zu samples  %5.2f B/sample (ts %4.2f + value %4.2f)  vs 12 raw  %7.1f Msamples/s decode  %s\n",
+                trace.name.c_str(), samples,
+                double(timestampBytes + valueBytes) / samples,
+                double(timestampBytes) / samples, double(valueBytes) / samples,
+                samplesPerSec / 1e6, exact ? "lossless" : "MISMATCH");
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<Trace> traces;
+    int captureSeconds = 30;
+    
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            captureSeconds = std::atoi(argv[++i]);
+            continue;
+        }
+        
+        Trace trace;
+        if (LoadTrace(argv[i], trace)) {
+            traces.push_back(std::move(trace));
+        } else {
+            std::fprintf(stderr, "skipping unreadable trace %s\n", argv[i]);
+        }
+    }
+    
+    if (traces.empty()) {
+        traces = CaptureTraces(captureSeconds);
+    }
+    
+    for (const auto& trace : traces) {
+        if (!trace.values.empty()) Measure(trace);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Record cost of the HDR histogram, single-threaded and through the shared
+// per-thread shards, plus percentile, merge and serialization costs.
+// Usage: hdr_histogram_bench [threads]
+#include "monitoring/hdr_histogram.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Monitor;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kValues = 1 << 16;
+constexpr size_t kRecordsPerThread = 50'000'000;
+
+// Latency-shaped values: mostly tens of microseconds with a long tail.
+std::vector<uint64_t> MakeValues(uint32_t seed) {
+    std::mt19937_64 rng(seed);
+    std::lognormal_distribution<double> dist(10.0, 1.0);
+    std::vector<uint64_t> values(kValues);
+    for (auto& value : values) value = static_cast<uint64_t>(dist(rng));
+    return values;
+}
+
+double NsPer(Clock::duration elapsed, size_t ops) {
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(ops);
+}
+
+void BenchPlain(const std::vector<uint64_t>& values) {
+    HdrHistogram histogram;
+    auto start = Clock::now();
+    for (size_t i = 0; i < kRecordsPerThread; i++) {
+        histogram.Record(values[i & (kValues - 1)]);
+    }
+    auto elapsed = Clock::now() - start;
+    std::printf("%-32s %6.2f ns/record  (p99 %llu)\n", "HdrHistogram::Record", NsPer(elapsed, kRecordsPerThread),
+        static_cast<unsigned long long>(histogram.ValueAtPercentile(99.0)));
+}
+
+void BenchShared(int threads) {
+    SharedHistogram histogram;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<double> nsPerRecord(threads);
+    std::vector<std::thread> workers;
+    
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            auto values = MakeValues(static_cast<uint32_t>(t + 1));
+            ready.fetch_add(1);
+            while (!go.load()) {}
+            
+            auto start = Clock::now();
+            for (size_t i = 0; i < kRecordsPerThread; i++) {
+                histogram.Record(values[i & (kValues - 1)]);
+            }
+            nsPerRecord[t] = NsPer(Clock::now() - start, kRecordsPerThread);
+        });
+    }
+    while (ready.load() < threads) {}
+    go = true;
+    for (auto& worker : workers) worker.join();
+    
+    HdrHistogram merged;
+    auto start = Clock::now();
+    histogram.Snapshot(merged);
+    auto snapshot = Clock::now() - start;
+    
+    char label[64];
+    std::snprintf(label, sizeof(label), "SharedHistogram::Record x%d", threads);
+    std::printf("%-32s %6.2f ns/record  (worst thread %.2f, snapshot %.1f us, %llu recorded)\n", label,
+        [&] { double sum = 0; for (double ns : nsPerRecord) sum += ns; return sum / threads; }(),
+        *std::max_element(nsPerRecord.begin(), nsPerRecord.end()),
+        std::chrono::duration<double, std::micro>(snapshot).count(),
+        static_cast<unsigned long long>(merged.GetCount()));
+}
+
+void BenchQueries(const std::vector<uint64_t>& values) {
+    HdrHistogram a, b;
+    for (size_t i = 0; i < kValues; i++) (i & 1 ? a : b).Record(values[i]);
+    
+    constexpr int kRounds = 10000;
+    uint64_t sink = 0;
+    
+    auto start = Clock::now();
+    for (int i = 0; i < kRounds; i++) sink += a.ValueAtPercentile(50.0 + (i % 50));
+    std::printf("%-32s %6.1f ns/query\n", "ValueAtPercentile", NsPer(Clock::now() - start, kRounds));
+    
+    HdrHistogram merged;
+    start = Clock::now();
+    for (int i = 0; i < kRounds; i++) merged.Merge(b);
+    std::printf("%-32s %6.1f ns/merge\n", "Merge", NsPer(Clock::now() - start, kRounds));
+    
+    std::vector<uint8_t> bytes;
+    start = Clock::now();
+    for (int i = 0; i < kRounds; i++) {
+        bytes.clear();
+        a.Serialize(bytes);
+    }
+    auto serialize = Clock::now() - start;
+    
+    HdrHistogram decoded;
+    start = Clock::now();
+    for (int i = 0; i < kRounds; i++) sink += decoded.Deserialize(bytes);
+    auto deserialize = Clock::now() - start;
+    
+    std::printf("%-32s %6.1f ns encode, %.1f ns decode, %zu bytes for %llu values (%s)\n", "Serialize",
+        NsPer(serialize, kRounds), NsPer(deserialize, kRounds), bytes.size(),
+        static_cast<unsigned long long>(a.GetCount()),
+        decoded.ValueAtPercentile(99.0) == a.ValueAtPercentile(99.0) ? "round-trip ok" : "ROUND-TRIP MISMATCH");
+    
+    if (sink == 42) std::printf("\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::max(1, std::atoi(argv[1])) : static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    auto values = MakeValues(1);
+    
+    BenchPlain(values);
+    BenchShared(1);
+    if (threads > 1) BenchShared(threads);
+    BenchQueries(values);
+    return 0;
+}
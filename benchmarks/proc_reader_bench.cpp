@@ -0,0 +1,248 @@
+// Cost of one procfs sample with the persistent-descriptor reader against
+// open/read/close per file, in ns and syscalls per sample. Runs on a
+// synthetic tree (a 256-CPU /proc/stat and 5,000 /proc/[pid]/stat files)
+// so the numbers do not depend on the machine, then on the live /proc.
+// Usage: proc_reader_bench [cpus] [processes] [rounds]
+#include "monitoring/backends/linux_proc_reader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Monitor;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Cost {
+    double nsPerSample = 0.0;
+    double syscallsPerSample = 0.0;
+};
+
+// Syscalls of the baseline readers, which do not go through the reader layer.
+uint64_t g_baselineSyscalls = 0;
+
+std::string MakeStat(int cpus, std::mt19937_64& rng) {
+    std::string text = "cpu  4705 356 584 3699 23 23 0 0 0 0\n";
+    for (int cpu = 0; cpu < cpus; cpu++) {
+        text += "cpu" + std::to_string(cpu);
+        for (int field = 0; field < 10; field++) text += " " + std::to_string(rng() % 100000000);
+        text += "\n";
+    }
+    text += "intr 1462898";
+    for (int irq = 0; irq < 512; irq++) text += " " + std::to_string(rng() % 1000);
+    text += "\nctxt 115315\nbtime 1769241350\nprocesses 2543\nprocs_running 3\nprocs_blocked 0\n";
+    text += "softirq 62845 0 25432 8 1374 1543 0 12 17864 0 16612\n";
+    return text;
+}
+
+std::string MakePidStat(unsigned pid, std::mt19937_64& rng) {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+                  "%u (worker %u) S 1 %u %u 0 -1 4194560 %llu 0 12 0 %llu %llu 0 0 20 0 %llu 0 %llu %llu %llu "
+                  "18446744073709551615 1 1 0 0 0 0 0 4096 1260 0 0 0 17 %llu 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+                  pid, pid, pid, pid, static_cast<unsigned long long>(rng() % 100000),
+                  static_cast<unsigned long long>(rng() % 100000), static_cast<unsigned long long>(rng() % 10000),
+                  static_cast<unsigned long long>(rng() % 64 + 1), static_cast<unsigned long long>(rng() % 1000000),
+                  static_cast<unsigned long long>(rng() % (1ull << 32)), static_cast<unsigned long long>(rng() % 100000),
+                  static_cast<unsigned long long>(rng() % 256));
+    return buffer;
+}
+
+void WriteFile(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary) << text;
+}
+
+// The pre-reader way: open, read until EOF, close, then parse with streams.
+size_t ReadFileBaseline(const char* path, int dirFd, std::vector<char>& buffer) {
+    g_baselineSyscalls++;
+    int fd = openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    
+    size_t length = 0;
+    while (true) {
+        if (length + 1 >= buffer.size()) buffer.resize(buffer.size() * 2);
+        g_baselineSyscalls++;
+        ssize_t n = read(fd, buffer.data() + length, buffer.size() - 1 - length);
+        if (n <= 0) break;
+        length += static_cast<size_t>(n);
+    }
+    g_baselineSyscalls++;
+    close(fd);
+    buffer[length] = '\0';
+    return length;
+}
+
+uint64_t ParseStatBaseline(const char* text) {
+    std::istringstream stat(text);
+    std::string line;
+    uint64_t sum = 0;
+    while (std::getline(stat, line)) {
+        if (line.rfind("cpu", 0) != 0) break;
+        std::istringstream fields(line);
+        std::string label;
+        uint64_t user = 0, nice = 0, system = 0, idle = 0;
+        fields >> label >> user >> nice >> system >> idle;
+        sum += user + nice + system + idle;
+    }
+    return sum;
+}
+
+uint64_t ParseStat(std::string_view text) {
+    uint64_t sum = 0;
+    for (const char* line = text.data(); std::strncmp(line, "cpu", 3) == 0; line = NextLine(line)) {
+        const char* cursor = line + 3;
+        SkipFields(cursor, 1);
+        for (int field = 0; field < 4; field++) sum += ScanUnsigned(cursor);
+    }
+    return sum;
+}
+
+uint64_t ParsePidStatBaseline(const char* text) {
+    const char* cursor = std::strrchr(text, ')');
+    if (!cursor) return 0;
+    uint64_t sum = 0;
+    for (int field = 3; field <= 24 && cursor; field++) {
+        cursor = std::strchr(cursor + 1, ' ');
+        if (cursor && (field == 14 || field == 15 || field == 24)) sum += std::strtoull(cursor + 1, nullptr, 10);
+    }
+    return sum;
+}
+
+uint64_t ParsePidStat(const char* text) {
+    const char* cursor = std::strrchr(text, ')') + 1;
+    SkipFields(cursor, 11);
+    uint64_t sum = ScanUnsigned(cursor) + ScanUnsigned(cursor);
+    SkipFields(cursor, 8);
+    return sum + ScanUnsigned(cursor);
+}
+
+template <typename Fn>
+Cost Measure(int rounds, size_t samplesPerRound, Fn round) {
+    uint64_t syscalls = ProcReaderSyscalls() + g_baselineSyscalls;
+    auto start = Clock::now();
+    for (int i = 0; i < rounds; i++) round();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    
+    double samples = static_cast<double>(rounds) * static_cast<double>(samplesPerRound);
+    Cost cost;
+    cost.nsPerSample = ns / samples;
+    cost.syscallsPerSample = static_cast<double>(ProcReaderSyscalls() + g_baselineSyscalls - syscalls) / samples;
+    return cost;
+}
+
+void Report(const char* label, size_t samples, const Cost& baseline, const Cost& reader) {
+    std::printf("%-30s %6zu files  open/read/close %9.0f ns %5.2f syscalls   pread %9.0f ns %5.2f syscalls  (%.1fx)\n",
+                label, samples, baseline.nsPerSample, baseline.syscallsPerSample,
+                reader.nsPerSample, reader.syscallsPerSample, baseline.nsPerSample / reader.nsPerSample);
+}
+
+void BenchStat(const char* label, const std::string& path, int rounds) {
+    std::vector<char> buffer(4096);
+    uint64_t sink = 0;
+    
+    Cost baseline = Measure(rounds, 1, [&] {
+        ReadFileBaseline(path.c_str(), AT_FDCWD, buffer);
+        sink += ParseStatBaseline(buffer.data());
+    });
+    
+    ProcFile file;
+    file.Open(path);
+    file.Read();
+    Cost reader = Measure(rounds, 1, [&] { sink += ParseStat(file.Read()); });
+    
+    Report(label, 1, baseline, reader);
+    if (sink == 42) std::printf("\n");
+}
+
+void BenchPidStats(const char* label, const char* root, int rounds) {
+    DirectoryReader dir;
+    dir.Open(root);
+    std::vector<uint32_t> ids;
+    dir.ListNumeric(ids);
+    if (ids.empty()) return;
+    
+    std::vector<char> buffer(1024);
+    uint64_t sink = 0;
+    char path[64];
+    
+    // Both sides list with getdents64, so the difference is the per-file cost.
+    Cost baseline = Measure(rounds, ids.size(), [&] {
+        dir.ListNumeric(ids);
+        for (uint32_t id : ids) {
+            std::snprintf(path, sizeof(path), "%u/stat", id);
+            if (ReadFileBaseline(path, dir.GetFd(), buffer) > 0) sink += ParsePidStatBaseline(buffer.data());
+        }
+    });
+    
+    PidFileReader reader(root, "stat", ids.size());
+    reader.Refresh();
+    for (size_t i = 0; i < reader.GetCount(); i++) reader.Read(i);
+    Cost kept = Measure(rounds, ids.size(), [&] {
+        reader.Refresh();
+        for (size_t i = 0; i < reader.GetCount(); i++) {
+            std::string_view stat = reader.Read(i);
+            if (!stat.empty()) sink += ParsePidStat(stat.data());
+        }
+    });
+    
+    Report(label, ids.size(), baseline, kept);
+    if (reader.GetOpenDescriptors() < reader.GetCount()) {
+        std::printf("%-30s only %zu of %zu descriptors kept (RLIMIT_NOFILE)\n", "", reader.GetOpenDescriptors(), reader.GetCount());
+    }
+    if (sink == 42) std::printf("\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    int cpus = argc > 1 ? std::atoi(argv[1]) : 256;
+    unsigned processes = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 5000;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 20;
+    
+    // Readers keep at most a quarter of the soft limit open by default;
+    // this program has nothing else to spend descriptors on.
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        if (limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+            getrlimit(RLIMIT_NOFILE, &limit);
+        }
+        if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur > 64) SetKeptDescriptorLimit(limit.rlim_cur - 64);
+    }
+    
+    char dirTemplate[] = "/tmp/proc_reader_bench.XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::filesystem::path root(dirTemplate);
+    
+    std::mt19937_64 rng(42);
+    WriteFile(root / "stat", MakeStat(cpus, rng));
+    for (unsigned i = 0; i < processes; i++) {
+        unsigned pid = 300 + i * 3;
+        std::filesystem::create_directory(root / std::to_string(pid));
+        WriteFile(root / std::to_string(pid) / "stat", MakePidStat(pid, rng));
+    }
+    
+    std::string statLabel = "synthetic stat, " + std::to_string(cpus) + " CPUs";
+    BenchStat(statLabel.c_str(), (root / "stat").string(), rounds * 100);
+    BenchPidStats("synthetic [pid]/stat", root.c_str(), rounds);
+    BenchStat("/proc/stat", "/proc/stat", rounds * 100);
+    BenchPidStats("/proc/[pid]/stat", "/proc", rounds * 10);
+    
+    std::filesystem::remove_all(root);
+    return 0;
+}
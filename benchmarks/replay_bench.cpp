@@ -0,0 +1,50 @@
+// Throughput of feeding a recorded session through the engine unthrottled,
+// with one subscriber taking every delivered snapshot.
+// Usage:
+//   replay_bench [directory]    replay ./telemetry-bench, as left by
+//                               telemetry_recorder_bench
+#include "monitoring/monitoring_engine.h"
+#include "monitoring/replay_backend.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace Monitor;
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char** argv) {
+    ReplayConfig config;
+    config.directory = argc > 1 ? argv[1] : "telemetry-bench";
+    config.speed = 0.0;
+    
+    auto backend = ReplayBackend::Create(config);
+    if (!backend) return 1;
+    ReplayBackend* replay = backend.get();
+    
+    auto& engine = MonitoringEngine::Get();
+    engine.SetBackend(std::move(backend));
+    
+    std::atomic<uint64_t> delivered{0};
+    int subscription = engine.Subscribe(kAllCollectors, [&](const SnapshotHandle&, CollectorMask) {
+        delivered++;
+    });
+    
+    auto start = Clock::now();
+    engine.Start();
+    while (!replay->GetProgress().finished) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    engine.Stop();
+    engine.Unsubscribe(subscription);
+    
+    ReplayProgress progress = replay->GetProgress();
+    double recorded = (progress.lastUs - progress.firstUs) / 1e6;
+    std::printf("replayed %llu records (%.1f s recorded) in %.3f s: %.0f records/s, %.0fx real time\n",
+                static_cast<unsigned long long>(progress.records), recorded, seconds, progress.records / seconds,
+                recorded / seconds);
+    std::printf("subscriber deliveries %llu\n", static_cast<unsigned long long>(delivered.load()));
+    return 0;
+}
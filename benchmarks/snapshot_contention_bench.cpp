@@ -0,0 +1,203 @@
+// Readers vs. a 100 ms collector: the old mutex-and-copy getters against
+// SnapshotPublisher. Usage: snapshot_contention_bench [seconds] [max_readers]
+#include "monitoring/snapshot_publisher.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Monitor;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr auto kCollectorPeriod = std::chrono::milliseconds(100);
+constexpr auto kCollectDuration = std::chrono::milliseconds(5);
+constexpr int kLatencySampleEvery = 16;
+
+SystemSnapshot MakeSnapshot(int cores) {
+    SystemSnapshot snapshot;
+    for (int i = 0; i < cores; i++) {
+        snapshot.cpu.push_back({.coreID = i, .frequency = 3600.0f, .temperature = 55.0f, .usage = 10.0f + i,
+                                .cState = 0.0f, .idleResidency = {}});
+    }
+    for (int i = 0; i < 4; i++) {
+        snapshot.disks.push_back({.name = "nvme" + std::to_string(i) + "n1", .readMBps = 1.0f, .writeMBps = 2.0f,
+                                  .readIOPS = 10, .writeIOPS = 20, .latencyMs = 0.1f, .temperature = 40.0f,
+                                  .usagePercent = 50.0f, .queueDepth = 0.5f, .busyPercent = 5.0f, .mountPoints = {}});
+    }
+    for (int i = 0; i < 10; i++) {
+        snapshot.processes.push_back({"process_with_a_long_name_" + std::to_string(i) + ".exe",
+                                      static_cast<unsigned long>(1000 + i), 1.0f, 0.0f, 128.0f, 12, 200});
+    }
+    snapshot.gpu.name = "Reference GPU";
+    snapshot.network.adapterName = "Ethernet";
+    return snapshot;
+}
+
+struct ReaderResult {
+    uint64_t reads = 0;
+    std::vector<int64_t> latencies;
+};
+
+struct RunResult {
+    double readsPerSec = 0.0;
+    double meanNs = 0.0;
+    int64_t p99Ns = 0;
+    int64_t maxNs = 0;
+    uint64_t dropped = 0;
+};
+
+template <typename ReadFn>
+void ReaderLoop(const std::atomic<bool>& stop, ReaderResult& result, ReadFn read) {
+    result.latencies.reserve(1 << 20);
+    volatile float sink = 0.0f;
+    
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (result.reads % kLatencySampleEvery == 0 && result.latencies.size() < result.latencies.capacity()) {
+            auto begin = Clock::now();
+            sink = sink + read();
+            result.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+        } else {
+            sink = sink + read();
+        }
+        result.reads++;
+    }
+}
+
+RunResult Summarize(std::vector<ReaderResult>& results, double seconds, double loopNs) {
+    RunResult run;
+    std::vector<int64_t> all;
+    uint64_t reads = 0;
+    for (auto& r : results) {
+        reads += r.reads;
+        all.insert(all.end(), r.latencies.begin(), r.latencies.end());
+    }
+    
+    run.readsPerSec = reads / seconds;
+    run.meanNs = loopNs;
+    if (!all.empty()) {
+        std::sort(all.begin(), all.end());
+        run.p99Ns = all[all.size() * 99 / 100];
+        run.maxNs = all.back();
+    }
+    return run;
+}
+
+RunResult RunMutexCopy(int readers, double seconds, const SystemSnapshot& source) {
+    std::mutex mutex;
+    SystemSnapshot shared = source;
+    std::atomic<bool> stop{false};
+    
+    std::thread collector([&] {
+        SystemSnapshot next = source;
+        while (!stop.load()) {
+            {
+                // The old engine held the per-metric lock for the whole query.
+                std::lock_guard<std::mutex> lock(mutex);
+                std::this_thread::sleep_for(kCollectDuration);
+                shared.cpu = next.cpu;
+                shared.disks = next.disks;
+                shared.processes = next.processes;
+            }
+            std::this_thread::sleep_for(kCollectorPeriod - kCollectDuration);
+        }
+    });
+    
+    std::vector<ReaderResult> results(readers);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; i++) {
+        threads.emplace_back([&, i] {
+            ReaderLoop(stop, results[i], [&] {
+                std::vector<CPUCoreInfo> cpu;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cpu = shared.cpu;
+                }
+                return cpu.empty() ? 0.0f : cpu[0].usage;
+            });
+        });
+    }
+    
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& t : threads) t.join();
+    collector.join();
+    
+    uint64_t reads = 0;
+    for (auto& r : results) reads += r.reads;
+    return Summarize(results, seconds, reads ? seconds * 1e9 * readers / reads : 0.0);
+}
+
+RunResult RunSnapshot(int readers, double seconds, const SystemSnapshot& source) {
+    SnapshotPublisher publisher;
+    std::atomic<bool> stop{false};
+    
+    std::thread collector([&] {
+        SystemSnapshot staging = source;
+        while (!stop.load()) {
+            std::this_thread::sleep_for(kCollectDuration);
+            if (SystemSnapshot* slot = publisher.BeginWrite()) {
+                slot->cpu = staging.cpu;
+                slot->disks = staging.disks;
+                slot->processes = staging.processes;
+                publisher.Publish();
+            }
+            std::this_thread::sleep_for(kCollectorPeriod - kCollectDuration);
+        }
+    });
+    
+    std::vector<ReaderResult> results(readers);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; i++) {
+        threads.emplace_back([&, i] {
+            ReaderLoop(stop, results[i], [&] {
+                auto snapshot = publisher.Acquire();
+                return snapshot->cpu.empty() ? 0.0f : snapshot->cpu[0].usage;
+            });
+        });
+    }
+    
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& t : threads) t.join();
+    collector.join();
+    
+    uint64_t reads = 0;
+    for (auto& r : results) reads += r.reads;
+    RunResult run = Summarize(results, seconds, reads ? seconds * 1e9 * readers / reads : 0.0);
+    run.dropped = publisher.GetDroppedCount();
+    return run;
+}
+
+void Print(const char* name, int readers, const RunResult& r) {
+    std::printf("%-12s readers=%-3d %14.0f reads/s  %9.1f ns/read  p99=%7lld ns  max=%9lld ns  dropped=%llu\n",
+                name, readers, r.readsPerSec, r.meanNs,
+                static_cast<long long>(r.p99Ns), static_cast<long long>(r.maxNs),
+                static_cast<unsigned long long>(r.dropped));
+}
+
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+    int maxReaders = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    
+    SystemSnapshot source = MakeSnapshot(32);
+    
+    std::printf("collector: %lld ms period, %lld ms collection; %d cores per snapshot\n",
+                static_cast<long long>(kCollectorPeriod.count()),
+                static_cast<long long>(kCollectDuration.count()),
+                static_cast<int>(source.cpu.size()));
+    
+    for (int readers = 1; readers <= maxReaders; readers *= 2) {
+        Print("mutex+copy", readers, RunMutexCopy(readers, seconds, source));
+        Print("snapshot", readers, RunSnapshot(readers, seconds, source));
+    }
+    
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Size and cost of recording the live engine to telemetry segments, and how
+// long reading it back takes for the whole recording versus a short range.
+// Usage:
+//   telemetry_recorder_bench                 record 30 s into ./telemetry-bench
+//   telemetry_recorder_bench N [directory]   record N seconds
+#include "monitoring/monitoring_engine.h"
+#include "monitoring/telemetry_reader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+using namespace Monitor;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct ReadResult {
+    size_t records = 0;
+    double ms = 0.0;
+};
+
+ReadResult TimeRead(const TelemetryReader& reader, int64_t fromUs, int64_t toUs) {
+    ReadResult result;
+    auto start = Clock::now();
+    reader.ReadRange(fromUs, toUs, [&](int64_t, CollectorMask, const SystemSnapshot&) {
+        result.records++;
+        return true;
+    });
+    result.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 30;
+    std::string directory = argc > 2 ? argv[2] : "telemetry-bench";
+    std::filesystem::remove_all(directory);
+    
+    auto& engine = MonitoringEngine::Get();
+    engine.Start(250);
+    
+    RecorderConfig config;
+    config.directory = directory;
+    if (!engine.StartRecording(config)) return 1;
+    
+    std::fprintf(stderr, "recording %d s from the %s backend...\n", seconds, engine.GetBackendName());
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    
+    engine.StopRecording();
+    engine.Stop();
+    
+    RecorderStats stats = engine.GetRecordingStats();
+    std::printf("records %llu (%llu keyframes), coalesced publishes %llu, failures %llu\n",
+                static_cast<unsigned long long>(stats.records), static_cast<unsigned long long>(stats.keyframes),
+                static_cast<unsigned long long>(stats.coalesced), static_cast<unsigned long long>(stats.failures));
+    std::printf("%.1f KB/s, %.0f bytes per record\n", stats.bytes / 1024.0 / seconds,
+                stats.records ? static_cast<double>(stats.bytes) / stats.records : 0.0);
+    
+    TelemetryReader reader;
+    if (!reader.Open(directory)) return 1;
+    
+    int64_t first = reader.GetFirstTimestampUs();
+    int64_t last = reader.GetLastTimestampUs();
+    ReadResult whole = TimeRead(reader, first, last);
+    ReadResult tail = TimeRead(reader, last - 1000000, last);
+    
+    std::printf("read all: %zu records in %.2f ms\n", whole.records, whole.ms);
+    std::printf("read last second: %zu records in %.2f ms\n", tail.records, tail.ms);
+    return 0;
+}
@@ -3,14 +3,92 @@
 #include "../optimizers/thread_optimizer.h"
 #include <spdlog/spdlog.h>
 #include <algorithm>
+#include <cmath>
 
 namespace Optimizer {
 
+namespace {
+
+constexpr int64_t kLoadWindowUs = 60ll * 1000 * 1000;
+constexpr int64_t kTrendWindowUs = 3600ll * 1000 * 1000;
+
+// Remote-memory check: only a process this busy is worth a page-table walk,
+// and only this much remote memory is worth moving it.
+constexpr float kHotProcessCpu = 25.0f;
+constexpr float kRemoteMemoryPercent = 50.0f;
+
+// Share of wall time a cgroup may spend held back by its CPU quota.
+constexpr float kCgroupThrottlePercent = 10.0f;
+
+}
+
 AIAnalyzer& AIAnalyzer::Get() {
     static AIAnalyzer instance;
     return instance;
 }
 
+AIAnalyzer::AIAnalyzer() {
+    using Monitor::CollectorBit;
+    using Monitor::CollectorId;
+    
+    auto groups = CollectorBit(CollectorId::CPU) | CollectorBit(CollectorId::RAM) | CollectorBit(CollectorId::Pressure) |
+        CollectorBit(CollectorId::Process) | CollectorBit(CollectorId::Cgroups);
+        
+    auto update = [this](const Monitor::SnapshotHandle& snapshot, Monitor::CollectorMask changed) {
+        std::lock_guard<std::mutex> lock(m_sampleMutex);
+        
+        if ((changed & CollectorBit(CollectorId::CPU)) && !snapshot->cpu.empty()) {
+            float totalUsage = 0.0f;
+            for (const auto& core : snapshot->cpu) {
+                totalUsage += core.usage;
+            }
+            m_sample.cpuUsage = totalUsage / snapshot->cpu.size();
+        }
+        
+        if (changed & CollectorBit(CollectorId::RAM)) {
+            m_sample.ramUsagePercent = snapshot->ram.usagePercent;
+        }
+        
+        // Usage says how busy a resource is; pressure says whether work
+        // is actually waiting for it. Empty on platforms without stall
+        // accounting.
+        if ((changed & CollectorBit(CollectorId::Pressure)) && !snapshot->pressure.empty()) {
+            const auto& system = snapshot->pressure.front();
+            m_sample.cpuPressure = system[Monitor::PressureResource::CPU].someAvg10;
+            m_sample.memoryPressure = system[Monitor::PressureResource::Memory].someAvg10;
+            m_sample.ioPressure = system[Monitor::PressureResource::IO].someAvg10;
+        }
+        
+        if (changed & CollectorBit(CollectorId::Process)) {
+            const auto& processes = snapshot->processes;
+            m_sample.hottestPid = processes.empty() ? 0 : processes.front().pid;
+            m_sample.hottestName = processes.empty() ? std::string() : processes.front().name;
+            m_sample.hottestCpu = processes.empty() ? 0.0f : processes.front().cpuUsage;
+        }
+        
+        if (changed & CollectorBit(CollectorId::Cgroups)) {
+            m_sample.throttledCgroup.clear();
+            m_sample.cgroupThrottledPercent = 0.0f;
+            for (const auto& group : snapshot->cgroups) {
+                if (group.throttledPercent > m_sample.cgroupThrottledPercent) {
+                    m_sample.throttledCgroup = group.path;
+                    m_sample.cgroupThrottledPercent = group.throttledPercent;
+                }
+            }
+        }
+    };
+    
+    // Seeded here so an analysis right after construction does not see
+    // zeros while the first delivery is still on its way.
+    auto& engine = Monitor::MonitoringEngine::Get();
+    update(engine.GetSnapshot(), Monitor::kAllCollectors);
+    m_subscription = engine.Subscribe(groups, update);
+}
+
+AIAnalyzer::~AIAnalyzer() {
+    Monitor::MonitoringEngine::Get().Unsubscribe(m_subscription);
+}
+
 bool AIAnalyzer::IsGamingProcess(const std::string& processName) {
     std::string lowerName = processName;
     std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
@@ -70,20 +148,71 @@ void AIAnalyzer::AnalyzeProcesses(SystemAnalysisResult& result) {
 }
 
 void AIAnalyzer::AnalyzeResources(SystemAnalysisResult& result) {
-    auto cpuInfo = Monitor::MonitoringEngine::Get().GetCPUInfo();
-    auto ramInfo = Monitor::MonitoringEngine::Get().GetRAMInfo();
+    auto& engine = Monitor::MonitoringEngine::Get();
+    ResourceSample sample;
+    {
+        std::lock_guard<std::mutex> lock(m_sampleMutex);
+        sample = m_sample;
+    }
     
-    if (!cpuInfo.empty()) {
+    // Judge sustained load rather than a single sample when history exists.
+    Monitor::RingSpan<float> recentUsage;
+    if (auto cpuHistory = engine.GetHistory().Find("cpu.usage")) {
+        recentUsage = cpuHistory.ReadSince(Monitor::MetricHistory::NowUs() - kLoadWindowUs).values;
+    }
+    
+    if (!recentUsage.empty()) {
         float totalUsage = 0.0f;
-        for (const auto& core : cpuInfo) {
-            totalUsage += core.usage;
-        }
-        result.cpuUsage = totalUsage / cpuInfo.size();
+        recentUsage.ForEach([&](float usage) { totalUsage += usage; });
+        result.cpuUsage = totalUsage / recentUsage.size();
     } else {
-        result.cpuUsage = 0.0f;
+        result.cpuUsage = sample.cpuUsage;
+    }
+    
+    // Hour-long trend from the minute rollups; falls back to recent load
+    // until the first minute bucket closes.
+    result.cpuUsageLastHour = result.cpuUsage;
+    if (auto cpuHistory = engine.GetHistory().Find("cpu.usage")) {
+        auto minutes = cpuHistory.ReadRollup(Monitor::RollupLevel::Minute, Monitor::MetricHistory::NowUs() - kTrendWindowUs);
+        double weightedSum = 0.0;
+        uint64_t samples = 0;
+        for (size_t i = 0; i < minutes.counts.size(); i++) {
+            float avg = minutes.avg[i];
+            if (!std::isnan(avg)) {
+                weightedSum += static_cast<double>(avg) * minutes.counts[i];
+                samples += minutes.counts[i];
+            }
+        }
+        if (samples > 0) {
+            result.cpuUsageLastHour = static_cast<float>(weightedSum / samples);
+        }
     }
     
-    result.ramUsagePercent = ramInfo.usagePercent;
+    result.ramUsagePercent = sample.ramUsagePercent;
+    result.cpuPressure = sample.cpuPressure;
+    result.memoryPressure = sample.memoryPressure;
+    result.ioPressure = sample.ioPressure;
+    
+    auto topology = engine.GetTopology();
+    result.cpuTopology = topology->GetFingerprint();
+    result.hybridCpu = topology->IsHybrid();
+    result.performanceCores = static_cast<int>(std::count_if(topology->GetCores().begin(), topology->GetCores().end(),
+        [](const Monitor::PhysicalCore& core) { return core.coreClass == Monitor::CoreClass::Performance; }));
+    
+    result.throttledCgroup = sample.throttledCgroup;
+    result.cgroupThrottledPercent = sample.cgroupThrottledPercent;
+    
+    // Cross-node traffic is invisible in usage numbers; check where the
+    // busiest process's memory lives relative to where it runs.
+    result.numaNodes = static_cast<int>(topology->GetNodes().size());
+    if (result.numaNodes > 1 && sample.hottestPid != 0 && sample.hottestCpu > kHotProcessCpu) {
+        Monitor::ProcessNumaInfo numa;
+        if (engine.QueryProcessNuma(sample.hottestPid, numa) && numa.homeNode >= 0) {
+            result.remoteMemoryProcess = sample.hottestName;
+            result.remoteMemoryPercent = numa.remotePercent;
+            result.remoteMemoryHomeNode = numa.homeNode;
+        }
+    }
 }
 
 void AIAnalyzer::GenerateRecommendationsFromAnalysis(SystemAnalysisResult& result) {
@@ -97,6 +226,18 @@ void AIAnalyzer::GenerateRecommendationsFromAnalysis(SystemAnalysisResult& resul
         result.recommendations.push_back(rec);
     }
     
+    // The scheduler may park a game's threads on efficiency cores while
+    // they look idle between frames.
+    if (result.hasGamingProcess && result.hybridCpu) {
+        Recommendation rec;
+        rec.type = RecommendationType::GamingOptimization;
+        rec.title = "Hybrid CPU";
+        rec.description = "Restrict the game to the " + std::to_string(result.performanceCores) + " performance cores and leave the efficiency cores to background work.";
+        rec.priority = 9;
+        rec.canAutoApply = false;
+        result.recommendations.push_back(rec);
+    }
+    
     if (result.hasStreamingProcess) {
         Recommendation rec;
         rec.type = RecommendationType::StreamingOptimization;
@@ -107,7 +248,15 @@ void AIAnalyzer::GenerateRecommendationsFromAnalysis(SystemAnalysisResult& resul
         result.recommendations.push_back(rec);
     }
     
-    if (result.ramUsagePercent > 80.0f) {
+    if (result.memoryPressure > 10.0f) {
+        Recommendation rec;
+        rec.type = RecommendationType::MemoryOptimization;
+        rec.title = "Memory Stalls";
+        rec.description = "Tasks were stalled on memory " + std::to_string((int)result.memoryPressure) + "% of the last 10 seconds. Close memory-heavy applications or clear the standby list.";
+        rec.priority = 8;
+        rec.canAutoApply = false;
+        result.recommendations.push_back(rec);
+    } else if (result.ramUsagePercent > 80.0f) {
         Recommendation rec;
         rec.type = RecommendationType::MemoryOptimization;
         rec.title = "High Memory Usage";
@@ -117,6 +266,26 @@ void AIAnalyzer::GenerateRecommendationsFromAnalysis(SystemAnalysisResult& resul
         result.recommendations.push_back(rec);
     }
     
+    if (result.remoteMemoryPercent > kRemoteMemoryPercent) {
+        Recommendation rec;
+        rec.type = RecommendationType::MemoryOptimization;
+        rec.title = "Remote NUMA Memory";
+        rec.description = result.remoteMemoryProcess + " runs on NUMA node " + std::to_string(result.remoteMemoryHomeNode) + " but " + std::to_string((int)result.remoteMemoryPercent) + "% of its memory is on other nodes. Restrict it to the CPUs of one node and restart it so its memory follows.";
+        rec.priority = 7;
+        rec.canAutoApply = false;
+        result.recommendations.push_back(rec);
+    }
+    
+    if (result.cgroupThrottledPercent > kCgroupThrottlePercent) {
+        Recommendation rec;
+        rec.type = RecommendationType::WorkstationOptimization;
+        rec.title = "CPU Quota Starvation";
+        rec.description = result.throttledCgroup + " was held off the CPU by its quota " + std::to_string((int)result.cgroupThrottledPercent) + "% of the time. Raise its CPUQuota or cpu.max if it is meant to keep up.";
+        rec.priority = 7;
+        rec.canAutoApply = false;
+        result.recommendations.push_back(rec);
+    }
+    
     if (result.cpuUsage > 70.0f) {
         Recommendation rec;
         rec.type = RecommendationType::PowerOptimization;
@@ -125,9 +294,17 @@ void AIAnalyzer::GenerateRecommendationsFromAnalysis(SystemAnalysisResult& resul
         rec.priority = 6;
         rec.canAutoApply = true;
         result.recommendations.push_back(rec);
+    } else if (result.cpuPressure > 20.0f) {
+        Recommendation rec;
+        rec.type = RecommendationType::PowerOptimization;
+        rec.title = "CPU Contention";
+        rec.description = "Tasks waited for a CPU " + std::to_string((int)result.cpuPressure) + "% of the last 10 seconds despite moderate usage. Ensure core parking is disabled and check process affinity.";
+        rec.priority = 6;
+        rec.canAutoApply = true;
+        result.recommendations.push_back(rec);
     }
     
-    if (!result.hasGamingProcess && !result.hasStreamingProcess && result.cpuUsage < 30.0f) {
+    if (!result.hasGamingProcess && !result.hasStreamingProcess && result.cpuUsage < 30.0f && result.cpuUsageLastHour < 30.0f && result.cpuPressure < 5.0f) {
         Recommendation rec;
         rec.type = RecommendationType::WorkstationOptimization;
         rec.title = "Low System Load";
@@ -1,4 +1,5 @@
 #pragma once
+#include <mutex>
 #include <string>
 #include <vector>
 #include <Windows.h>
@@ -24,7 +25,20 @@ struct Recommendation {
 
 struct SystemAnalysisResult {
     float cpuUsage;
+    float cpuUsageLastHour;
     float ramUsagePercent;
+    float cpuPressure;       // % of time some task waited for a CPU (10 s average)
+    float memoryPressure;    // % of time some task stalled on memory reclaim
+    float ioPressure;
+    std::string cpuTopology;  // CpuTopology::GetFingerprint
+    bool hybridCpu;
+    int performanceCores;
+    int numaNodes;
+    std::string remoteMemoryProcess;  // busiest process, when its memory was checked
+    float remoteMemoryPercent;        // of its resident memory off its home node
+    int remoteMemoryHomeNode;
+    std::string throttledCgroup;      // most CPU-quota-throttled cgroup
+    float cgroupThrottledPercent;
     int processCount;
     bool hasGamingProcess;
     bool hasStreamingProcess;
@@ -43,11 +57,31 @@ public:
     bool IsStreamingProcess(const std::string& processName);
     
 private:
-    AIAnalyzer() = default;
+    AIAnalyzer();
+    ~AIAnalyzer();
+    
+    // Latest values of the snapshot fields the analysis reads, kept current
+    // by a monitoring subscription rather than fetched on every run.
+    struct ResourceSample {
+        float cpuUsage = 0.0f;
+        float ramUsagePercent = 0.0f;
+        float cpuPressure = 0.0f;
+        float memoryPressure = 0.0f;
+        float ioPressure = 0.0f;
+        std::string throttledCgroup;
+        float cgroupThrottledPercent = 0.0f;
+        unsigned long hottestPid = 0;
+        std::string hottestName;
+        float hottestCpu = 0.0f;
+    };
     
     void AnalyzeProcesses(SystemAnalysisResult& result);
     void AnalyzeResources(SystemAnalysisResult& result);
     void GenerateRecommendationsFromAnalysis(SystemAnalysisResult& result);
+    
+    int m_subscription = 0;
+    std::mutex m_sampleMutex;
+    ResourceSample m_sample;
 };
 
 }
@@ -5,12 +5,17 @@
 #include <imgui_internal.h>
 #include <d3d11.h>
 #include <tchar.h>
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 
 #undef min
 #undef max
 
 #include "monitoring/monitoring_engine.h"
+#include "monitoring/hdr_histogram.h"
+#include "monitoring/replay_backend.h"
 #include "optimizers/profile_manager.h"
 #include "optimizers/thread_optimizer.h"
 #include "optimizers/timer_optimizer.h"
@@ -22,6 +27,7 @@ static ID3D11DeviceContext*     g_pd3dDeviceContext = nullptr;
 static IDXGISwapChain*          g_pSwapChain = nullptr;
 static UINT                     g_ResizeWidth = 0, g_ResizeHeight = 0;
 static ID3D11RenderTargetView*  g_mainRenderTargetView = nullptr;
+static Monitor::SharedHistogram g_frameTimesUs;
 
 bool CreateDeviceD3D(HWND hWnd);
 void CleanupDeviceD3D();
@@ -36,16 +42,52 @@ namespace Colors {
     ImVec4 border = ImColor(40, 40, 42);
     ImVec4 text = ImColor(220, 220, 220);
     ImVec4 textDim = ImColor(150, 150, 150);
+    ImVec4 warning = ImColor(255, 180, 50);
 }
 
 int currentTab = 0;
+int pollingRate = 1000;
+
+// Subscribes to what the visible page reads at the chosen refresh rate. A
+// minimized window drops to a 5 s tick, which keeps history continuous.
+void UpdateMonitoringDemand(int subscription, bool minimized) {
+    using Monitor::CollectorBit;
+    using Monitor::CollectorId;
+    
+    static int lastTab = -1;
+    static int lastInterval = -1;
+    int interval = minimized ? 5000 : pollingRate;
+    if (currentTab == lastTab && interval == lastInterval) return;
+    lastTab = currentTab;
+    lastInterval = interval;
+    
+    Monitor::CollectorMask groups = 0;
+    switch (currentTab) {
+        case 0:
+            groups = CollectorBit(CollectorId::CPU) | CollectorBit(CollectorId::GPU) | CollectorBit(CollectorId::RAM) |
+                CollectorBit(CollectorId::Disk) | CollectorBit(CollectorId::Network) | CollectorBit(CollectorId::Thermal) |
+                CollectorBit(CollectorId::Numa);
+            break;
+        case 1:
+            groups = CollectorBit(CollectorId::Process) | CollectorBit(CollectorId::Cgroups) | CollectorBit(CollectorId::Numa) |
+                CollectorBit(CollectorId::Threads);
+            break;
+        default:
+            break;
+    }
+    
+    auto& engine = Monitor::MonitoringEngine::Get();
+    engine.SetSubscriptionGroups(subscription, groups);
+    engine.SetSubscriptionInterval(subscription, std::chrono::milliseconds(interval));
+}
 
 void RenderDashboard() {
     ImGui::BeginChild("Dashboard", ImVec2(0, 0), false);
     
-    auto cpuInfo = Monitor::MonitoringEngine::Get().GetCPUInfo();
-    auto gpuInfo = Monitor::MonitoringEngine::Get().GetGPUInfo();
-    auto ramInfo = Monitor::MonitoringEngine::Get().GetRAMInfo();
+    auto snapshot = Monitor::MonitoringEngine::Get().GetSnapshot();
+    const auto& cpuInfo = snapshot->cpu;
+    const auto& gpuInfo = snapshot->gpu;
+    const auto& ramInfo = snapshot->ram;
     
     ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[0]);
     ImGui::TextColored(Colors::text, "PC Optimizer Premium - Dashboard");
@@ -71,6 +113,14 @@ void RenderDashboard() {
         ImGui::Text("Cores: %d", (int)cpuInfo.size());
         ImGui::Text("Average Usage: %.1f%%", avgUsage);
         
+        const auto& thermal = snapshot->thermal;
+        if (thermal.throttling) {
+            ImGui::TextColored(Colors::warning, "Package: %.1f C  THROTTLING (%llu events)",
+                               thermal.packageTemperature, (unsigned long long)thermal.throttleEvents);
+        } else if (!thermal.sensors.empty()) {
+            ImGui::Text("Package: %.1f C", thermal.packageTemperature);
+        }
+        
         ImGui::Spacing();
         ImGui::Text("Per-Core Usage:");
         for (size_t i = 0; i < cpuInfo.size() && i < 16; i++) {
@@ -98,12 +148,58 @@ void RenderDashboard() {
     
     ImGui::Spacing();
     
-    ImGui::BeginChild("RAMPanel", ImVec2(0, 150), true);
+    // Single-node machines have nothing to compare, so nodes are listed
+    // only on multi-socket systems.
+    const auto& numaNodes = snapshot->numa;
+    float numaHeight = numaNodes.size() > 1 ? ImGui::GetTextLineHeightWithSpacing() * numaNodes.size() : 0.0f;
+    
+    ImGui::BeginChild("RAMPanel", ImVec2(0, 190 + numaHeight), true);
     ImGui::TextColored(Colors::accent, "RAM Monitor");
     ImGui::Separator();
     ImGui::Text("Total: %.1f GB", ramInfo.totalGB);
     ImGui::Text("Used: %.1f GB (%.1f%%)", ramInfo.usedGB, ramInfo.usagePercent);
     ImGui::ProgressBar(ramInfo.usagePercent / 100.0f, ImVec2(-1, 24));
+    ImGui::Text("Cache: %.1f GB   Kernel: %.2f GB   Dirty: %.0f MB", ramInfo.cachedGB, ramInfo.slabGB, ramInfo.dirtyMB);
+    ImGui::Text("Commit: %.1f / %.1f GB", ramInfo.committedGB, ramInfo.commitLimitGB);
+    
+    // Sustained swap-in means the working set no longer fits in RAM.
+    ImVec4 swapColor = ramInfo.swapInMBps > 1.0f ? Colors::warning : Colors::text;
+    ImGui::TextColored(swapColor, "Swap: %.1f / %.1f GB   in %.1f MB/s   out %.1f MB/s",
+        ramInfo.swapUsedGB, ramInfo.swapTotalGB, ramInfo.swapInMBps, ramInfo.swapOutMBps);
+    
+    if (numaNodes.size() > 1) {
+        for (const auto& node : numaNodes) {
+            // Misses are allocations that spilled over from a full node.
+            ImVec4 nodeColor = node.missesPerSec > 0.0f ? Colors::warning : Colors::text;
+            ImGui::TextColored(nodeColor, "Node %d: %.1f / %.1f GB   local %.0f/s   spilled %.0f/s   remote %.0f/s",
+                node.node, node.usedGB, node.totalGB, node.hitsPerSec, node.missesPerSec, node.remotePerSec);
+        }
+    }
+    ImGui::EndChild();
+    
+    ImGui::Spacing();
+    
+    ImGui::BeginChild("StoragePanel", ImVec2(0, 150), true);
+    ImGui::TextColored(Colors::accent, "Storage Monitor");
+    ImGui::Separator();
+    
+    if (!snapshot->disks.empty()) {
+        for (const auto& disk : snapshot->disks) {
+            std::string mounts;
+            for (const auto& mount : disk.mountPoints) {
+                mounts += (mounts.empty() ? "" : ", ") + mount;
+            }
+            
+            // A saturated disk shows as high busy time with a growing queue.
+            ImVec4 color = disk.busyPercent > 90.0f ? Colors::warning : Colors::text;
+            ImGui::TextColored(color, "%s (%s)", disk.name.c_str(), mounts.empty() ? "not mounted" : mounts.c_str());
+            ImGui::Text("  R %.1f MB/s  W %.1f MB/s  %d IOPS  %.1f ms  queue %.1f  busy %.0f%%",
+                        disk.readMBps, disk.writeMBps, disk.readIOPS + disk.writeIOPS,
+                        disk.latencyMs, disk.queueDepth, disk.busyPercent);
+        }
+    } else {
+        ImGui::TextColored(Colors::textDim, "No storage data available");
+    }
     ImGui::EndChild();
     
     ImGui::Spacing();
@@ -194,6 +290,26 @@ void RenderPerformance() {
             spdlog::info("Reset timer resolution to default");
         }
         
+        ImGui::Spacing();
+        
+        // Wakeup jitter is what a timer-resolution change is meant to improve.
+        auto& engine = Monitor::MonitoringEngine::Get();
+        if (!engine.IsLatencyProbeRunning()) {
+            if (ImGui::Button("Start Latency Probe", ImVec2(200, 30))) {
+                engine.StartLatencyProbe();
+            }
+        } else {
+            if (ImGui::Button("Stop Latency Probe", ImVec2(200, 30))) {
+                engine.StopLatencyProbe();
+            }
+            
+            for (const auto& cpu : engine.GetSnapshot()->latency) {
+                ImVec4 color = cpu.p99Us > 1000.0f ? Colors::warning : Colors::text;
+                ImGui::TextColored(color, "  CPU %2d  p50 %7.1f us  p99 %7.1f us  p99.9 %7.1f us  max %7.1f us",
+                                   cpu.cpu, cpu.p50Us, cpu.p99Us, cpu.p999Us, cpu.maxUs);
+            }
+        }
+        
         ImGui::Unindent();
         ImGui::Spacing();
     }
@@ -274,6 +390,72 @@ void RenderPerformance() {
         
         ImGui::TextColored(Colors::textDim, "Process affinity and priority controls");
         ImGui::TextColored(Colors::textDim, "Use Process Monitor tab to select and optimize specific processes");
+        ImGui::Spacing();
+        
+        static unsigned long selectedPid = 0;
+        static bool groupByCgroup = false;
+        auto processSnapshot = Monitor::MonitoringEngine::Get().GetSnapshot();
+        
+        auto processRow = [](const Monitor::ProcessInfo& process) {
+            char label[160];
+            snprintf(label, sizeof(label), "%-24s %6lu  %5.1f%%  %7.0f MB", process.name.c_str(), process.pid,
+                process.cpuUsage, process.memoryMB);
+            if (ImGui::Selectable(label, selectedPid == process.pid)) selectedPid = process.pid;
+        };
+        
+        if (!processSnapshot->cgroups.empty()) {
+            ImGui::Checkbox("Group by cgroup", &groupByCgroup);
+        }
+        
+        if (groupByCgroup && !processSnapshot->cgroups.empty()) {
+            // Group totals come from the kernel's own accounting, so they
+            // include processes below the top list and ones already gone.
+            std::vector<const Monitor::CgroupInfo*> groups;
+            for (const auto& group : processSnapshot->cgroups) {
+                if (!group.pids.empty()) groups.push_back(&group);
+            }
+            std::sort(groups.begin(), groups.end(), [](const Monitor::CgroupInfo* a, const Monitor::CgroupInfo* b) {
+                return a->cpuPercent > b->cpuPercent;
+            });
+            if (groups.size() > 10) groups.resize(10);
+            
+            for (const auto* group : groups) {
+                // Any throttling means the group ran into its CPU quota.
+                ImGui::PushStyleColor(ImGuiCol_Text, group->throttledPercent > 0.0f ? Colors::warning : Colors::text);
+                bool open = ImGui::TreeNode(group->path.c_str(), "%-40s %5.1f%%  %7.0f MB  throttled %4.1f%%  %zu processes",
+                    group->path.c_str(), group->cpuPercent, group->memoryBytes / 1048576.0, group->throttledPercent, group->pids.size());
+                ImGui::PopStyleColor();
+                if (!open) continue;
+                
+                for (const auto& process : processSnapshot->processes) {
+                    if (std::find(group->pids.begin(), group->pids.end(), process.pid) != group->pids.end()) processRow(process);
+                }
+                ImGui::TreePop();
+            }
+        } else {
+            for (const auto& process : Monitor::MonitoringEngine::Get().GetTopProcesses(10)) processRow(process);
+        }
+        
+        // Proportional memory is only queried while a process is selected.
+        static Monitor::ProcessMemoryInfo memory;
+        bool haveMemory = selectedPid != 0 && Monitor::MonitoringEngine::Get().QueryProcessMemory(selectedPid, memory);
+        if (haveMemory || (selectedPid != 0 && memory.pid == selectedPid)) {
+            ImGui::Text("PID %lu: RSS %.0f MB, PSS %.0f MB, USS %.0f MB, shared %.0f MB, swap %.0f MB", memory.pid,
+                memory.residentBytes / 1048576.0, memory.proportionalBytes / 1048576.0, memory.uniqueBytes / 1048576.0,
+                memory.sharedBytes / 1048576.0, memory.swapBytes / 1048576.0);
+        }
+        
+        static Monitor::ProcessNumaInfo numa;
+        bool haveNuma = selectedPid != 0 && Monitor::MonitoringEngine::Get().GetSnapshot()->numa.size() > 1 &&
+            Monitor::MonitoringEngine::Get().QueryProcessNuma(selectedPid, numa);
+        if (haveNuma || (selectedPid != 0 && numa.pid == selectedPid)) {
+            std::string nodes;
+            for (size_t node = 0; node < numa.nodeBytes.size(); node++) {
+                nodes += "  N" + std::to_string(node) + " " + std::to_string(numa.nodeBytes[node] >> 20) + " MB";
+            }
+            ImVec4 numaColor = numa.remotePercent > 50.0f ? Colors::warning : Colors::text;
+            ImGui::TextColored(numaColor, "NUMA:%s  (home node %d, %.0f%% remote)", nodes.c_str(), numa.homeNode, numa.remotePercent);
+        }
         
         ImGui::Unindent();
         ImGui::Spacing();
@@ -289,7 +471,6 @@ void RenderSettings() {
     ImGui::Spacing();
     
     static bool startWithWindows = false;
-    static int pollingRate = 1000;
     
     ImGui::Checkbox("Start with Windows", &startWithWindows);
     ImGui::SliderInt("Monitoring Refresh Rate (ms)", &pollingRate, 100, 5000);
@@ -298,10 +479,66 @@ void RenderSettings() {
         spdlog::info("Settings saved");
     }
     
+    ImGui::Spacing();
+    ImGui::TextColored(Colors::accent, "Diagnostics");
+    ImGui::Separator();
+    
+    Monitor::HdrHistogram frames;
+    g_frameTimesUs.Snapshot(frames);
+    ImGui::Text("Frame time: p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+        frames.ValueAtPercentile(50.0) / 1000.0, frames.ValueAtPercentile(99.0) / 1000.0, frames.GetMax() / 1000.0);
+    
+    Monitor::HdrHistogram applies;
+    Optimizer::ProfileManager::Get().GetApplyTimes().Snapshot(applies);
+    if (applies.GetCount() > 0) {
+        ImGui::Text("Profile apply: p50 %.1f ms, p99 %.1f ms (%llu runs)",
+            applies.ValueAtPercentile(50.0) / 1000.0, applies.ValueAtPercentile(99.0) / 1000.0,
+            static_cast<unsigned long long>(applies.GetCount()));
+    }
+    
+    auto& engine = Monitor::MonitoringEngine::Get();
+    static float cpuBudget = 0.0f;
+    if (ImGui::SliderFloat("Monitor CPU budget (% of a core, 0 = none)", &cpuBudget, 0.0f, 5.0f, "%.1f")) {
+        engine.SetCpuBudget(cpuBudget);
+    }
+    
+    auto overhead = engine.GetSelfOverhead();
+    ImGui::Text("Monitor overhead: %.2f%% of a core, %.0f wakeups/s", overhead.cpuPercent, overhead.wakeupsPerSec);
+    if (!overhead.degraded.empty()) {
+        std::string degraded;
+        for (auto id : overhead.degraded) degraded += std::string(degraded.empty() ? "" : ", ") + Monitor::GetCollectorName(id);
+        ImGui::TextColored(Colors::warning, "Degraded to stay within budget: %s", degraded.c_str());
+    }
+    
+    for (const auto& stats : engine.GetCollectorStats()) {
+        if (stats.paused) {
+            ImGui::TextColored(Colors::textDim, "%-10s paused (no subscribers)", stats.name);
+            continue;
+        }
+        ImGui::Text("%-10s every %lld ms, p50 %lld us, p99 %lld us, %.2f%% CPU, %.0f syscalls, %.0f allocs per run",
+            stats.name, static_cast<long long>(stats.period.count()),
+            static_cast<long long>(stats.p50Duration.count()), static_cast<long long>(stats.p99Duration.count()),
+            stats.cpuPercent, stats.syscallsPerRun, stats.allocationsPerRun);
+    }
+    
+    bool recording = engine.IsRecording();
+    if (ImGui::Checkbox("Record telemetry to disk", &recording)) {
+        if (recording) {
+            engine.StartRecording();
+        } else {
+            engine.StopRecording();
+        }
+    }
+    if (engine.IsRecording()) {
+        auto recorder = engine.GetRecordingStats();
+        ImGui::Text("Recording to %s: %llu records, %.1f MB", recorder.segmentPath.c_str(),
+            static_cast<unsigned long long>(recorder.records), recorder.bytes / (1024.0 * 1024.0));
+    }
+    
     ImGui::EndChild();
 }
 
-int main(int, char**)
+int main(int argc, char** argv)
 {
     WNDCLASSEXW wc = { sizeof(wc), CS_CLASSDC, WndProc, 0L, 0L, GetModuleHandle(nullptr), nullptr, nullptr, nullptr, nullptr, L"PCOptimizer", nullptr };
     ::RegisterClassExW(&wc);
@@ -337,10 +574,24 @@ int main(int, char**)
     spdlog::set_level(spdlog::level::info);
     spdlog::info("PC Optimizer Premium starting...");
     
+    // --replay <directory> [speed] shows a recorded session, looping,
+    // instead of this machine.
+    if (argc > 2 && std::strcmp(argv[1], "--replay") == 0) {
+        Monitor::ReplayConfig replay;
+        replay.directory = argv[2];
+        replay.speed = argc > 3 ? std::atof(argv[3]) : 1.0;
+        replay.loop = true;
+        if (auto backend = Monitor::ReplayBackend::Create(replay)) {
+            Monitor::MonitoringEngine::Get().SetBackend(std::move(backend));
+        }
+    }
+    
     Monitor::MonitoringEngine::Get().Start(1000);
     spdlog::info("Monitoring engine started");
+    int monitoringSubscription = Monitor::MonitoringEngine::Get().Subscribe(0);
 
     bool done = false;
+    auto lastFrame = std::chrono::steady_clock::now();
     while (!done)
     {
         MSG msg;
@@ -384,6 +635,8 @@ int main(int, char**)
         
         ImGui::EndChild();
         
+        UpdateMonitoringDemand(monitoringSubscription, ::IsIconic(hwnd));
+        
         ImGui::SameLine();
         
         ImGui::BeginChild("Content", ImVec2(0, 0), false);
@@ -408,9 +661,14 @@ int main(int, char**)
         ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 
         g_pSwapChain->Present(1, 0);
+        
+        auto now = std::chrono::steady_clock::now();
+        g_frameTimesUs.Record(std::chrono::duration_cast<std::chrono::microseconds>(now - lastFrame).count());
+        lastFrame = now;
     }
     
     spdlog::info("Shutting down...");
+    Monitor::MonitoringEngine::Get().Unsubscribe(monitoringSubscription);
     Monitor::MonitoringEngine::Get().Stop();
 
     ImGui_ImplDX11_Shutdown();
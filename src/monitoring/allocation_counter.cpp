@@ -0,0 +1,130 @@
+// Replaces the global allocator to count operator new calls per thread for
+// ReadThreadUsage. Never part of PCOptimizerMonitoring: an executable opts
+// in by linking PCOptimizerAllocationCounter, which the build defines when
+// PCOPTIMIZER_COUNT_ALLOCATIONS is on. Aligned forms keep the alignment
+// ahead of the block so every form is freed by the matching one here.
+#include "monitoring/thread_usage.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* Allocate(std::size_t size) {
+    Monitor::CountAllocation();
+    if (size == 0) size = 1;
+    
+    for (;;) {
+        if (void* block = std::malloc(size)) return block;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), alignof(void*));
+    if (size > SIZE_MAX - align - sizeof(void*)) throw std::bad_alloc();
+    
+    auto raw = static_cast<char*>(Allocate(size + align + sizeof(void*)));
+    auto start = reinterpret_cast<std::uintptr_t>(raw + sizeof(void*));
+    auto block = reinterpret_cast<void**>((start + align - 1) & ~(std::uintptr_t(align) - 1));
+    block[-1] = raw;
+    return block;
+}
+
+void FreeAligned(void* block) {
+    if (block) std::free(static_cast<void**>(block)[-1]);
+}
+
+template <typename Fn>
+void* NoThrow(Fn allocate) noexcept {
+    try {
+        return allocate();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+}
+
+void* operator new(std::size_t size) {
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return Allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return NoThrow([&] { return Allocate(size); });
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return NoThrow([&] { return Allocate(size); });
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return NoThrow([&] { return AllocateAligned(size, alignment); });
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return NoThrow([&] { return AllocateAligned(size, alignment); });
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept {
+    FreeAligned(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept {
+    FreeAligned(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept {
+    FreeAligned(block);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept {
+    FreeAligned(block);
+}
+
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept {
+    FreeAligned(block);
+}
+
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept {
+    FreeAligned(block);
+}
@@ -0,0 +1,1687 @@
+#include "linux_backend.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <sstream>
+#include <spdlog/spdlog.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+namespace Monitor {
+
+namespace {
+
+constexpr double kSectorBytes = 512.0;
+
+constexpr std::chrono::seconds kDiskTopologyRefresh{30};
+constexpr std::chrono::seconds kCgroupRefresh{30};
+// /proc/cpuinfo is long and slow to generate; its clocks are a fallback
+// for machines without cpufreq and need not follow every tick.
+constexpr std::chrono::seconds kCpuinfoRefresh{1};
+
+constexpr const char* kPressureFiles[] = {"cpu", "memory", "io"};
+
+// Idle states that wake up slower than this count as deep (C3 and below on
+// current x86 parts; POLL, C1 and C1E are shallower).
+constexpr uint64_t kShallowIdleLatencyUs = 10;
+
+// Every group keeps its cpu.stat open and holds an inotify watch, so the
+// tree is capped; a typical systemd hierarchy has well under a hundred.
+constexpr size_t kMaxCgroups = 128;
+
+std::string ReadSysfsLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+// Last path component of a sysfs symlink target, e.g. "coretemp.0" for a
+// hwmon device link.
+std::string LinkTargetName(const std::string& link) {
+    char target[PATH_MAX];
+    ssize_t length = readlink(link.c_str(), target, sizeof(target) - 1);
+    if (length <= 0) return {};
+    target[length] = '\0';
+    
+    const char* slash = std::strrchr(target, '/');
+    return slash ? slash + 1 : target;
+}
+
+std::vector<std::string> ListDirectory(const std::string& path) {
+    std::vector<std::string> entries;
+    if (DIR* dir = opendir(path.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') entries.push_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+bool ReadSysfsValue(const char* path, uint64_t& value) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    
+    char buffer[32];
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= 0) return false;
+    
+    buffer[length] = '\0';
+    value = std::strtoull(buffer, nullptr, 10);
+    return true;
+}
+
+bool IsPhysicalBlockDevice(const std::string& name) {
+    if (name.empty() || name[0] == '.') return false;
+    return name.rfind("loop", 0) != 0 && name.rfind("ram", 0) != 0 && name.rfind("zram", 0) != 0;
+}
+
+// Maps a "major:minor" device number to its whole-disk name, so mounts of
+// sda1 and sda2 both land on sda.
+std::string ResolveWholeDisk(const std::string& device) {
+    std::string sysPath = "/sys/dev/block/" + device;
+    char target[PATH_MAX];
+    ssize_t length = readlink(sysPath.c_str(), target, sizeof(target) - 1);
+    if (length <= 0) return {};
+    target[length] = '\0';
+    
+    std::string path(target);
+    std::string name = path.substr(path.rfind('/') + 1);
+    
+    if (access((sysPath + "/partition").c_str(), F_OK) == 0) {
+        path.erase(path.rfind('/'));
+        name = path.substr(path.rfind('/') + 1);
+    }
+    return name;
+}
+
+// mountinfo escapes space, tab, newline and backslash as octal "\ooo".
+std::string UnescapeMountPath(const std::string& escaped) {
+    std::string path;
+    path.reserve(escaped.size());
+    for (size_t i = 0; i < escaped.size(); i++) {
+        if (escaped[i] == '\\' && i + 3 < escaped.size() && std::isdigit(static_cast<unsigned char>(escaped[i + 1]))) {
+            path += static_cast<char>(std::stoi(escaped.substr(i + 1, 3), nullptr, 8));
+            i += 3;
+        } else {
+            path += escaped[i];
+        }
+    }
+    return path;
+}
+
+// A smaller current value means the counter was reset (device or group
+// re-created, interface re-registered) and reads as no progress.
+uint64_t CounterDelta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : 0;
+}
+
+// For the fields the kernel prints as 32-bit unsigned ints, such as the
+// millisecond tick counts in /proc/diskstats, which wrap every 49 days.
+uint64_t Counter32Delta(uint64_t current, uint64_t previous) {
+    if (current >= previous) return current - previous;
+    if (previous <= UINT32_MAX) return current + (uint64_t(1) << 32) - previous;
+    return 0;
+}
+
+// Mount point of the cgroup v2 hierarchy: /sys/fs/cgroup on unified
+// systems, /sys/fs/cgroup/unified on hybrid ones. Empty without cgroup v2.
+std::string FindCgroup2Root() {
+    // mountinfo: "... mount-point options [optional fields] - fstype source ..."
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        size_t separator = line.find(" - ");
+        if (separator == std::string::npos || line.compare(separator + 3, 8, "cgroup2 ") != 0) continue;
+        
+        std::istringstream fields(line);
+        std::string id, parent, device, root, mountPoint;
+        fields >> id >> parent >> device >> root >> mountPoint;
+        if (fields) return UnescapeMountPath(mountPoint);
+    }
+    return {};
+}
+
+// /proc/pressure/* and cgroup *.pressure files:
+//   some avg10=0.12 avg60=0.05 avg300=0.01 total=123456
+//   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+bool ParsePressure(const char* text, float& someAvg10, uint64_t& someTotal, float& fullAvg10, uint64_t& fullTotal) {
+    unsigned long long some = 0, full = 0;
+    if (std::sscanf(text, "some avg10=%f avg60=%*f avg300=%*f total=%llu", &someAvg10, &some) != 2) return false;
+    
+    // Kernels before 5.13 have no "full" line for CPU.
+    const char* fullLine = std::strstr(text, "full ");
+    if (!fullLine || std::sscanf(fullLine, "full avg10=%f avg60=%*f avg300=%*f total=%llu", &fullAvg10, &full) != 2) {
+        fullAvg10 = 0.0f;
+        full = 0;
+    }
+    
+    someTotal = some;
+    fullTotal = full;
+    return true;
+}
+
+// Value of a "key<separator>value" line, e.g. "se.nr_migrations : 12" in
+// /proc/*/sched or "voluntary_ctxt_switches:\t40" in status. `key` must
+// start at a line boundary.
+bool FindKeyedValue(const char* text, const char* key, uint64_t& value) {
+    size_t keyLength = std::strlen(key);
+    for (const char* line = text; line && *line; ) {
+        if (std::strncmp(line, key, keyLength) == 0) {
+            const char* colon = std::strchr(line + keyLength, ':');
+            if (!colon) return false;
+            value = std::strtoull(colon + 1, nullptr, 10);
+            return true;
+        }
+        line = std::strchr(line, '\n');
+        if (line) line++;
+    }
+    return false;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point since, std::chrono::steady_clock::time_point now) {
+    return std::chrono::duration<double>(now - since).count();
+}
+
+// Kernel CPU list such as "0-3,8,10-11".
+std::vector<int> ParseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    const char* cursor = list.c_str();
+    while (*cursor >= '0' && *cursor <= '9') {
+        int first = static_cast<int>(ScanUnsigned(cursor));
+        int last = first;
+        if (*cursor == '-') {
+            cursor++;
+            last = static_cast<int>(ScanUnsigned(cursor));
+        }
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        if (*cursor == ',') cursor++;
+    }
+    return cpus;
+}
+
+// Topology ids are -1 where the firmware does not say.
+int ReadSysfsId(const std::string& path) {
+    std::string line = ReadSysfsLine(path);
+    return line.empty() ? -1 : std::atoi(line.c_str());
+}
+
+// Cache sizes read like "1024K".
+uint64_t ParseCacheSizeKB(const std::string& size) {
+    uint64_t value = std::strtoull(size.c_str(), nullptr, 10);
+    if (size.find('M') != std::string::npos) return value * 1024;
+    return value;
+}
+
+}
+
+std::unique_ptr<CollectorBackend> CreateDefaultBackend() {
+    return std::make_unique<LinuxCollectorBackend>();
+}
+
+LinuxCollectorBackend::LinuxCollectorBackend() {
+    m_nsPerClockTick = 1000000000ull / static_cast<uint64_t>(std::max(1L, sysconf(_SC_CLK_TCK)));
+    m_pageSize = static_cast<uint64_t>(std::max(1L, sysconf(_SC_PAGESIZE)));
+    m_prevCpuSample = Clock::now();
+    m_prevDiskSample = Clock::now();
+    m_prevNetSample = Clock::now();
+    m_prevRamSample = Clock::now();
+    m_prevNumaSample = Clock::now();
+    m_prevCgroupSample = Clock::now();
+    m_prevPressureSample = Clock::now();
+    m_cgroupRoot = FindCgroup2Root();
+    m_procStat.Open("/proc/stat");
+    m_procMeminfo.Open("/proc/meminfo");
+    m_procVmstat.Open("/proc/vmstat");
+    m_procDiskstats.Open("/proc/diskstats");
+    m_procNetdev.Open("/proc/net/dev");
+    DiscoverCpuFeatures();
+    DiscoverThermalSensors();
+    DiscoverNumaNodes();
+}
+
+LinuxCollectorBackend::~LinuxCollectorBackend() {
+    {
+        std::lock_guard<std::mutex> lock(m_triggerMutex);
+        m_stopTriggers = true;
+        if (m_triggerWake >= 0) {
+            uint64_t one = 1;
+            (void)write(m_triggerWake, &one, sizeof(one));
+        }
+    }
+    if (m_triggerThread.joinable()) m_triggerThread.join();
+    
+    for (const auto& trigger : m_triggers) close(trigger.fd);
+    for (int fd : m_retiredTriggerFds) close(fd);
+    if (m_triggerWake >= 0) close(m_triggerWake);
+    if (m_cgroupInotify >= 0) close(m_cgroupInotify);
+}
+
+bool LinuxCollectorBackend::DiscoverTopology(TopologySource& source) {
+    const std::string cpuRoot = "/sys/devices/system/cpu/";
+    std::vector<int> online = ParseCpuList(ReadSysfsLine(cpuRoot + "online"));
+    if (online.empty()) {
+        spdlog::error("Failed to read {}online", cpuRoot);
+        return false;
+    }
+    
+    // Intel hybrid parts name their core types through the PMU devices;
+    // elsewhere cpu_capacity (ARM) or the maximum clock ranks the cores.
+    std::vector<int> bigCores = ParseCpuList(ReadSysfsLine("/sys/devices/cpu_core/cpus"));
+    std::vector<int> atomCores = ParseCpuList(ReadSysfsLine("/sys/devices/cpu_atom/cpus"));
+    bool pmuHybrid = !bigCores.empty() && !atomCores.empty();
+    
+    for (int id : online) {
+        std::string base = cpuRoot + "cpu" + std::to_string(id) + "/";
+        LogicalCpu& cpu = source.cpus.emplace_back();
+        cpu.id = id;
+        cpu.package = std::max(0, ReadSysfsId(base + "topology/physical_package_id"));
+        cpu.die = std::max(0, ReadSysfsId(base + "topology/die_id"));
+        
+        // core_id repeats across clusters on some ARM parts; the lowest SMT
+        // sibling identifies the core everywhere.
+        std::vector<int> siblings = ParseCpuList(ReadSysfsLine(base + "topology/core_cpus_list"));
+        if (siblings.empty()) siblings = ParseCpuList(ReadSysfsLine(base + "topology/thread_siblings_list"));
+        cpu.core = siblings.empty() ? id : siblings.front();
+        
+        uint64_t maxKHz = 0, capacity = 0;
+        if (ReadSysfsValue((base + "cpufreq/cpuinfo_max_freq").c_str(), maxKHz)) {
+            cpu.maxFrequencyMHz = static_cast<uint32_t>(maxKHz / 1000);
+        }
+        if (pmuHybrid) {
+            cpu.performanceRank = std::binary_search(bigCores.begin(), bigCores.end(), id) ? 2 : 1;
+        } else if (ReadSysfsValue((base + "cpu_capacity").c_str(), capacity)) {
+            cpu.performanceRank = static_cast<uint32_t>(capacity);
+        } else {
+            cpu.performanceRank = cpu.maxFrequencyMHz;
+        }
+        
+        // Every member lists the caches it shares; only the lowest one
+        // reports each domain.
+        for (const auto& index : ListDirectory(base + "cache")) {
+            if (index.rfind("index", 0) != 0) continue;
+            std::string cachePath = base + "cache/" + index + "/";
+            if (ReadSysfsLine(cachePath + "type") == "Instruction") continue;
+            
+            CacheDomain cache;
+            cache.level = ReadSysfsId(cachePath + "level");
+            cache.cpus = ParseCpuList(ReadSysfsLine(cachePath + "shared_cpu_list"));
+            if (cache.level < 2 || cache.cpus.empty() || cache.cpus.front() != id) continue;
+            cache.sizeKB = ParseCacheSizeKB(ReadSysfsLine(cachePath + "size"));
+            source.caches.push_back(std::move(cache));
+        }
+    }
+    
+    for (const auto& entry : ListDirectory("/sys/devices/system/node")) {
+        if (entry.rfind("node", 0) != 0 || !std::isdigit(static_cast<unsigned char>(entry[4]))) continue;
+        int node = std::atoi(entry.c_str() + 4);
+        for (int id : ParseCpuList(ReadSysfsLine("/sys/devices/system/node/" + entry + "/cpulist"))) {
+            auto cpu = std::find_if(source.cpus.begin(), source.cpus.end(), [&](const LogicalCpu& c) { return c.id == id; });
+            if (cpu != source.cpus.end()) cpu->numaNode = node;
+        }
+    }
+    return true;
+}
+
+bool LinuxCollectorBackend::CollectCPU(std::vector<CPUCoreInfo>& cores) {
+    std::string_view stat = m_procStat.Read();
+    if (stat.empty()) {
+        spdlog::error("Failed to read /proc/stat");
+        return false;
+    }
+    
+    auto sampleTime = Clock::now();
+    double elapsedUs = std::chrono::duration<double, std::micro>(sampleTime - m_prevCpuSample).count();
+    m_prevCpuSample = sampleTime;
+    
+    if (!m_hasCpufreq && (m_cpuinfoMHz.empty() || sampleTime - m_cpuinfoRefresh >= kCpuinfoRefresh)) {
+        ReadCpuinfoFrequencies();
+        m_cpuinfoRefresh = sampleTime;
+    }
+    
+    // Cores are filled in place so their idleResidency vectors keep their
+    // capacity from tick to tick.
+    size_t count = 0;
+    char path[96];
+    
+    // "cpuN user nice system idle iowait irq softirq steal ..."; the per-CPU
+    // lines follow the aggregate "cpu " line and end the CPU section.
+    for (const char* line = stat.data(); std::strncmp(line, "cpu", 3) == 0; line = NextLine(line)) {
+        const char* cursor = line + 3;
+        if (*cursor < '0' || *cursor > '9') continue;
+        
+        int coreID = static_cast<int>(ScanUnsigned(cursor));
+        uint64_t user = ScanUnsigned(cursor);
+        uint64_t nice = ScanUnsigned(cursor);
+        uint64_t system = ScanUnsigned(cursor);
+        uint64_t idle = ScanUnsigned(cursor);
+        uint64_t iowait = ScanUnsigned(cursor);
+        uint64_t irq = ScanUnsigned(cursor);
+        uint64_t softirq = ScanUnsigned(cursor);
+        uint64_t steal = ScanUnsigned(cursor);
+        
+        CPUTimes now;
+        now.busy = user + nice + system + irq + softirq + steal;
+        now.total = now.busy + idle + iowait;
+        
+        if (coreID >= static_cast<int>(m_prevCpuTimes.size())) {
+            m_prevCpuTimes.resize(coreID + 1, now);
+        }
+        
+        CPUTimes& prev = m_prevCpuTimes[coreID];
+        // Per-CPU iowait can go backwards, and a CPU brought back online
+        // restarts its counters; either reads as no progress this tick.
+        uint64_t totalDelta = now.total >= prev.total ? now.total - prev.total : 0;
+        uint64_t busyDelta = now.busy >= prev.busy ? now.busy - prev.busy : 0;
+        prev = now;
+        
+        if (count == cores.size()) cores.emplace_back();
+        CPUCoreInfo& info = cores[count++];
+        info.coreID = coreID;
+        info.frequency = 0.0f;
+        info.temperature = 0.0f;
+        info.cState = 0.0f;
+        float usage = totalDelta > 0 ? 100.0f * static_cast<float>(busyDelta) / static_cast<float>(totalDelta) : 0.0f;
+        info.usage = std::clamp(usage, 0.0f, 100.0f);
+        
+        uint64_t kHz = 0;
+        if (m_hasCpufreq && coreID >= static_cast<int>(m_cpufreqFiles.size())) {
+            m_cpufreqFiles.resize(coreID + 1);
+        }
+        if (m_hasCpufreq && !m_cpufreqFiles[coreID].IsBound()) {
+            std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", coreID);
+            m_cpufreqFiles[coreID].Open(path);
+        }
+        if (m_hasCpufreq && m_cpufreqFiles[coreID].ReadValue(kHz)) {
+            info.frequency = static_cast<float>(kHz) / 1000.0f;
+        } else if (coreID < static_cast<int>(m_cpuinfoMHz.size())) {
+            info.frequency = m_cpuinfoMHz[coreID];
+        }
+        
+        SampleIdleStates(coreID, elapsedUs, info);
+    }
+    
+    cores.resize(count);
+    return !cores.empty();
+}
+
+void LinuxCollectorBackend::DiscoverCpuFeatures() {
+    m_hasCpufreq = access("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", R_OK) == 0;
+    if (!m_hasCpufreq) m_procCpuinfo.Open("/proc/cpuinfo");
+    
+    char path[96];
+    for (int state = 0;; state++) {
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cpuidle/state%d/name", state);
+        std::ifstream nameFile(path);
+        std::string name;
+        if (!(nameFile >> name)) break;
+        
+        uint64_t latencyUs = 0;
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cpuidle/state%d/latency", state);
+        ReadSysfsValue(path, latencyUs);
+        
+        m_idleStateNames.push_back(name);
+        m_idleStateDeep.push_back(latencyUs > kShallowIdleLatencyUs);
+    }
+    
+    spdlog::info("CPU sampling: {} frequency, {} idle states",
+                 m_hasCpufreq ? "cpufreq" : "/proc/cpuinfo", m_idleStateNames.size());
+}
+
+void LinuxCollectorBackend::SampleIdleStates(int coreID, double elapsedUs, CPUCoreInfo& info) {
+    size_t states = m_idleStateNames.size();
+    info.idleResidency.assign(states, 0.0f);
+    if (states == 0) return;
+    
+    if (coreID >= static_cast<int>(m_prevIdleTimes.size())) {
+        m_prevIdleTimes.resize(coreID + 1);
+        m_idleTimeFiles.resize(coreID + 1);
+    }
+    
+    std::vector<uint64_t>& prev = m_prevIdleTimes[coreID];
+    bool hasPrev = prev.size() == states && elapsedUs > 0.0;
+    prev.resize(states, 0);
+    
+    std::vector<ProcFile>& files = m_idleTimeFiles[coreID];
+    if (files.size() != states) {
+        files.resize(states);
+        char path[96];
+        for (size_t state = 0; state < states; state++) {
+            std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpuidle/state%zu/time", coreID, state);
+            files[state].Open(path);
+        }
+    }
+    
+    for (size_t state = 0; state < states; state++) {
+        uint64_t timeUs = 0;
+        if (!files[state].ReadValue(timeUs)) continue;
+        
+        if (hasPrev && timeUs >= prev[state]) {
+            float residency = static_cast<float>(std::min(100.0, 100.0 * (timeUs - prev[state]) / elapsedUs));
+            info.idleResidency[state] = residency;
+            if (m_idleStateDeep[state]) info.cState += residency;
+        }
+        prev[state] = timeUs;
+    }
+    
+    info.cState = std::min(info.cState, 100.0f);
+}
+
+void LinuxCollectorBackend::ReadCpuinfoFrequencies() {
+    std::string_view text = m_procCpuinfo.Read();
+    if (text.empty()) return;
+    
+    // "processor\t: 3" opens each CPU's block, "cpu MHz\t\t: 2893.202" follows.
+    int processor = -1;
+    for (const char* line = text.data(); *line; line = NextLine(line)) {
+        const char* colon = line;
+        while (*colon && *colon != ':' && *colon != '\n') colon++;
+        if (*colon != ':') continue;
+        
+        std::string_view key(line, static_cast<size_t>(colon - line));
+        const char* value = colon + 1;
+        if (key.starts_with("processor")) {
+            processor = static_cast<int>(ScanUnsigned(value));
+        } else if (key.starts_with("cpu MHz") && processor >= 0) {
+            if (processor >= static_cast<int>(m_cpuinfoMHz.size())) {
+                m_cpuinfoMHz.resize(processor + 1, 0.0f);
+            }
+            m_cpuinfoMHz[processor] = std::strtof(value, nullptr);
+        }
+    }
+}
+
+bool LinuxCollectorBackend::CollectGPU(GPUInfo& gpu) {
+    gpu.name = "Unknown GPU";
+    gpu.coreClock = 0.0f;
+    gpu.memoryClock = 0.0f;
+    gpu.temperature = 0.0f;
+    gpu.usage = 0.0f;
+    gpu.memoryUsage = 0.0f;
+    gpu.memoryTotal = 0.0f;
+    gpu.powerUsage = 0.0f;
+    gpu.fanSpeed = 0;
+    return true;
+}
+
+bool LinuxCollectorBackend::CollectRAM(RAMInfo& ram) {
+    std::string_view meminfo = m_procMeminfo.Read();
+    if (meminfo.empty()) {
+        spdlog::error("Failed to read /proc/meminfo");
+        return false;
+    }
+    
+    // Sizes are in kB; the HugePages_* entries are page counts.
+    uint64_t totalKB = 0, availableKB = 0, buffersKB = 0, cachedKB = 0;
+    uint64_t dirtyKB = 0, writebackKB = 0, slabKB = 0, slabReclaimableKB = 0;
+    uint64_t swapTotalKB = 0, swapFreeKB = 0, anonHugeKB = 0, committedKB = 0, commitLimitKB = 0;
+    uint64_t hugePages = 0, hugePagesFree = 0, hugePageKB = 0;
+    
+    std::string_view key;
+    uint64_t value = 0;
+    for (const char* cursor = meminfo.data(); ScanKeyedLine(cursor, key, value); ) {
+        if (key == "MemTotal") totalKB = value;
+        else if (key == "MemAvailable") availableKB = value;
+        else if (key == "Buffers") buffersKB = value;
+        else if (key == "Cached") cachedKB = value;
+        else if (key == "Dirty") dirtyKB = value;
+        else if (key == "Writeback") writebackKB = value;
+        else if (key == "Slab") slabKB = value;
+        else if (key == "SReclaimable") slabReclaimableKB = value;
+        else if (key == "SwapTotal") swapTotalKB = value;
+        else if (key == "SwapFree") swapFreeKB = value;
+        else if (key == "AnonHugePages") anonHugeKB = value;
+        else if (key == "Committed_AS") committedKB = value;
+        else if (key == "CommitLimit") commitLimitKB = value;
+        else if (key == "HugePages_Total") hugePages = value;
+        else if (key == "HugePages_Free") hugePagesFree = value;
+        else if (key == "Hugepagesize") hugePageKB = value;
+    }
+    
+    if (totalKB == 0) return false;
+    
+    auto gb = [](uint64_t kb) { return static_cast<float>(kb) / (1024.0f * 1024.0f); };
+    auto mb = [](uint64_t kb) { return static_cast<float>(kb) / 1024.0f; };
+    
+    ram.totalGB = gb(totalKB);
+    ram.availableGB = gb(availableKB);
+    ram.usedGB = ram.totalGB - ram.availableGB;
+    ram.usagePercent = 100.0f * static_cast<float>(totalKB - availableKB) / static_cast<float>(totalKB);
+    ram.speedMHz = 0;
+    ram.latencyNs = 0.0f;
+    
+    ram.cachedGB = gb(cachedKB);
+    ram.buffersGB = gb(buffersKB);
+    ram.dirtyMB = mb(dirtyKB);
+    ram.writebackMB = mb(writebackKB);
+    ram.slabGB = gb(slabKB);
+    ram.slabReclaimableGB = gb(slabReclaimableKB);
+    ram.swapTotalGB = gb(swapTotalKB);
+    ram.swapUsedGB = gb(swapTotalKB - std::min(swapFreeKB, swapTotalKB));
+    ram.hugePagesTotalGB = gb(hugePages * hugePageKB);
+    ram.hugePagesUsedGB = gb((hugePages - std::min(hugePagesFree, hugePages)) * hugePageKB);
+    ram.transparentHugeGB = gb(anonHugeKB);
+    ram.committedGB = gb(committedKB);
+    ram.commitLimitGB = gb(commitLimitKB);
+    
+    // Swap traffic comes from the cumulative page counters in vmstat.
+    uint64_t swapIn = 0, swapOut = 0;
+    std::string_view vmstat = m_procVmstat.Read();
+    for (const char* line = vmstat.data(); line && *line; line = NextLine(line)) {
+        const char* cursor = line;
+        std::string_view name = ScanToken(cursor);
+        if (name == "pswpin") swapIn = ScanUnsigned(cursor);
+        else if (name == "pswpout") swapOut = ScanUnsigned(cursor);
+    }
+    
+    auto now = Clock::now();
+    double elapsed = SecondsSince(m_prevRamSample, now);
+    m_prevRamSample = now;
+    
+    bool hasPrev = m_hasSwapCounters && elapsed > 0.0;
+    double pageMB = static_cast<double>(m_pageSize) / (1024.0 * 1024.0);
+    ram.swapInMBps = hasPrev ? static_cast<float>(CounterDelta(swapIn, m_prevSwapIn) * pageMB / elapsed) : 0.0f;
+    ram.swapOutMBps = hasPrev ? static_cast<float>(CounterDelta(swapOut, m_prevSwapOut) * pageMB / elapsed) : 0.0f;
+    m_prevSwapIn = swapIn;
+    m_prevSwapOut = swapOut;
+    m_hasSwapCounters = !vmstat.empty();
+    return true;
+}
+
+void LinuxCollectorBackend::DiscoverNumaNodes() {
+    const std::string nodeRoot = "/sys/devices/system/node/";
+    for (const auto& entry : ListDirectory(nodeRoot)) {
+        if (entry.rfind("node", 0) != 0 || !std::isdigit(static_cast<unsigned char>(entry[4]))) continue;
+        
+        NumaNode& node = m_numaNodes.emplace_back();
+        node.id = std::atoi(entry.c_str() + 4);
+        node.meminfo.Open(nodeRoot + entry + "/meminfo");
+        node.numastat.Open(nodeRoot + entry + "/numastat");
+    }
+    std::sort(m_numaNodes.begin(), m_numaNodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+}
+
+bool LinuxCollectorBackend::CollectNuma(std::vector<NumaNodeInfo>& nodes) {
+    if (m_numaNodes.empty()) return false;
+    
+    auto now = Clock::now();
+    double elapsed = SecondsSince(m_prevNumaSample, now);
+    m_prevNumaSample = now;
+    
+    constexpr double kKBPerGB = 1024.0 * 1024.0;
+    constexpr const char* kCounters[] = {"numa_hit", "numa_miss", "numa_foreign", "other_node"};
+    
+    nodes.resize(m_numaNodes.size());
+    for (size_t n = 0; n < m_numaNodes.size(); n++) {
+        NumaNode& node = m_numaNodes[n];
+        NumaNodeInfo& info = nodes[n];
+        info = NumaNodeInfo{};
+        info.node = node.id;
+        
+        // Lines read "Node 0 MemTotal:       16315708 kB".
+        std::string_view text = node.meminfo.Read();
+        const char* cursor = text.data();
+        std::string_view key;
+        uint64_t value = 0;
+        while (!text.empty() && ScanKeyedLine(cursor, key, value)) {
+            if (key.ends_with(" MemTotal")) info.totalGB = static_cast<float>(value / kKBPerGB);
+            else if (key.ends_with(" MemFree")) info.freeGB = static_cast<float>(value / kKBPerGB);
+        }
+        info.usedGB = info.totalGB - info.freeGB;
+        
+        // Page counts, one "name value" pair per line.
+        std::array<uint64_t, 4> counters{};
+        text = node.numastat.Read();
+        for (const char* line = text.data(); !text.empty() && *line; line = NextLine(line)) {
+            const char* field = line;
+            std::string_view name = ScanToken(field);
+            for (size_t c = 0; c < counters.size(); c++) {
+                if (name == kCounters[c]) counters[c] = ScanUnsigned(field);
+            }
+        }
+        
+        if (m_hasNumaCounters && elapsed > 0.0) {
+            info.hitsPerSec = static_cast<float>(CounterDelta(counters[0], node.prevCounters[0]) / elapsed);
+            info.missesPerSec = static_cast<float>(CounterDelta(counters[1], node.prevCounters[1]) / elapsed);
+            info.foreignPerSec = static_cast<float>(CounterDelta(counters[2], node.prevCounters[2]) / elapsed);
+            info.remotePerSec = static_cast<float>(CounterDelta(counters[3], node.prevCounters[3]) / elapsed);
+        }
+        node.prevCounters = counters;
+    }
+    m_hasNumaCounters = true;
+    return true;
+}
+
+// numa_maps has one line per mapping with "N<node>=<pages>" tokens and the
+// mapping's page size; huge-page mappings count in their own page size.
+bool LinuxCollectorBackend::QueryProcessNuma(unsigned long pid, ProcessNumaInfo& info) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%lu/numa_maps", pid);
+    
+    ProcFile maps;
+    if (!maps.Open(path)) {
+        if (errno != ENOENT && errno != ESRCH) spdlog::error("Failed to open {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    std::string_view text = maps.Read();
+    if (text.empty()) return false;
+    
+    info = ProcessNumaInfo{};
+    info.pid = pid;
+    info.sampledAt = Clock::now();
+    
+    for (const char* line = text.data(); *line; line = NextLine(line)) {
+        uint64_t pageBytes = m_pageSize;
+        const char* pageSizeField = std::strstr(line, "kernelpagesize_kB=");
+        const char* end = NextLine(line);
+        if (pageSizeField && pageSizeField < end) {
+            const char* number = pageSizeField + std::strlen("kernelpagesize_kB=");
+            pageBytes = ScanUnsigned(number) * 1024;
+        }
+        
+        const char* cursor = line;
+        while (cursor < end && *cursor && *cursor != '\n') {
+            std::string_view token = ScanToken(cursor);
+            if (token.size() < 4 || token[0] != 'N' || token[1] < '0' || token[1] > '9') continue;
+            
+            const char* number = token.data() + 1;
+            size_t node = static_cast<size_t>(ScanUnsigned(number));
+            if (*number != '=') continue;
+            number++;
+            uint64_t pages = ScanUnsigned(number);
+            if (node >= info.nodeBytes.size()) info.nodeBytes.resize(node + 1);
+            info.nodeBytes[node] += pages * pageBytes;
+        }
+    }
+    
+    // Field 39 of stat is the CPU the process last ran on.
+    std::snprintf(path, sizeof(path), "/proc/%lu/stat", pid);
+    ProcFile stat;
+    if (stat.Open(path)) {
+        std::string_view statText = stat.Read();
+        const char* cursor = statText.empty() ? nullptr : std::strrchr(statText.data(), ')');
+        if (cursor) {
+            cursor++;
+            SkipFields(cursor, 36);
+            info.lastCpu = static_cast<int>(ScanSigned(cursor));
+        }
+    }
+    return true;
+}
+
+bool LinuxCollectorBackend::CollectDisks(std::vector<DiskInfo>& disks) {
+    auto now = Clock::now();
+    if (!m_hasDiskTopology || now - m_diskTopologyRefresh >= kDiskTopologyRefresh) {
+        RefreshDiskTopology();
+        m_diskTopologyRefresh = now;
+        m_hasDiskTopology = true;
+    }
+    
+    std::string_view diskstats = m_procDiskstats.Read();
+    if (diskstats.empty()) {
+        spdlog::error("Failed to read /proc/diskstats");
+        return false;
+    }
+    
+    double elapsed = SecondsSince(m_prevDiskSample, now);
+    double elapsedMs = elapsed * 1000.0;
+    m_prevDiskSample = now;
+    
+    disks.clear();
+    
+    // "major minor name reads merged sectors ticks writes merged sectors
+    //  ticks in-flight io-ticks queue-ticks ..."
+    for (const char* line = diskstats.data(); *line; line = NextLine(line)) {
+        const char* cursor = line;
+        SkipFields(cursor, 2);
+        std::string_view name = ScanToken(cursor);
+        
+        // Partitions and virtual devices are most of the file.
+        auto topology = m_diskTopology.find(name);
+        if (topology == m_diskTopology.end()) continue;
+        
+        DiskCounters counters;
+        counters.readIOs = ScanUnsigned(cursor);
+        SkipFields(cursor, 1);
+        counters.readSectors = ScanUnsigned(cursor);
+        counters.readTicks = ScanUnsigned(cursor);
+        counters.writeIOs = ScanUnsigned(cursor);
+        SkipFields(cursor, 1);
+        counters.writeSectors = ScanUnsigned(cursor);
+        counters.writeTicks = ScanUnsigned(cursor);
+        SkipFields(cursor, 1);
+        counters.ioTicks = ScanUnsigned(cursor);
+        counters.queueTicks = ScanUnsigned(cursor);
+        
+        auto prevIt = m_prevDiskCounters.find(name);
+        bool hasPrev = prevIt != m_prevDiskCounters.end();
+        DiskCounters prev = hasPrev ? prevIt->second : counters;
+        if (hasPrev) {
+            prevIt->second = counters;
+        } else {
+            m_prevDiskCounters.emplace(name, counters);
+        }
+        
+        DiskInfo info;
+        info.name = name;
+        info.readMBps = 0.0f;
+        info.writeMBps = 0.0f;
+        info.readIOPS = 0;
+        info.writeIOPS = 0;
+        info.latencyMs = 0.0f;
+        info.temperature = 0.0f;
+        info.usagePercent = topology->second.usagePercent;
+        info.queueDepth = 0.0f;
+        info.busyPercent = 0.0f;
+        info.mountPoints = topology->second.mountPoints;
+        
+        if (hasPrev && elapsed > 0.0) {
+            uint64_t readIOs = CounterDelta(counters.readIOs, prev.readIOs);
+            uint64_t writeIOs = CounterDelta(counters.writeIOs, prev.writeIOs);
+            uint64_t ioWaitMs = Counter32Delta(counters.readTicks, prev.readTicks) + Counter32Delta(counters.writeTicks, prev.writeTicks);
+            
+            info.readMBps = static_cast<float>(CounterDelta(counters.readSectors, prev.readSectors) * kSectorBytes / (1024.0 * 1024.0) / elapsed);
+            info.writeMBps = static_cast<float>(CounterDelta(counters.writeSectors, prev.writeSectors) * kSectorBytes / (1024.0 * 1024.0) / elapsed);
+            info.readIOPS = static_cast<int>(readIOs / elapsed);
+            info.writeIOPS = static_cast<int>(writeIOs / elapsed);
+            info.latencyMs = readIOs + writeIOs > 0 ? static_cast<float>(ioWaitMs) / static_cast<float>(readIOs + writeIOs) : 0.0f;
+            
+            // time_in_queue grows by the number of in-flight requests every
+            // millisecond, so its rate is the average queue depth.
+            info.queueDepth = static_cast<float>(Counter32Delta(counters.queueTicks, prev.queueTicks) / elapsedMs);
+            info.busyPercent = static_cast<float>(std::min(100.0, Counter32Delta(counters.ioTicks, prev.ioTicks) * 100.0 / elapsedMs));
+        }
+        
+        disks.push_back(std::move(info));
+    }
+    
+    return true;
+}
+
+void LinuxCollectorBackend::RefreshDiskTopology() {
+    std::map<std::string, DiskTopology, std::less<>> topology;
+    
+    if (DIR* block = opendir("/sys/block")) {
+        while (dirent* entry = readdir(block)) {
+            if (IsPhysicalBlockDevice(entry->d_name)) {
+                topology[entry->d_name];
+            }
+        }
+        closedir(block);
+    }
+    
+    // mountinfo: "id parent major:minor root mount-point options ..."
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        std::istringstream fields(line);
+        std::string id, parent, device, root, mountPoint;
+        fields >> id >> parent >> device >> root >> mountPoint;
+        
+        // Bind mounts of subdirectories would list the same disk many times.
+        if (!fields || root != "/") continue;
+        
+        auto disk = topology.find(ResolveWholeDisk(device));
+        if (disk == topology.end()) continue;
+        disk->second.mountPoints.push_back(UnescapeMountPath(mountPoint));
+    }
+    
+    for (auto& [name, disk] : topology) {
+        auto& mounts = disk.mountPoints;
+        std::sort(mounts.begin(), mounts.end(), [](const std::string& a, const std::string& b) {
+            return a.size() != b.size() ? a.size() < b.size() : a < b;
+        });
+        mounts.erase(std::unique(mounts.begin(), mounts.end()), mounts.end());
+        
+        // Space usage of the top-most mount stands for the whole disk.
+        struct statvfs fs;
+        if (!mounts.empty() && statvfs(mounts.front().c_str(), &fs) == 0 && fs.f_blocks > 0) {
+            disk.usagePercent = 100.0f * static_cast<float>(fs.f_blocks - fs.f_bfree) / static_cast<float>(fs.f_blocks);
+        }
+    }
+    
+    m_diskTopology = std::move(topology);
+}
+
+bool LinuxCollectorBackend::CollectNetwork(NetworkInfo& network) {
+    std::string_view netdev = m_procNetdev.Read();
+    if (netdev.empty()) {
+        spdlog::error("Failed to read /proc/net/dev");
+        return false;
+    }
+    
+    auto now = Clock::now();
+    double elapsed = SecondsSince(m_prevNetSample, now);
+    m_prevNetSample = now;
+    
+    network.interfaces.clear();
+    std::map<std::string, NetCounters, std::less<>> counters;
+    
+    // "iface: rx bytes packets errs drop fifo frame compressed multicast
+    //         tx bytes packets errs drop fifo colls carrier compressed"
+    for (const char* line = netdev.data(); *line; line = NextLine(line)) {
+        const char* colon = line;
+        while (*colon && *colon != ':' && *colon != '\n') colon++;
+        if (*colon != ':') continue;
+        
+        const char* nameStart = line;
+        while (*nameStart == ' ') nameStart++;
+        std::string_view name(nameStart, static_cast<size_t>(colon - nameStart));
+        if (name == "lo") continue;
+        
+        const char* cursor = colon + 1;
+        NetCounters current;
+        current.rxBytes = ScanUnsigned(cursor);
+        current.rxPackets = ScanUnsigned(cursor);
+        current.rxErrors = ScanUnsigned(cursor);
+        current.rxDrops = ScanUnsigned(cursor);
+        SkipFields(cursor, 4);
+        current.txBytes = ScanUnsigned(cursor);
+        current.txPackets = ScanUnsigned(cursor);
+        current.txErrors = ScanUnsigned(cursor);
+        current.txDrops = ScanUnsigned(cursor);
+        
+        auto prevIt = m_prevNetCounters.find(name);
+        bool hasPrev = prevIt != m_prevNetCounters.end() && elapsed > 0.0;
+        const NetCounters& prev = hasPrev ? prevIt->second : current;
+        counters.emplace(name, current);
+        
+        auto rate = [&](uint64_t NetCounters::*field) {
+            return static_cast<float>(CounterDelta(current.*field, prev.*field) / (hasPrev ? elapsed : 1.0));
+        };
+        
+        NetworkInterfaceInfo info;
+        info.name = name;
+        info.downloadMbps = rate(&NetCounters::rxBytes) * 8.0f / 1e6f;
+        info.uploadMbps = rate(&NetCounters::txBytes) * 8.0f / 1e6f;
+        info.rxPacketsPerSec = rate(&NetCounters::rxPackets);
+        info.txPacketsPerSec = rate(&NetCounters::txPackets);
+        info.rxDropsPerSec = rate(&NetCounters::rxDrops);
+        info.txDropsPerSec = rate(&NetCounters::txDrops);
+        info.rxErrorsPerSec = rate(&NetCounters::rxErrors);
+        info.txErrorsPerSec = rate(&NetCounters::txErrors);
+        
+        network.interfaces.push_back(std::move(info));
+    }
+    
+    // Interfaces that disappeared drop out here; one that comes back starts
+    // from a fresh baseline instead of a bogus delta.
+    m_prevNetCounters = std::move(counters);
+    return true;
+}
+
+bool LinuxCollectorBackend::CollectThermal(ThermalInfo& thermal) {
+    thermal.sensors = m_thermalSensors;
+    thermal.packageTemperature = 0.0f;
+    
+    for (size_t i = 0; i < m_thermalInputs.size(); i++) {
+        ThermalSensor& sensor = thermal.sensors[i];
+        uint64_t milliCelsius = 0;
+        if (m_thermalInputs[i].ReadValue(milliCelsius)) {
+            sensor.temperature = static_cast<float>(milliCelsius) / 1000.0f;
+        }
+        if (sensor.kind == ThermalSensorKind::CPUPackage) {
+            thermal.packageTemperature = std::max(thermal.packageTemperature, sensor.temperature);
+        }
+    }
+    
+    // Throttle counters only grow; any increase since the last tick means the
+    // CPU hit its thermal limit in between, even if it has cooled since.
+    uint32_t newEvents = 0;
+    for (size_t i = 0; i < m_throttleCounters.size(); i++) {
+        uint64_t count = 0;
+        if (!m_throttleCounters[i].ReadValue(count)) continue;
+        if (count > m_prevThrottleCounts[i]) {
+            newEvents += static_cast<uint32_t>(count - m_prevThrottleCounts[i]);
+        }
+        m_prevThrottleCounts[i] = count;
+    }
+    m_throttleEvents += newEvents;
+    thermal.throttleEvents = m_throttleEvents;
+    thermal.newThrottleEvents = newEvents;
+    
+    thermal.frequencyCapped = false;
+    for (auto& file : m_processorCoolingStates) {
+        uint64_t state = 0;
+        if (file.ReadValue(state) && state > 0) {
+            thermal.frequencyCapped = true;
+        }
+    }
+    
+    thermal.throttling = newEvents > 0 || thermal.frequencyCapped;
+    return !m_thermalSensors.empty() || !m_throttleCounters.empty();
+}
+
+void LinuxCollectorBackend::DiscoverThermalSensors() {
+    const std::string cpuRoot = "/sys/devices/system/cpu/";
+    
+    for (const auto& entry : ListDirectory(cpuRoot)) {
+        if (entry.size() < 4 || entry.compare(0, 3, "cpu") != 0 || !std::isdigit(static_cast<unsigned char>(entry[3]))) continue;
+        
+        int cpu = std::atoi(entry.c_str() + 3);
+        std::string topology = cpuRoot + entry + "/topology/";
+        uint64_t package = 0, core = 0;
+        if (!ReadSysfsValue((topology + "physical_package_id").c_str(), package)) continue;
+        ReadSysfsValue((topology + "core_id").c_str(), core);
+        
+        bool firstOfPackage = m_packageCpus.find(static_cast<int>(package)) == m_packageCpus.end();
+        m_packageCpus[static_cast<int>(package)].push_back(cpu);
+        m_coreCpus[{static_cast<int>(package), static_cast<int>(core)}].push_back(cpu);
+        
+        // Package counters are shared by every CPU of the package; count
+        // them once.
+        std::string throttle = cpuRoot + entry + "/thermal_throttle/";
+        if (access((throttle + "core_throttle_count").c_str(), R_OK) == 0) {
+            m_throttleCounters.emplace_back().Open(throttle + "core_throttle_count");
+        }
+        if (firstOfPackage && access((throttle + "package_throttle_count").c_str(), R_OK) == 0) {
+            m_throttleCounters.emplace_back().Open(throttle + "package_throttle_count");
+        }
+    }
+    
+    for (const auto& entry : ListDirectory("/sys/class/hwmon")) {
+        AddHwmonSensors("/sys/class/hwmon/" + entry);
+    }
+    
+    bool hasPackageSensor = std::any_of(m_thermalSensors.begin(), m_thermalSensors.end(), [](const ThermalSensor& sensor) {
+        return sensor.kind == ThermalSensorKind::CPUPackage;
+    });
+    
+    // Thermal zones duplicate most hwmon sensors; only the package zone is
+    // used, and only when no hwmon driver reported the package.
+    for (const auto& entry : ListDirectory("/sys/class/thermal")) {
+        std::string path = "/sys/class/thermal/" + entry;
+        std::string type = ReadSysfsLine(path + "/type");
+        
+        if (entry.rfind("thermal_zone", 0) == 0 && type == "x86_pkg_temp" && !hasPackageSensor) {
+            ThermalSensor sensor;
+            sensor.kind = ThermalSensorKind::CPUPackage;
+            sensor.label = type;
+            for (const auto& [package, cpus] : m_packageCpus) {
+                sensor.cpus.insert(sensor.cpus.end(), cpus.begin(), cpus.end());
+            }
+            m_thermalSensors.push_back(sensor);
+            m_thermalInputs.emplace_back().Open(path + "/temp");
+        } else if (entry.rfind("cooling_device", 0) == 0 && (type == "Processor" || type == "intel_powerclamp")) {
+            m_processorCoolingStates.emplace_back().Open(path + "/cur_state");
+        }
+    }
+    
+    m_prevThrottleCounts.assign(m_throttleCounters.size(), 0);
+    for (size_t i = 0; i < m_throttleCounters.size(); i++) {
+        m_throttleCounters[i].ReadValue(m_prevThrottleCounts[i]);
+    }
+    
+    spdlog::info("Thermal sampling: {} sensors, {} throttle counters, {} processor cooling devices",
+                 m_thermalSensors.size(), m_throttleCounters.size(), m_processorCoolingStates.size());
+}
+
+void LinuxCollectorBackend::AddHwmonSensors(const std::string& hwmonPath) {
+    std::string driver = ReadSysfsLine(hwmonPath + "/name");
+    std::string deviceName = LinkTargetName(hwmonPath + "/device");
+    
+    ThermalSensorKind kind = ThermalSensorKind::Other;
+    std::string device;
+    
+    if (driver == "coretemp" || driver == "k10temp" || driver == "zenpower" || driver == "cpu_thermal") {
+        kind = ThermalSensorKind::CPUPackage;
+    } else if (driver == "amdgpu" || driver == "radeon" || driver == "nouveau") {
+        kind = ThermalSensorKind::GPU;
+    } else if (driver == "nvme" || driver == "drivetemp") {
+        // nvme hwmon hangs off the controller (nvme0) with its namespaces
+        // as children; drivetemp hangs off the SCSI device with a block dir.
+        kind = ThermalSensorKind::Disk;
+        for (const auto& child : ListDirectory(hwmonPath + "/device")) {
+            if (child.rfind(deviceName, 0) == 0 && child != deviceName) {
+                device = child;
+                break;
+            }
+        }
+        if (device.empty()) {
+            auto block = ListDirectory(hwmonPath + "/device/block");
+            if (!block.empty()) device = block.front();
+        }
+    }
+    
+    // coretemp registers one platform device per package: "coretemp.<id>".
+    int package = 0;
+    if (driver == "coretemp" && deviceName.rfind("coretemp.", 0) == 0) {
+        package = std::atoi(deviceName.c_str() + 9);
+    }
+    
+    for (const auto& file : ListDirectory(hwmonPath)) {
+        if (file.rfind("temp", 0) != 0 || file.size() < 7 || file.compare(file.size() - 6, 6, "_input") != 0) continue;
+        
+        std::string prefix = hwmonPath + "/" + file.substr(0, file.size() - 6);
+        std::string label = ReadSysfsLine(prefix + "_label");
+        
+        ThermalSensor sensor;
+        sensor.kind = kind;
+        sensor.label = driver + (label.empty() ? "" : " " + label);
+        sensor.device = device;
+        
+        uint64_t critical = 0;
+        if (ReadSysfsValue((prefix + "_crit").c_str(), critical)) {
+            sensor.criticalTemperature = static_cast<float>(critical) / 1000.0f;
+        }
+        
+        if (kind == ThermalSensorKind::CPUPackage) {
+            if (driver == "coretemp" && label.rfind("Core ", 0) == 0) {
+                sensor.kind = ThermalSensorKind::CPUCore;
+                auto core = m_coreCpus.find({package, std::atoi(label.c_str() + 5)});
+                if (core != m_coreCpus.end()) sensor.cpus = core->second;
+            } else if (driver == "coretemp") {
+                auto cpus = m_packageCpus.find(package);
+                if (cpus != m_packageCpus.end()) sensor.cpus = cpus->second;
+            } else {
+                // AMD and ARM drivers report per-die values without a
+                // package id; they cover every CPU.
+                for (const auto& [id, cpus] : m_packageCpus) {
+                    sensor.cpus.insert(sensor.cpus.end(), cpus.begin(), cpus.end());
+                }
+            }
+        }
+        
+        m_thermalSensors.push_back(sensor);
+        m_thermalInputs.emplace_back().Open(prefix + "_input");
+    }
+}
+
+bool LinuxCollectorBackend::CollectPressure(std::vector<PressureInfo>& pressure) {
+    auto now = Clock::now();
+    if (!m_hasPressureGroups || now - m_pressureGroupsRefresh >= kCgroupRefresh) {
+        RefreshPressureGroups();
+        m_pressureGroupsRefresh = now;
+        m_hasPressureGroups = true;
+    }
+    
+    double elapsedUs = SecondsSince(m_prevPressureSample, now) * 1e6;
+    m_prevPressureSample = now;
+    
+    size_t count = 0;
+    auto collect = [&](const std::string& group) {
+        if (count == pressure.size()) pressure.emplace_back();
+        PressureInfo& info = pressure[count];
+        PressureTotals totals;
+        bool any = false;
+        
+        auto& files = m_pressureFiles[group];
+        for (size_t r = 0; r < std::size(kPressureFiles); r++) {
+            PressureStall& stall = info.resources[r];
+            stall = PressureStall{};
+            if (!files[r].IsBound()) files[r].Open(GetPressurePath(group, static_cast<PressureResource>(r)));
+            std::string_view text = files[r].Read();
+            if (text.empty() ||
+                !ParsePressure(text.data(), stall.someAvg10, stall.someTotalUs, stall.fullAvg10, stall.fullTotalUs)) continue;
+            totals.someUs[r] = stall.someTotalUs;
+            totals.fullUs[r] = stall.fullTotalUs;
+            any = true;
+        }
+        if (!any) return;
+        
+        auto prev = m_prevPressure.find(group);
+        if (prev != m_prevPressure.end() && elapsedUs > 0.0) {
+            for (size_t r = 0; r < std::size(kPressureFiles); r++) {
+                PressureStall& stall = info.resources[r];
+                stall.someStallUs = CounterDelta(totals.someUs[r], prev->second.someUs[r]);
+                stall.fullStallUs = CounterDelta(totals.fullUs[r], prev->second.fullUs[r]);
+                stall.somePercent = static_cast<float>(std::min(100.0, stall.someStallUs * 100.0 / elapsedUs));
+                stall.fullPercent = static_cast<float>(std::min(100.0, stall.fullStallUs * 100.0 / elapsedUs));
+            }
+        }
+        m_prevPressure[group] = totals;
+        info.group = group;
+        count++;
+    };
+    
+    collect({});
+    if (count == 0) return false;  // kernel built without CONFIG_PSI
+    
+    for (const auto& group : m_pressureGroups) collect(group);
+    pressure.resize(count);
+    return true;
+}
+
+std::string LinuxCollectorBackend::GetPressurePath(const std::string& group, PressureResource resource) const {
+    const char* file = kPressureFiles[static_cast<size_t>(resource)];
+    if (group.empty()) return std::string("/proc/pressure/") + file;
+    return m_cgroupRoot + "/" + group + "/" + file + ".pressure";
+}
+
+void LinuxCollectorBackend::RefreshPressureGroups() {
+    m_pressureGroups.clear();
+    if (m_cgroupRoot.empty()) return;
+    
+    for (const auto& entry : ListDirectory(m_cgroupRoot)) {
+        if (access((m_cgroupRoot + "/" + entry + "/cpu.pressure").c_str(), R_OK) == 0) {
+            m_pressureGroups.push_back(entry);
+        }
+    }
+    
+    // Baselines and descriptors of removed groups would otherwise pile up
+    // across restarts of transient units.
+    auto removed = [this](const auto& entry) {
+        return !entry.first.empty() && !std::binary_search(m_pressureGroups.begin(), m_pressureGroups.end(), entry.first);
+    };
+    std::erase_if(m_prevPressure, removed);
+    std::erase_if(m_pressureFiles, removed);
+}
+
+bool LinuxCollectorBackend::CollectCgroups(std::vector<CgroupInfo>& groups) {
+    if (m_cgroupRoot.empty()) return false;
+    
+    if (m_cgroupsWatched) DrainCgroupEvents();
+    if (!m_cgroupsWatched) {
+        m_cgroupInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_cgroupInotify < 0) {
+            spdlog::error("Failed to create cgroup watch: {}", std::strerror(errno));
+            return false;
+        }
+        WatchCgroupTree("", 0);
+        m_cgroupsWatched = true;
+        spdlog::info("Watching {} cgroups under {}", m_cgroups.size(), m_cgroupRoot);
+    }
+    
+    auto now = Clock::now();
+    double elapsedUs = SecondsSince(m_prevCgroupSample, now) * 1e6;
+    m_prevCgroupSample = now;
+    
+    groups.resize(m_cgroups.size());
+    size_t index = 0;
+    for (auto& [path, node] : m_cgroups) {
+        CgroupInfo& info = groups[index++];
+        info.path = path;
+        info.depth = node.depth;
+        
+        uint64_t usageUs = 0, throttledUs = 0, throttledPeriods = 0;
+        std::string_view text = node.cpuStat.Read();
+        for (const char* line = text.data(); !text.empty() && *line; line = NextLine(line)) {
+            const char* field = line;
+            std::string_view name = ScanToken(field);
+            if (name == "usage_usec") usageUs = ScanUnsigned(field);
+            else if (name == "nr_throttled") throttledPeriods = ScanUnsigned(field);
+            else if (name == "throttled_usec") throttledUs = ScanUnsigned(field);
+        }
+        
+        uint64_t highEvents = 0, maxEvents = 0, oomKills = 0;
+        text = node.memoryEvents.Read();
+        for (const char* line = text.data(); !text.empty() && *line; line = NextLine(line)) {
+            const char* field = line;
+            std::string_view name = ScanToken(field);
+            if (name == "high") highEvents = ScanUnsigned(field);
+            else if (name == "max") maxEvents = ScanUnsigned(field);
+            else if (name == "oom_kill") oomKills = ScanUnsigned(field);
+        }
+        
+        info.memoryBytes = 0;
+        node.memoryCurrent.ReadValue(info.memoryBytes);
+        
+        // "8:0 rbytes=1 wbytes=2 rios=3 wios=4 ...", one line per device.
+        uint64_t readBytes = 0, writeBytes = 0;
+        text = node.ioStat.Read();
+        for (const char* line = text.data(); !text.empty() && *line; line = NextLine(line)) {
+            const char* field = line;
+            ScanToken(field);
+            while (*field && *field != '\n') {
+                std::string_view token = ScanToken(field);
+                if (token.empty()) break;
+                const char* number = token.data() + token.find('=') + 1;
+                if (token.starts_with("rbytes=")) readBytes += ScanUnsigned(number);
+                else if (token.starts_with("wbytes=")) writeBytes += ScanUnsigned(number);
+            }
+        }
+        
+        info.pids.clear();
+        text = node.procs.Read();
+        for (const char* line = text.data(); !text.empty() && *line; line = NextLine(line)) {
+            const char* field = line;
+            info.pids.push_back(static_cast<unsigned long>(ScanUnsigned(field)));
+        }
+        
+        info.cpuPercent = 0.0f;
+        info.throttledPercent = 0.0f;
+        info.throttledPeriods = 0;
+        info.memoryHighEvents = 0;
+        info.memoryMaxEvents = 0;
+        info.oomKills = 0;
+        info.ioReadMBps = 0.0f;
+        info.ioWriteMBps = 0.0f;
+        if (node.sampled && elapsedUs > 0.0) {
+            info.cpuPercent = static_cast<float>(CounterDelta(usageUs, node.usageUs) * 100.0 / elapsedUs);
+            info.throttledPercent = static_cast<float>(CounterDelta(throttledUs, node.throttledUs) * 100.0 / elapsedUs);
+            info.throttledPeriods = CounterDelta(throttledPeriods, node.throttledPeriods);
+            info.memoryHighEvents = CounterDelta(highEvents, node.highEvents);
+            info.memoryMaxEvents = CounterDelta(maxEvents, node.maxEvents);
+            info.oomKills = CounterDelta(oomKills, node.oomKills);
+            double elapsedSeconds = elapsedUs / 1e6;
+            info.ioReadMBps = static_cast<float>(CounterDelta(readBytes, node.readBytes) / (1024.0 * 1024.0) / elapsedSeconds);
+            info.ioWriteMBps = static_cast<float>(CounterDelta(writeBytes, node.writeBytes) / (1024.0 * 1024.0) / elapsedSeconds);
+        }
+        
+        node.usageUs = usageUs;
+        node.throttledUs = throttledUs;
+        node.throttledPeriods = throttledPeriods;
+        node.highEvents = highEvents;
+        node.maxEvents = maxEvents;
+        node.oomKills = oomKills;
+        node.readBytes = readBytes;
+        node.writeBytes = writeBytes;
+        node.sampled = true;
+    }
+    return true;
+}
+
+// Adds `path` and everything below it; the root itself ("") is watched but
+// not reported.
+void LinuxCollectorBackend::WatchCgroupTree(const std::string& path, int depth) {
+    if (!path.empty()) {
+        if (m_cgroups.find(path) != m_cgroups.end()) return;
+        if (m_cgroups.size() >= kMaxCgroups) {
+            if (!m_cgroupLimitLogged) spdlog::warn("More than {} cgroups, ignoring the rest", kMaxCgroups);
+            m_cgroupLimitLogged = true;
+            return;
+        }
+    }
+    
+    // Watch before listing, so a child created in between is still seen.
+    std::string dir = path.empty() ? m_cgroupRoot : m_cgroupRoot + "/" + path;
+    int watch = inotify_add_watch(m_cgroupInotify, dir.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ONLYDIR);
+    if (watch < 0) {
+        if (errno != ENOENT) spdlog::error("Failed to watch {}: {}", dir, std::strerror(errno));
+        return;
+    }
+    m_cgroupWatches[watch] = path;
+    
+    if (!path.empty()) {
+        CgroupNode& node = m_cgroups[path];
+        node.depth = depth;
+        // Only cpu.stat, read every tick for every group, keeps its
+        // descriptor; the rest are opened per read.
+        auto bind = [&](ProcFile& file, const char* name, bool keepOpen) {
+            if (!file.Open(dir + "/" + name, keepOpen)) file = ProcFile();
+        };
+        bind(node.cpuStat, "cpu.stat", true);
+        bind(node.memoryCurrent, "memory.current", false);
+        bind(node.memoryEvents, "memory.events", false);
+        bind(node.ioStat, "io.stat", false);
+        bind(node.procs, "cgroup.procs", false);
+    }
+    
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) return;
+    std::vector<std::string> children;
+    while (dirent* entry = readdir(handle)) {
+        if (entry->d_type == DT_DIR && entry->d_name[0] != '.') children.push_back(entry->d_name);
+    }
+    closedir(handle);
+    
+    for (const auto& child : children) {
+        WatchCgroupTree(path.empty() ? child : path + "/" + child, depth + 1);
+    }
+}
+
+void LinuxCollectorBackend::ForgetCgroupTree(const std::string& path) {
+    std::string prefix = path + "/";
+    m_cgroups.erase(path);
+    for (auto it = m_cgroups.lower_bound(prefix); it != m_cgroups.end() && it->first.starts_with(prefix); ) {
+        it = m_cgroups.erase(it);
+    }
+    std::erase_if(m_cgroupWatches, [&](const auto& entry) {
+        return entry.second == path || entry.second.starts_with(prefix);
+    });
+    if (m_cgroups.size() < kMaxCgroups) m_cgroupLimitLogged = false;
+}
+
+void LinuxCollectorBackend::DrainCgroupEvents() {
+    alignas(inotify_event) char buffer[4096];
+    bool overflow = false;
+    
+    while (true) {
+        ssize_t length = read(m_cgroupInotify, buffer, sizeof(buffer));
+        if (length <= 0) break;
+        
+        for (ssize_t offset = 0; offset < length; ) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                m_cgroupWatches.erase(event->wd);
+                continue;
+            }
+            
+            auto parent = m_cgroupWatches.find(event->wd);
+            if (parent == m_cgroupWatches.end() || event->len == 0 || !(event->mask & IN_ISDIR)) continue;
+            
+            std::string child = parent->second.empty() ? event->name : parent->second + "/" + event->name;
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                WatchCgroupTree(child, static_cast<int>(std::count(child.begin(), child.end(), '/')) + 1);
+            } else {
+                ForgetCgroupTree(child);
+            }
+        }
+    }
+    
+    // Lost events leave the tree unknown; the caller walks it again.
+    if (overflow) {
+        spdlog::warn("cgroup watch queue overflowed, rescanning");
+        close(m_cgroupInotify);
+        m_cgroupInotify = -1;
+        m_cgroups.clear();
+        m_cgroupWatches.clear();
+        m_cgroupsWatched = false;
+    }
+}
+
+int LinuxCollectorBackend::AddPressureTrigger(const PressureTrigger& trigger, PressureCallback callback) {
+    if (!callback) return -1;
+    
+    std::string path = GetPressurePath(trigger.group, trigger.resource);
+    int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        spdlog::error("Failed to open {} for a pressure trigger: {}", path, std::strerror(errno));
+        return -1;
+    }
+    
+    // "<some|full> <stall us> <window us>", written with its terminator. The
+    // kernel accepts windows of 500 ms to 10 s, and only multiples of 2 s
+    // from unprivileged processes.
+    char spec[64];
+    int length = std::snprintf(spec, sizeof(spec), "%s %lld %lld", trigger.full ? "full" : "some",
+                               static_cast<long long>(trigger.stall.count()), static_cast<long long>(trigger.window.count()));
+    if (write(fd, spec, length + 1) < 0) {
+        spdlog::error("Kernel rejected pressure trigger '{}' on {}: {}", spec, path, std::strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_triggerMutex);
+    if (m_triggerWake < 0) {
+        m_triggerWake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (m_triggerWake < 0) {
+            spdlog::error("Failed to create pressure trigger wakeup: {}", std::strerror(errno));
+            close(fd);
+            return -1;
+        }
+        m_triggerThread = std::thread(&LinuxCollectorBackend::TriggerThread, this);
+    }
+    
+    int id = m_nextTriggerId++;
+    m_triggers.push_back({id, fd, trigger, std::move(callback)});
+    
+    uint64_t one = 1;
+    (void)write(m_triggerWake, &one, sizeof(one));
+    return id;
+}
+
+void LinuxCollectorBackend::RemovePressureTrigger(int id) {
+    std::lock_guard<std::mutex> lock(m_triggerMutex);
+    auto it = std::find_if(m_triggers.begin(), m_triggers.end(), [id](const ArmedTrigger& t) { return t.id == id; });
+    if (it == m_triggers.end()) return;
+    
+    // The poll thread may be waiting on this descriptor; it closes it once
+    // it has rebuilt its poll set.
+    m_retiredTriggerFds.push_back(it->fd);
+    m_triggers.erase(it);
+    
+    uint64_t one = 1;
+    (void)write(m_triggerWake, &one, sizeof(one));
+}
+
+void LinuxCollectorBackend::TriggerThread() {
+    std::vector<pollfd> fds;
+    std::vector<int> ids;
+    
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_triggerMutex);
+            if (m_stopTriggers) return;
+            
+            for (int fd : m_retiredTriggerFds) close(fd);
+            m_retiredTriggerFds.clear();
+            
+            fds.assign(1, pollfd{m_triggerWake, POLLIN, 0});
+            ids.clear();
+            for (const auto& trigger : m_triggers) {
+                fds.push_back(pollfd{trigger.fd, POLLPRI, 0});
+                ids.push_back(trigger.id);
+            }
+        }
+        
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            spdlog::error("Pressure trigger poll failed: {}", std::strerror(errno));
+            return;
+        }
+        
+        // Polling consumes a trigger's pending event, so fired triggers are
+        // handled before a wakeup rebuilds the set.
+        auto now = Clock::now();
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (!fds[i].revents) continue;
+            
+            PressureEvent event;
+            PressureCallback callback;
+            {
+                std::lock_guard<std::mutex> lock(m_triggerMutex);
+                auto it = std::find_if(m_triggers.begin(), m_triggers.end(), [&](const ArmedTrigger& t) { return t.id == ids[i - 1]; });
+                if (it == m_triggers.end()) continue;
+                
+                // POLLERR: the cgroup the trigger watched has been removed.
+                if (fds[i].revents & (POLLERR | POLLNVAL)) {
+                    spdlog::warn("Pressure trigger {} on '{}' is gone, disarming it", it->id, it->trigger.group);
+                    m_retiredTriggerFds.push_back(it->fd);
+                    m_triggers.erase(it);
+                    uint64_t one = 1;
+                    (void)write(m_triggerWake, &one, sizeof(one));
+                    continue;
+                }
+                
+                event.triggerId = it->id;
+                event.trigger = it->trigger;
+                callback = it->callback;
+            }
+            event.time = now;
+            callback(event);
+        }
+        
+        if (fds[0].revents & POLLIN) {
+            uint64_t count = 0;
+            (void)read(m_triggerWake, &count, sizeof(count));
+        }
+    }
+}
+
+bool LinuxCollectorBackend::CollectProcesses(std::vector<ProcessSample>& samples) {
+    if (!m_processStats.Refresh()) {
+        spdlog::error("Failed to list /proc");
+        return false;
+    }
+    
+    size_t count = 0;
+    for (size_t i = 0; i < m_processStats.GetCount(); i++) {
+        std::string_view stat = m_processStats.Read(i);
+        if (stat.empty()) continue;  // exited since the listing
+        
+        if (count == samples.size()) samples.emplace_back();
+        if (ParseProcessStat(stat.data(), samples[count])) count++;
+    }
+    
+    samples.resize(count);
+    return true;
+}
+
+bool LinuxCollectorBackend::CollectThreads(unsigned long pid, std::vector<ThreadSample>& samples) {
+    // The task files of the watched process stay open between ticks, like
+    // those of the process list.
+    if (!m_threadFiles || m_threadPid != pid) {
+        char path[64];
+        std::snprintf(path, sizeof(path), "/proc/%lu/task", pid);
+        m_threadFiles = std::make_unique<PidFileReader>(
+            path, std::initializer_list<const char*>{"stat", "schedstat", "status", "sched"});
+        m_threadPid = pid;
+    }
+    
+    // A process always has a thread, so an empty listing means it exited
+    // and the directory descriptor is stale.
+    bool listed = m_threadFiles->Refresh();
+    if (!listed || m_threadFiles->GetCount() == 0) {
+        if (!listed && errno != ENOENT) spdlog::error("Failed to list threads of {}: {}", pid, std::strerror(errno));
+        m_threadFiles.reset();
+        return false;
+    }
+    
+    size_t count = 0;
+    for (size_t i = 0; i < m_threadFiles->GetCount(); i++) {
+        if (count == samples.size()) samples.emplace_back();
+        if (ReadThreadSample(i, samples[count])) count++;
+    }
+    
+    samples.resize(count);
+    return true;
+}
+
+// schedstat holds run time, run-queue wait (both ns) and timeslices; it is
+// missing without CONFIG_SCHEDSTATS, in which case only switches are known.
+// sched needs CONFIG_SCHED_DEBUG and is the only source of migrations.
+bool LinuxCollectorBackend::ReadThreadSample(size_t index, ThreadSample& sample) {
+    enum { kStat, kSchedstat, kStatus, kSched };
+    
+    std::string_view text = m_threadFiles->Read(index, kStat);
+    if (text.empty()) return false;  // exited
+    
+    const char* nameStart = std::strchr(text.data(), '(');
+    const char* nameEnd = std::strrchr(text.data(), ')');
+    if (!nameStart || !nameEnd || nameEnd < nameStart) return false;
+    
+    sample = ThreadSample{};
+    sample.tid = m_threadFiles->GetId(index);
+    sample.name.assign(nameStart + 1, nameEnd);
+    
+    // Field 39 is the CPU the thread last ran on; fields count from the ')'.
+    uint64_t utime = 0, stime = 0;
+    const char* cursor = nameEnd + 2;
+    for (int field = 3; field <= 39 && cursor && *cursor; field++) {
+        if (field == 14) utime = std::strtoull(cursor, nullptr, 10);
+        if (field == 15) stime = std::strtoull(cursor, nullptr, 10);
+        if (field == 39) sample.lastCpu = std::atoi(cursor);
+        cursor = std::strchr(cursor, ' ');
+        if (cursor) cursor++;
+    }
+    
+    unsigned long long run = 0, wait = 0, slices = 0;
+    text = m_threadFiles->Read(index, kSchedstat);
+    if (!text.empty() && std::sscanf(text.data(), "%llu %llu %llu", &run, &wait, &slices) == 3) {
+        sample.runTimeNs = run;
+        sample.waitTimeNs = wait;
+        sample.timeslices = slices;
+    } else {
+        sample.runTimeNs = (utime + stime) * m_nsPerClockTick;
+    }
+    
+    text = m_threadFiles->Read(index, kStatus);
+    if (!text.empty()) {
+        FindKeyedValue(text.data(), "voluntary_ctxt_switches", sample.voluntarySwitches);
+        FindKeyedValue(text.data(), "nonvoluntary_ctxt_switches", sample.involuntarySwitches);
+    }
+    
+    text = m_threadFiles->Read(index, kSched);
+    if (!text.empty()) {
+        FindKeyedValue(text.data(), "se.nr_migrations", sample.migrations);
+    }
+    return true;
+}
+
+// /proc/[pid]/stat: "pid (comm) state ppid ..." where comm may itself
+// contain spaces and parentheses, so fields are counted from the last ')'.
+bool LinuxCollectorBackend::ParseProcessStat(const char* stat, ProcessSample& sample) const {
+    const char* nameStart = std::strchr(stat, '(');
+    const char* nameEnd = std::strrchr(stat, ')');
+    if (!nameStart || !nameEnd || nameEnd < nameStart || nameEnd[1] != ' ') return false;
+    
+    const char* cursor = stat;
+    sample.pid = static_cast<unsigned long>(ScanUnsigned(cursor));
+    sample.name.assign(nameStart + 1, nameEnd);
+    
+    // Fields 3-13 include signed values; only the ones used are scanned.
+    cursor = nameEnd + 1;
+    SkipFields(cursor, 11);
+    uint64_t utime = ScanUnsigned(cursor);
+    uint64_t stime = ScanUnsigned(cursor);
+    SkipFields(cursor, 4);
+    uint64_t threads = ScanUnsigned(cursor);
+    SkipFields(cursor, 1);
+    uint64_t startTime = ScanUnsigned(cursor);
+    SkipFields(cursor, 1);
+    uint64_t rssPages = ScanUnsigned(cursor);
+    if (cursor[-1] < '0' || cursor[-1] > '9') return false;  // truncated
+    
+    sample.startTime = startTime;
+    sample.cpuTimeNs = (utime + stime) * m_nsPerClockTick;
+    sample.residentBytes = rssPages * m_pageSize;
+    sample.threads = static_cast<int>(threads);
+    sample.handles = 0;
+    return true;
+}
+
+// smaps_rollup (Linux 4.14+) has the totals of every mapping; older kernels
+// only have the per-mapping smaps, which the same key scan sums up.
+bool LinuxCollectorBackend::QueryProcessMemory(unsigned long pid, ProcessMemoryInfo& info) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%lu/smaps_rollup", pid);
+    
+    ProcFile smaps;
+    bool opened = smaps.Open(path);
+    if (!opened && errno == ENOENT && access(("/proc/" + std::to_string(pid)).c_str(), F_OK) == 0) {
+        std::snprintf(path, sizeof(path), "/proc/%lu/smaps", pid);
+        opened = smaps.Open(path);
+    }
+    if (!opened) {
+        // ESRCH: the process exited or has no address space of its own.
+        if (errno != ENOENT && errno != ESRCH) spdlog::error("Failed to open {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    
+    // Empty for kernel threads, which map no memory of their own.
+    std::string_view text = smaps.Read();
+    if (text.empty()) return false;
+    
+    uint64_t rssKB = 0, pssKB = 0, privateKB = 0, sharedKB = 0, swapKB = 0;
+    std::string_view key;
+    uint64_t value = 0;
+    for (const char* cursor = text.data(); ScanKeyedLine(cursor, key, value); ) {
+        if (key == "Rss") rssKB += value;
+        else if (key == "Pss") pssKB += value;
+        else if (key == "Private_Clean" || key == "Private_Dirty") privateKB += value;
+        else if (key == "Shared_Clean" || key == "Shared_Dirty") sharedKB += value;
+        else if (key == "Swap") swapKB += value;
+    }
+    
+    info = ProcessMemoryInfo{};
+    info.pid = pid;
+    info.residentBytes = rssKB * 1024;
+    info.proportionalBytes = pssKB * 1024;
+    info.uniqueBytes = privateKB * 1024;
+    info.sharedBytes = sharedKB * 1024;
+    info.swapBytes = swapKB * 1024;
+    info.sampledAt = std::chrono::steady_clock::now();
+    return true;
+}
+
+}
@@ -0,0 +1,228 @@
+#pragma once
+#include "../collector_backend.h"
+#include "linux_proc_reader.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Monitor {
+
+class LinuxCollectorBackend : public CollectorBackend {
+public:
+    LinuxCollectorBackend();
+    ~LinuxCollectorBackend() override;
+    
+    const char* GetName() const override { return "Linux procfs"; }
+    std::vector<std::string> GetCpuIdleStates() const override { return m_idleStateNames; }
+    
+    bool DiscoverTopology(TopologySource& source) override;
+    bool CollectCPU(std::vector<CPUCoreInfo>& cores) override;
+    bool CollectGPU(GPUInfo& gpu) override;
+    bool CollectRAM(RAMInfo& ram) override;
+    bool CollectDisks(std::vector<DiskInfo>& disks) override;
+    bool CollectNetwork(NetworkInfo& network) override;
+    bool CollectProcesses(std::vector<ProcessSample>& samples) override;
+    bool CollectThermal(ThermalInfo& thermal) override;
+    bool CollectPressure(std::vector<PressureInfo>& pressure) override;
+    bool CollectNuma(std::vector<NumaNodeInfo>& nodes) override;
+    bool CollectCgroups(std::vector<CgroupInfo>& groups) override;
+    bool QueryProcessNuma(unsigned long pid, ProcessNumaInfo& info) override;
+    bool CollectThreads(unsigned long pid, std::vector<ThreadSample>& samples) override;
+    bool QueryProcessMemory(unsigned long pid, ProcessMemoryInfo& info) override;
+    
+    int AddPressureTrigger(const PressureTrigger& trigger, PressureCallback callback) override;
+    void RemovePressureTrigger(int id) override;
+    
+private:
+    struct CPUTimes {
+        uint64_t busy = 0;
+        uint64_t total = 0;
+    };
+    
+    struct DiskCounters {
+        uint64_t readIOs = 0;
+        uint64_t readSectors = 0;
+        uint64_t readTicks = 0;
+        uint64_t writeIOs = 0;
+        uint64_t writeSectors = 0;
+        uint64_t writeTicks = 0;
+        uint64_t ioTicks = 0;
+        uint64_t queueTicks = 0;
+    };
+    
+    struct DiskTopology {
+        std::vector<std::string> mountPoints;
+        float usagePercent = 0.0f;
+    };
+    
+    struct NetCounters {
+        uint64_t rxBytes = 0;
+        uint64_t rxPackets = 0;
+        uint64_t rxErrors = 0;
+        uint64_t rxDrops = 0;
+        uint64_t txBytes = 0;
+        uint64_t txPackets = 0;
+        uint64_t txErrors = 0;
+        uint64_t txDrops = 0;
+    };
+    
+    struct PressureTotals {
+        std::array<uint64_t, static_cast<size_t>(PressureResource::Count)> someUs{};
+        std::array<uint64_t, static_cast<size_t>(PressureResource::Count)> fullUs{};
+    };
+    
+    // numastat counters, in the order of NumaNodeInfo's rates.
+    struct NumaNode {
+        int id = 0;
+        ProcFile meminfo;
+        ProcFile numastat;
+        std::array<uint64_t, 4> prevCounters{};
+    };
+    
+    // Accounting files of one cgroup and its cumulative counters as of the
+    // previous tick. Files of controllers not enabled for the group stay
+    // unbound.
+    struct CgroupNode {
+        int depth = 1;
+        ProcFile cpuStat;
+        ProcFile memoryCurrent;
+        ProcFile memoryEvents;
+        ProcFile ioStat;
+        ProcFile procs;
+        uint64_t usageUs = 0;
+        uint64_t throttledUs = 0;
+        uint64_t throttledPeriods = 0;
+        uint64_t highEvents = 0;
+        uint64_t maxEvents = 0;
+        uint64_t oomKills = 0;
+        uint64_t readBytes = 0;
+        uint64_t writeBytes = 0;
+        bool sampled = false;
+    };
+    
+    struct ArmedTrigger {
+        int id;
+        int fd;
+        PressureTrigger trigger;
+        PressureCallback callback;
+    };
+    
+    using Clock = std::chrono::steady_clock;
+    
+    void DiscoverCpuFeatures();
+    void SampleIdleStates(int coreID, double elapsedUs, CPUCoreInfo& info);
+    void ReadCpuinfoFrequencies();
+    void DiscoverThermalSensors();
+    void DiscoverNumaNodes();
+    void AddHwmonSensors(const std::string& hwmonPath);
+    bool ParseProcessStat(const char* stat, ProcessSample& sample) const;
+    bool ReadThreadSample(size_t index, ThreadSample& sample);
+    void RefreshDiskTopology();
+    std::string GetPressurePath(const std::string& group, PressureResource resource) const;
+    void RefreshPressureGroups();
+    void WatchCgroupTree(const std::string& path, int depth);
+    void ForgetCgroupTree(const std::string& path);
+    void DrainCgroupEvents();
+    void TriggerThread();
+    
+    // Hot files stay open between ticks and are re-read with pread.
+    ProcFile m_procStat;
+    ProcFile m_procMeminfo;
+    ProcFile m_procVmstat;
+    ProcFile m_procDiskstats;
+    ProcFile m_procNetdev;
+    PidFileReader m_processStats{"/proc", "stat"};
+    
+    // Task files of the process last asked for by CollectThreads.
+    std::unique_ptr<PidFileReader> m_threadFiles;
+    unsigned long m_threadPid = 0;
+    
+    std::vector<CPUTimes> m_prevCpuTimes;
+    Clock::time_point m_prevCpuSample;
+    
+    // cpuidle states are discovered once from cpu0; residency is the delta
+    // of each state's cumulative time in microseconds.
+    std::vector<std::string> m_idleStateNames;
+    std::vector<bool> m_idleStateDeep;
+    std::vector<std::vector<uint64_t>> m_prevIdleTimes;
+    std::vector<std::vector<ProcFile>> m_idleTimeFiles;
+    bool m_hasCpufreq = false;
+    std::vector<ProcFile> m_cpufreqFiles;
+    ProcFile m_procCpuinfo;
+    std::vector<float> m_cpuinfoMHz;
+    Clock::time_point m_cpuinfoRefresh;
+    
+    // Thermal sensors are discovered once; m_thermalInputs holds the
+    // millidegree input file behind each entry of m_thermalSensors.
+    std::vector<ThermalSensor> m_thermalSensors;
+    std::vector<ProcFile> m_thermalInputs;
+    std::vector<ProcFile> m_throttleCounters;
+    std::vector<uint64_t> m_prevThrottleCounts;
+    uint64_t m_throttleEvents = 0;
+    std::vector<ProcFile> m_processorCoolingStates;
+    std::map<int, std::vector<int>> m_packageCpus;
+    std::map<std::pair<int, int>, std::vector<int>> m_coreCpus;
+    
+    uint64_t m_prevSwapIn = 0;
+    uint64_t m_prevSwapOut = 0;
+    bool m_hasSwapCounters = false;
+    Clock::time_point m_prevRamSample;
+    
+    std::vector<NumaNode> m_numaNodes;
+    Clock::time_point m_prevNumaSample;
+    bool m_hasNumaCounters = false;
+    
+    std::map<std::string, DiskCounters, std::less<>> m_prevDiskCounters;
+    Clock::time_point m_prevDiskSample;
+    
+    // Whole block devices and where they are mounted. Mounts change rarely,
+    // so this is rebuilt on a slow timer rather than every disk tick.
+    std::map<std::string, DiskTopology, std::less<>> m_diskTopology;
+    Clock::time_point m_diskTopologyRefresh;
+    bool m_hasDiskTopology = false;
+    
+    std::map<std::string, NetCounters, std::less<>> m_prevNetCounters;
+    Clock::time_point m_prevNetSample;
+    
+    // Per-cgroup pressure covers the first level of the cgroup v2 hierarchy
+    // (system.slice, user.slice, ...), rescanned on the topology timer.
+    std::string m_cgroupRoot;
+    std::vector<std::string> m_pressureGroups;
+    Clock::time_point m_pressureGroupsRefresh;
+    bool m_hasPressureGroups = false;
+    std::map<std::string, PressureTotals> m_prevPressure;
+    std::map<std::string, std::array<ProcFile, static_cast<size_t>(PressureResource::Count)>> m_pressureFiles;
+    Clock::time_point m_prevPressureSample;
+    
+    // The whole cgroup tree is walked once; afterwards inotify reports the
+    // groups created and removed. Keyed by path, so every parent sorts
+    // before its children.
+    std::map<std::string, CgroupNode, std::less<>> m_cgroups;
+    std::map<int, std::string> m_cgroupWatches;
+    int m_cgroupInotify = -1;
+    bool m_cgroupsWatched = false;
+    bool m_cgroupLimitLogged = false;
+    Clock::time_point m_prevCgroupSample;
+    
+    // Armed triggers are polled on their own thread, which also owns closing
+    // their descriptors; m_triggerWake is an eventfd that interrupts the
+    // poll when the set changes or the backend shuts down.
+    std::mutex m_triggerMutex;
+    std::vector<ArmedTrigger> m_triggers;
+    std::vector<int> m_retiredTriggerFds;
+    std::thread m_triggerThread;
+    int m_triggerWake = -1;
+    int m_nextTriggerId = 1;
+    bool m_stopTriggers = false;
+    
+    uint64_t m_nsPerClockTick = 0;
+    uint64_t m_pageSize = 0;
+};
+
+}
@@ -0,0 +1,94 @@
+#include "../mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Monitor {
+
+bool MappedFile::Create(const std::string& path, size_t size) {
+    Close();
+    
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        spdlog::error("Cannot create {}: {}", path, strerror(errno));
+        return false;
+    }
+    
+    // A sparse file would turn a full disk into SIGBUS on the first store
+    // into an unbacked page.
+    int error = posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (error != 0) {
+        spdlog::error("Cannot reserve {} bytes for {}: {}", size, path, strerror(error));
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        spdlog::error("Cannot map {}: {}", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+    
+    m_data = static_cast<uint8_t*>(data);
+    m_size = size;
+    m_file = fd;
+    return true;
+}
+
+bool MappedFile::Open(const std::string& path, bool writable) {
+    Close();
+    
+    int fd = open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        spdlog::error("Cannot open {}: {}", path, strerror(errno));
+        return false;
+    }
+    
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        spdlog::error("Cannot map {}: empty or unreadable", path);
+        close(fd);
+        return false;
+    }
+    
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        spdlog::error("Cannot map {}: {}", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+    
+    m_data = static_cast<uint8_t*>(data);
+    m_size = size;
+    m_file = fd;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) munmap(m_data, m_size);
+    if (m_file >= 0) close(static_cast<int>(m_file));
+    
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+}
+
+void MappedFile::Flush(size_t offset, size_t length) {
+    if (!m_data || offset >= m_size) return;
+    
+    // msync wants a page-aligned start.
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = offset - offset % pageSize;
+    size_t end = std::min(offset + length, m_size);
+    msync(m_data + start, end - start, MS_ASYNC);
+}
+
+}
@@ -0,0 +1,308 @@
+#include "linux_proc_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Monitor {
+
+namespace {
+
+constexpr size_t kInitialFileBuffer = 4096;
+constexpr size_t kDirectoryBuffer = 32768;
+constexpr size_t kDefaultFdBudget = 4096;
+
+// linux_dirent64: u64 d_ino, s64 d_off, u16 d_reclen, u8 d_type, d_name.
+constexpr size_t kDirentReclenOffset = 16;
+constexpr size_t kDirentNameOffset = 19;
+
+thread_local uint64_t t_syscalls = 0;
+
+// 0 until first used, then the shared limit on kept descriptors.
+std::atomic<size_t> g_keptLimit{0};
+std::atomic<size_t> g_kept{0};
+
+bool TryKeepDescriptor() {
+    size_t limit = GetKeptDescriptorLimit();
+    size_t kept = g_kept.load(std::memory_order_relaxed);
+    while (kept < limit) {
+        if (g_kept.compare_exchange_weak(kept, kept + 1, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+void ReleaseKeptDescriptor() {
+    g_kept.fetch_sub(1, std::memory_order_relaxed);
+}
+
+int OpenCounted(int dirFd, const char* path) {
+    t_syscalls++;
+    return openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+}
+
+void CloseCounted(int fd) {
+    t_syscalls++;
+    close(fd);
+}
+
+ssize_t PreadCounted(int fd, char* buffer, size_t size, size_t offset) {
+    t_syscalls++;
+    return pread(fd, buffer, size, static_cast<off_t>(offset));
+}
+
+// Reads all of `fd` from offset 0, growing `buffer` while the file fills it.
+// A short read marks the end, as procfs and sysfs fill every read they can.
+ssize_t ReadWhole(int fd, std::vector<char>& buffer) {
+    if (buffer.empty()) buffer.resize(kInitialFileBuffer);
+    
+    size_t length = 0;
+    while (true) {
+        ssize_t n = PreadCounted(fd, buffer.data() + length, buffer.size() - 1 - length, length);
+        if (n < 0) return -1;
+        length += static_cast<size_t>(n);
+        if (n == 0 || length < buffer.size() - 1) break;
+        buffer.resize(buffer.size() * 2);
+    }
+    buffer[length] = '\0';
+    return static_cast<ssize_t>(length);
+}
+
+}
+
+uint64_t ProcReaderSyscalls() {
+    return t_syscalls;
+}
+
+size_t GetKeptDescriptorLimit() {
+    size_t limit = g_keptLimit.load(std::memory_order_relaxed);
+    if (limit) return limit;
+    
+    // Kept descriptors count against the host application's RLIMIT_NOFILE;
+    // a quarter of the soft limit at most leaves it room for its own.
+    limit = kDefaultFdBudget;
+    rlimit rlim{};
+    if (getrlimit(RLIMIT_NOFILE, &rlim) == 0 && rlim.rlim_cur != RLIM_INFINITY) {
+        limit = std::clamp<size_t>(rlim.rlim_cur / 4, 1, limit);
+    }
+    size_t unset = 0;
+    g_keptLimit.compare_exchange_strong(unset, limit, std::memory_order_relaxed);
+    return g_keptLimit.load(std::memory_order_relaxed);
+}
+
+void SetKeptDescriptorLimit(size_t limit) {
+    g_keptLimit.store(std::max<size_t>(limit, 1), std::memory_order_relaxed);
+}
+
+size_t GetKeptDescriptors() {
+    return g_kept.load(std::memory_order_relaxed);
+}
+
+ProcFile::~ProcFile() {
+    Close();
+}
+
+ProcFile::ProcFile(ProcFile&& other) noexcept
+    : m_fd(other.m_fd), m_keepOpen(other.m_keepOpen), m_path(std::move(other.m_path)),
+      m_buffer(std::move(other.m_buffer)) {
+    other.m_fd = -1;
+}
+
+ProcFile& ProcFile::operator=(ProcFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        m_fd = other.m_fd;
+        m_keepOpen = other.m_keepOpen;
+        m_path = std::move(other.m_path);
+        m_buffer = std::move(other.m_buffer);
+        other.m_fd = -1;
+    }
+    return *this;
+}
+
+bool ProcFile::Open(std::string path, bool keepOpen) {
+    Close();
+    m_path = std::move(path);
+    m_keepOpen = keepOpen;
+    
+    int fd = OpenCounted(AT_FDCWD, m_path.c_str());
+    if (fd < 0) return false;
+    if (m_keepOpen && TryKeepDescriptor()) {
+        m_fd = fd;
+    } else {
+        CloseCounted(fd);
+    }
+    return true;
+}
+
+void ProcFile::Close() {
+    if (m_fd >= 0) {
+        CloseCounted(m_fd);
+        ReleaseKeptDescriptor();
+    }
+    m_fd = -1;
+}
+
+std::string_view ProcFile::Read() {
+    if (m_path.empty()) return {};
+    
+    if (m_fd >= 0) {
+        ssize_t length = ReadWhole(m_fd, m_buffer);
+        if (length >= 0) return std::string_view(m_buffer.data(), static_cast<size_t>(length));
+        Close();
+    }
+    
+    int fd = OpenCounted(AT_FDCWD, m_path.c_str());
+    if (fd < 0) return {};
+    
+    ssize_t length = ReadWhole(fd, m_buffer);
+    if (length >= 0 && m_keepOpen && TryKeepDescriptor()) {
+        m_fd = fd;
+    } else {
+        CloseCounted(fd);
+    }
+    if (length < 0) return {};
+    return std::string_view(m_buffer.data(), static_cast<size_t>(length));
+}
+
+bool ProcFile::ReadValue(uint64_t& value) {
+    std::string_view text = Read();
+    if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+    
+    const char* cursor = text.data();
+    value = ScanUnsigned(cursor);
+    return true;
+}
+
+DirectoryReader::~DirectoryReader() {
+    if (m_fd >= 0) CloseCounted(m_fd);
+}
+
+bool DirectoryReader::Open(const char* path) {
+    if (m_fd >= 0) CloseCounted(m_fd);
+    t_syscalls++;
+    m_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    return m_fd >= 0;
+}
+
+bool DirectoryReader::ListNumeric(std::vector<uint32_t>& ids) {
+    ids.clear();
+    if (m_fd < 0) return false;
+    
+    t_syscalls++;
+    if (lseek(m_fd, 0, SEEK_SET) < 0) return false;
+    if (m_buffer.empty()) m_buffer.resize(kDirectoryBuffer);
+    
+    while (true) {
+        t_syscalls++;
+        long length = syscall(SYS_getdents64, m_fd, m_buffer.data(), m_buffer.size());
+        if (length < 0) return false;
+        if (length == 0) break;
+        
+        for (long offset = 0; offset < length; ) {
+            const char* record = m_buffer.data() + offset;
+            unsigned short recordLength = 0;
+            std::memcpy(&recordLength, record + kDirentReclenOffset, sizeof(recordLength));
+            offset += recordLength;
+            
+            const char* name = record + kDirentNameOffset;
+            if (*name < '1' || *name > '9') continue;
+            const char* end = name;
+            uint64_t id = ScanUnsigned(end);
+            if (*end == '\0' && id <= UINT32_MAX) ids.push_back(static_cast<uint32_t>(id));
+        }
+    }
+    return true;
+}
+
+PidFileReader::PidFileReader(const char* root, const char* file, size_t fdBudget)
+    : PidFileReader(root, {file}, fdBudget) {}
+
+PidFileReader::PidFileReader(const char* root, std::initializer_list<const char*> files, size_t fdBudget)
+    : m_files(files.begin(), files.begin() + std::min(files.size(), kMaxFiles)) {
+    m_dir.Open(root);
+    
+    // Half the shared limit by default leaves the rest to the fixed files
+    // and to other readers.
+    m_fdBudget = fdBudget ? fdBudget : std::max<size_t>(GetKeptDescriptorLimit() / 2, 1);
+}
+
+PidFileReader::~PidFileReader() {
+    for (Entry& entry : m_entries) CloseEntry(entry);
+}
+
+void PidFileReader::CloseEntry(Entry& entry) {
+    for (int& fd : entry.fds) {
+        if (fd < 0) continue;
+        CloseCounted(fd);
+        ReleaseKeptDescriptor();
+        m_openFds--;
+        fd = -1;
+    }
+}
+
+bool PidFileReader::Refresh() {
+    if (!m_dir.ListNumeric(m_ids)) return false;
+    if (!std::is_sorted(m_ids.begin(), m_ids.end())) std::sort(m_ids.begin(), m_ids.end());
+    
+    // Both lists are sorted: descriptors carry over for ids still listed and
+    // are closed for the rest.
+    m_merged.clear();
+    auto old = m_entries.begin();
+    for (uint32_t id : m_ids) {
+        for (; old != m_entries.end() && old->id < id; ++old) CloseEntry(*old);
+        
+        Entry entry{id, {}};
+        entry.fds.fill(-1);
+        if (old != m_entries.end() && old->id == id) {
+            entry.fds = old->fds;
+            ++old;
+        }
+        m_merged.push_back(entry);
+    }
+    for (; old != m_entries.end(); ++old) CloseEntry(*old);
+    
+    m_entries.swap(m_merged);
+    return true;
+}
+
+int PidFileReader::OpenEntry(uint32_t id, size_t file) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "%u/%s", id, m_files[file].c_str());
+    return OpenCounted(m_dir.GetFd(), path);
+}
+
+std::string_view PidFileReader::Read(size_t index, size_t file) {
+    Entry& entry = m_entries[index];
+    int& kept = entry.fds[file];
+    
+    if (kept >= 0) {
+        ssize_t length = ReadWhole(kept, m_buffer);
+        if (length >= 0) return std::string_view(m_buffer.data(), static_cast<size_t>(length));
+        
+        // The process behind the descriptor exited; its id may already
+        // belong to a new one, which needs a fresh open.
+        CloseCounted(kept);
+        ReleaseKeptDescriptor();
+        kept = -1;
+        m_openFds--;
+    }
+    
+    int fd = OpenEntry(entry.id, file);
+    if (fd < 0) return {};
+    
+    ssize_t length = ReadWhole(fd, m_buffer);
+    if (length >= 0 && m_openFds < m_fdBudget && TryKeepDescriptor()) {
+        kept = fd;
+        m_openFds++;
+    } else {
+        CloseCounted(fd);
+    }
+    if (length < 0) return {};
+    return std::string_view(m_buffer.data(), static_cast<size_t>(length));
+}
+
+}
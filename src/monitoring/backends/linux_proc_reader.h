@@ -0,0 +1,198 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Monitor {
+
+// Syscalls issued by the reader layer on the calling thread, for
+// benchmarks and self-measurement.
+uint64_t ProcReaderSyscalls();
+
+// Descriptors kept open between reads by every ProcFile and PidFileReader
+// in the process, which all draw on one budget so the host application
+// keeps room under RLIMIT_NOFILE for its own files and sockets. The default
+// is a quarter of the soft limit, at most 4096; a program that raises its
+// own limit may set another. Reads past the budget open, read and close.
+size_t GetKeptDescriptorLimit();
+void SetKeptDescriptorLimit(size_t limit);
+size_t GetKeptDescriptors();
+
+// Allocation-free scanning over NUL-terminated procfs text. Each scanner
+// skips leading blanks and leaves `cursor` just past what it consumed.
+inline uint64_t ScanUnsigned(const char*& cursor) {
+    const char* p = cursor;
+    while (*p == ' ' || *p == '\t') p++;
+    
+    uint64_t value = 0;
+    for (unsigned digit; (digit = static_cast<unsigned char>(*p) - '0') < 10; p++) {
+        value = value * 10 + digit;
+    }
+    cursor = p;
+    return value;
+}
+
+inline int64_t ScanSigned(const char*& cursor) {
+    while (*cursor == ' ' || *cursor == '\t') cursor++;
+    bool negative = *cursor == '-';
+    cursor += negative;
+    uint64_t value = ScanUnsigned(cursor);
+    return negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+}
+
+// Skips `count` blank-separated tokens of any kind.
+inline void SkipFields(const char*& cursor, int count) {
+    const char* p = cursor;
+    for (; count > 0; count--) {
+        while (*p == ' ' || *p == '\t') p++;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\n') p++;
+    }
+    cursor = p;
+}
+
+inline std::string_view ScanToken(const char*& cursor) {
+    while (*cursor == ' ' || *cursor == '\t') cursor++;
+    const char* start = cursor;
+    while (*cursor && *cursor != ' ' && *cursor != '\t' && *cursor != '\n') cursor++;
+    return std::string_view(start, static_cast<size_t>(cursor - start));
+}
+
+// Start of the next line, or the terminating NUL.
+inline const char* NextLine(const char* cursor) {
+    while (*cursor && *cursor != '\n') cursor++;
+    return *cursor ? cursor + 1 : cursor;
+}
+
+// Parses one "Key:   value [kB]" line as found in meminfo and status files
+// and moves to the next line. Returns false at the end of the text.
+inline bool ScanKeyedLine(const char*& cursor, std::string_view& key, uint64_t& value) {
+    while (*cursor) {
+        const char* line = cursor;
+        const char* colon = line;
+        while (*colon && *colon != ':' && *colon != '\n') colon++;
+        
+        cursor = NextLine(colon);
+        if (*colon != ':') continue;
+        
+        key = std::string_view(line, static_cast<size_t>(colon - line));
+        const char* number = colon + 1;
+        value = ScanUnsigned(number);
+        return true;
+    }
+    return false;
+}
+
+// A procfs or sysfs file kept open between samples and re-read from offset
+// 0 with pread into a buffer that only ever grows, so a steady-state sample
+// is one syscall and no allocation. The descriptor is reopened on the next
+// read when a read fails, which covers files that went stale (an exited
+// process, a removed device). Without room in the descriptor budget, or
+// when bound with `keepOpen` false, each read opens and closes the file.
+class ProcFile {
+public:
+    ProcFile() = default;
+    ~ProcFile();
+    
+    ProcFile(ProcFile&& other) noexcept;
+    ProcFile& operator=(ProcFile&& other) noexcept;
+    ProcFile(const ProcFile&) = delete;
+    ProcFile& operator=(const ProcFile&) = delete;
+    
+    // Binds the file to `path` and opens it; a file that fails to open now
+    // is retried on each Read.
+    bool Open(std::string path, bool keepOpen = true);
+    void Close();
+    
+    bool IsBound() const { return !m_path.empty(); }
+    const std::string& GetPath() const { return m_path; }
+    
+    // Whole contents, NUL-terminated, valid until the next Read. Empty when
+    // the file cannot be read.
+    std::string_view Read();
+    
+    // Leading unsigned integer of a single-value sysfs attribute.
+    bool ReadValue(uint64_t& value);
+    
+private:
+    int m_fd = -1;
+    bool m_keepOpen = true;
+    std::string m_path;
+    std::vector<char> m_buffer;
+};
+
+// Directory listing through getdents64 into a fixed buffer, rewinding the
+// same descriptor each time instead of opendir/readdir/closedir.
+class DirectoryReader {
+public:
+    DirectoryReader() = default;
+    ~DirectoryReader();
+    
+    DirectoryReader(const DirectoryReader&) = delete;
+    DirectoryReader& operator=(const DirectoryReader&) = delete;
+    
+    bool Open(const char* path);
+    int GetFd() const { return m_fd; }
+    
+    // Entries whose names are positive integers (pids, tids), in directory
+    // order. `ids` is cleared first and keeps its capacity.
+    bool ListNumeric(std::vector<uint32_t>& ids);
+    
+private:
+    int m_fd = -1;
+    std::vector<char> m_buffer;
+};
+
+// Files under every numeric entry of a directory, e.g. /proc/[pid]/stat,
+// or stat, schedstat, status and sched of each /proc/[pid]/task/[tid].
+// Descriptors stay open across Refresh calls while both the reader's own
+// budget (`fdBudget`, or half the shared limit when 0) and the shared one
+// allow; the rest are opened, read and closed each time.
+// Entries are kept sorted by id, which procfs already lists in ascending
+// order, so a refresh is a merge rather than a lookup per entry.
+class PidFileReader {
+public:
+    static constexpr size_t kMaxFiles = 4;
+    
+    PidFileReader(const char* root, const char* file, size_t fdBudget = 0);
+    PidFileReader(const char* root, std::initializer_list<const char*> files, size_t fdBudget = 0);
+    ~PidFileReader();
+    
+    PidFileReader(const PidFileReader&) = delete;
+    PidFileReader& operator=(const PidFileReader&) = delete;
+    
+    // Relists the directory and drops descriptors of entries that are gone.
+    bool Refresh();
+    
+    size_t GetCount() const { return m_entries.size(); }
+    uint32_t GetId(size_t index) const { return m_entries[index].id; }
+    size_t GetOpenDescriptors() const { return m_openFds; }
+    
+    // Contents of file `file` (its position in the constructor's list) for
+    // entry `index`, NUL-terminated and valid until the next Read. Empty
+    // when the entry has gone away since Refresh.
+    std::string_view Read(size_t index, size_t file = 0);
+    
+private:
+    struct Entry {
+        uint32_t id;
+        std::array<int, kMaxFiles> fds;
+    };
+    
+    int OpenEntry(uint32_t id, size_t file);
+    void CloseEntry(Entry& entry);
+    
+    DirectoryReader m_dir;
+    std::vector<std::string> m_files;
+    std::vector<uint32_t> m_ids;
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_merged;
+    std::vector<char> m_buffer;
+    size_t m_fdBudget = 0;
+    size_t m_openFds = 0;
+};
+
+}
@@ -0,0 +1,19 @@
+#include "../thread_usage.h"
+#include "linux_proc_reader.h"
+#include <time.h>
+
+namespace Monitor {
+
+int64_t ThreadCpuTimeNs() {
+    timespec now{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) return 0;
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// Collectors reach procfs and sysfs through the reader layer, which counts
+// every syscall it makes; the few made elsewhere are not seen.
+uint64_t ThreadSyscalls() {
+    return ProcReaderSyscalls();
+}
+
+}
@@ -0,0 +1,649 @@
+#include "windows_backend.h"
+#include <PdhMsg.h>
+#include <Psapi.h>
+#include <TlHelp32.h>
+
+#undef min
+#undef max
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+#pragma comment(lib, "pdh.lib")
+#pragma comment(lib, "Psapi.lib")
+#pragma comment(lib, "Iphlpapi.lib")
+
+namespace Monitor {
+
+namespace {
+
+float ReadCounter(PDH_HCOUNTER counter) {
+    PDH_FMT_COUNTERVALUE counterVal;
+    if (counter && PdhGetFormattedCounterValue(counter, PDH_FMT_DOUBLE, nullptr, &counterVal) == ERROR_SUCCESS) {
+        return static_cast<float>(counterVal.doubleValue);
+    }
+    return 0.0f;
+}
+
+template <typename Fn>
+void ReadCounterArray(PDH_HCOUNTER counter, Fn&& fn) {
+    DWORD bufferSize = 0;
+    DWORD itemCount = 0;
+    if (PdhGetFormattedCounterArrayW(counter, PDH_FMT_DOUBLE, &bufferSize, &itemCount, nullptr) != PDH_MORE_DATA) return;
+    
+    std::vector<BYTE> buffer(bufferSize);
+    auto* items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(buffer.data());
+    if (PdhGetFormattedCounterArrayW(counter, PDH_FMT_DOUBLE, &bufferSize, &itemCount, items) != ERROR_SUCCESS) return;
+    
+    for (DWORD i = 0; i < itemCount; i++) {
+        if (items[i].FmtValue.CStatus == ERROR_SUCCESS) {
+            fn(items[i].szName, items[i].FmtValue.doubleValue);
+        }
+    }
+}
+
+uint64_t ToUInt64(const FILETIME& time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+// Fills `buffer` with a PSAPI_WORKING_SET_INFORMATION, growing it as needed.
+bool ListWorkingSet(HANDLE process, std::vector<ULONG_PTR>& buffer) {
+    buffer.resize(4096);
+    while (true) {
+        if (QueryWorkingSet(process, buffer.data(), static_cast<DWORD>(buffer.size() * sizeof(ULONG_PTR)))) return true;
+        if (GetLastError() != ERROR_BAD_LENGTH) return false;
+        
+        // The first element holds the entry count; leave room for growth.
+        buffer.resize(buffer[0] + buffer[0] / 4 + 1);
+    }
+}
+
+}
+
+std::unique_ptr<CollectorBackend> CreateDefaultBackend() {
+    return std::make_unique<WindowsCollectorBackend>();
+}
+
+WindowsCollectorBackend::WindowsCollectorBackend() {
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    int coreCount = sysInfo.dwNumberOfProcessors;
+    
+    if (PdhOpenQuery(nullptr, 0, &m_cpuQuery) != ERROR_SUCCESS) {
+        spdlog::error("Failed to open PDH query");
+        m_cpuQuery = nullptr;
+        return;
+    }
+    
+    m_cpuCounters.resize(coreCount);
+    m_idleCounters.resize(coreCount);
+    m_frequencyCounters.resize(coreCount);
+    m_performanceCounters.resize(coreCount);
+    
+    for (int i = 0; i < coreCount; i++) {
+        wchar_t counterPath[256];
+        swprintf_s(counterPath, L"\\Processor(%d)\\%% Processor Time", i);
+        PdhAddCounterW(m_cpuQuery, counterPath, 0, &m_cpuCounters[i]);
+        
+        for (int state = 0; state < kIdleStateCount; state++) {
+            swprintf_s(counterPath, L"\\Processor(%d)\\%% C%d Time", i, state + 1);
+            PdhAddCounterW(m_cpuQuery, counterPath, 0, &m_idleCounters[i][state]);
+        }
+        
+        // Processor Information instances are "group,index"; effective
+        // frequency is the nominal frequency scaled by % performance.
+        swprintf_s(counterPath, L"\\Processor Information(%d,%d)\\Processor Frequency", i / 64, i % 64);
+        PdhAddCounterW(m_cpuQuery, counterPath, 0, &m_frequencyCounters[i]);
+        swprintf_s(counterPath, L"\\Processor Information(%d,%d)\\%% Processor Performance", i / 64, i % 64);
+        PdhAddCounterW(m_cpuQuery, counterPath, 0, &m_performanceCounters[i]);
+    }
+    
+    PdhCollectQueryData(m_cpuQuery);
+    
+    // Paging rates are per-second counters that need two collections; the
+    // first RAM tick reads 0 for them.
+    if (PdhOpenQuery(nullptr, 0, &m_memoryQuery) == ERROR_SUCCESS) {
+        PdhAddCounterW(m_memoryQuery, L"\\Memory\\Pages Input/sec", 0, &m_pagesInput);
+        PdhAddCounterW(m_memoryQuery, L"\\Memory\\Pages Output/sec", 0, &m_pagesOutput);
+        PdhAddCounterW(m_memoryQuery, L"\\Memory\\Modified Page List Bytes", 0, &m_modifiedBytes);
+        PdhAddCounterW(m_memoryQuery, L"\\Paging File(_Total)\\% Usage", 0, &m_pagingFileUsage);
+        PdhCollectQueryData(m_memoryQuery);
+    } else {
+        m_memoryQuery = nullptr;
+    }
+    
+    // ACPI thermal zones are the only temperature source readable without
+    // elevation. Temperature is in Kelvin; a passive limit below 100% means
+    // the firmware is capping the CPU to cool it.
+    if (PdhOpenQuery(nullptr, 0, &m_thermalQuery) == ERROR_SUCCESS) {
+        PdhAddCounterW(m_thermalQuery, L"\\Thermal Zone Information(*)\\Temperature", 0, &m_zoneTemperature);
+        PdhAddCounterW(m_thermalQuery, L"\\Thermal Zone Information(*)\\% Passive Limit", 0, &m_zonePassiveLimit);
+    } else {
+        m_thermalQuery = nullptr;
+    }
+}
+
+WindowsCollectorBackend::~WindowsCollectorBackend() {
+    if (m_cpuQuery) {
+        PdhCloseQuery(m_cpuQuery);
+    }
+    if (m_memoryQuery) {
+        PdhCloseQuery(m_memoryQuery);
+    }
+    if (m_thermalQuery) {
+        PdhCloseQuery(m_thermalQuery);
+    }
+}
+
+// Logical CPU ids are group * 64 + index, matching the "Processor
+// Information(group,index)" PDH instances sampled by CollectCPU.
+bool WindowsCollectorBackend::DiscoverTopology(TopologySource& source) {
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+        spdlog::error("GetLogicalProcessorInformationEx failed: {}", GetLastError());
+        return false;
+    }
+    
+    std::vector<uint8_t> buffer(length);
+    if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()), &length)) {
+        spdlog::error("GetLogicalProcessorInformationEx failed: {}", GetLastError());
+        return false;
+    }
+    
+    std::map<int, LogicalCpu> cpus;
+    auto forEachCpu = [&](const GROUP_AFFINITY& affinity, auto&& fn) {
+        for (int bit = 0; bit < 64; bit++) {
+            if (!(affinity.Mask & (static_cast<KAFFINITY>(1) << bit))) continue;
+            int id = affinity.Group * 64 + bit;
+            cpus[id].id = id;
+            fn(cpus[id]);
+        }
+    };
+    
+    int coreCount = 0, packageCount = 0;
+    for (DWORD offset = 0; offset < length; ) {
+        const auto* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+        offset += info->Size;
+        
+        switch (info->Relationship) {
+            case RelationProcessorCore:
+                // EfficiencyClass is 0 on uniform parts and higher for
+                // faster cores on hybrid ones.
+                for (WORD group = 0; group < info->Processor.GroupCount; group++) {
+                    forEachCpu(info->Processor.GroupMask[group], [&](LogicalCpu& cpu) {
+                        cpu.core = coreCount;
+                        cpu.performanceRank = info->Processor.EfficiencyClass;
+                    });
+                }
+                coreCount++;
+                break;
+            case RelationProcessorPackage:
+                for (WORD group = 0; group < info->Processor.GroupCount; group++) {
+                    forEachCpu(info->Processor.GroupMask[group], [&](LogicalCpu& cpu) { cpu.package = packageCount; });
+                }
+                packageCount++;
+                break;
+            case RelationNumaNode:
+                forEachCpu(info->NumaNode.GroupMask, [&](LogicalCpu& cpu) { cpu.numaNode = static_cast<int>(info->NumaNode.NodeNumber); });
+                break;
+            case RelationCache:
+                if (info->Cache.Level >= 2 && info->Cache.Type != CacheInstruction) {
+                    CacheDomain cache;
+                    cache.level = info->Cache.Level;
+                    cache.sizeKB = info->Cache.CacheSize / 1024;
+                    forEachCpu(info->Cache.GroupMask, [&](LogicalCpu& cpu) { cache.cpus.push_back(cpu.id); });
+                    source.caches.push_back(std::move(cache));
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    
+    for (auto& [id, cpu] : cpus) source.cpus.push_back(cpu);
+    return !source.cpus.empty();
+}
+
+bool WindowsCollectorBackend::CollectCPU(std::vector<CPUCoreInfo>& cores) {
+    if (!m_cpuQuery) return false;
+    
+    PdhCollectQueryData(m_cpuQuery);
+    
+    int coreCount = static_cast<int>(m_cpuCounters.size());
+    cores.clear();
+    cores.reserve(coreCount);
+    
+    for (int i = 0; i < coreCount; i++) {
+        CPUCoreInfo info;
+        info.coreID = i;
+        info.frequency = 0.0f;
+        info.temperature = 0.0f;
+        info.cState = 0.0f;
+        info.usage = ReadCounter(m_cpuCounters[i]);
+        
+        info.idleResidency.resize(kIdleStateCount);
+        for (int state = 0; state < kIdleStateCount; state++) {
+            info.idleResidency[state] = ReadCounter(m_idleCounters[i][state]);
+        }
+        info.cState = std::min(100.0f, info.idleResidency[1] + info.idleResidency[2]);
+        
+        info.frequency = ReadCounter(m_frequencyCounters[i]) * ReadCounter(m_performanceCounters[i]) / 100.0f;
+        
+        cores.push_back(info);
+    }
+    
+    return true;
+}
+
+bool WindowsCollectorBackend::CollectGPU(GPUInfo& gpu) {
+    gpu.name = "Unknown GPU";
+    gpu.coreClock = 0.0f;
+    gpu.memoryClock = 0.0f;
+    gpu.temperature = 0.0f;
+    gpu.usage = 0.0f;
+    gpu.memoryUsage = 0.0f;
+    gpu.memoryTotal = 0.0f;
+    gpu.powerUsage = 0.0f;
+    gpu.fanSpeed = 0;
+    return true;
+}
+
+bool WindowsCollectorBackend::CollectRAM(RAMInfo& ram) {
+    MEMORYSTATUSEX memInfo;
+    memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+    if (!GlobalMemoryStatusEx(&memInfo)) {
+        return false;
+    }
+    
+    ram.totalGB = static_cast<float>(memInfo.ullTotalPhys) / (1024.0f * 1024.0f * 1024.0f);
+    ram.availableGB = static_cast<float>(memInfo.ullAvailPhys) / (1024.0f * 1024.0f * 1024.0f);
+    ram.usedGB = ram.totalGB - ram.availableGB;
+    ram.usagePercent = static_cast<float>(memInfo.dwMemoryLoad);
+    ram.speedMHz = 0;
+    ram.latencyNs = 0.0f;
+    
+    // Windows has no buffers, slab split or huge-page pool to report; the
+    // kernel pools stand in for slab and the page file for swap.
+    PERFORMANCE_INFORMATION perf{};
+    perf.cb = sizeof(perf);
+    if (GetPerformanceInfo(&perf, sizeof(perf))) {
+        const float pageGB = static_cast<float>(perf.PageSize) / (1024.0f * 1024.0f * 1024.0f);
+        ram.cachedGB = perf.SystemCache * pageGB;
+        ram.slabGB = (perf.KernelPaged + perf.KernelNonpaged) * pageGB;
+        ram.committedGB = perf.CommitTotal * pageGB;
+        ram.commitLimitGB = perf.CommitLimit * pageGB;
+        ram.swapTotalGB = perf.CommitLimit > perf.PhysicalTotal ? (perf.CommitLimit - perf.PhysicalTotal) * pageGB : 0.0f;
+    }
+    
+    if (m_memoryQuery && PdhCollectQueryData(m_memoryQuery) == ERROR_SUCCESS) {
+        const float pageMB = static_cast<float>(perf.PageSize ? perf.PageSize : 4096) / (1024.0f * 1024.0f);
+        ram.swapInMBps = ReadCounter(m_pagesInput) * pageMB;
+        ram.swapOutMBps = ReadCounter(m_pagesOutput) * pageMB;
+        ram.dirtyMB = ReadCounter(m_modifiedBytes) / (1024.0f * 1024.0f);
+        ram.swapUsedGB = ram.swapTotalGB * ReadCounter(m_pagingFileUsage) / 100.0f;
+    }
+    return true;
+}
+
+bool WindowsCollectorBackend::CollectDisks(std::vector<DiskInfo>& disks) {
+    disks.clear();
+    
+    DWORD drives = GetLogicalDrives();
+    for (int i = 0; i < 26; i++) {
+        if (drives & (1 << i)) {
+            char driveLetter = 'A' + i;
+            std::string drivePath = std::string(1, driveLetter) + ":\\";
+            
+            UINT driveType = GetDriveTypeA(drivePath.c_str());
+            if (driveType == DRIVE_FIXED || driveType == DRIVE_REMOVABLE) {
+                DiskInfo info;
+                info.name = drivePath;
+                info.readMBps = 0.0f;
+                info.writeMBps = 0.0f;
+                info.readIOPS = 0;
+                info.writeIOPS = 0;
+                info.latencyMs = 0.0f;
+                info.temperature = 0.0f;
+                info.usagePercent = 0.0f;
+                info.queueDepth = 0.0f;
+                info.busyPercent = 0.0f;
+                info.mountPoints = {drivePath};
+                
+                ULARGE_INTEGER freeBytesAvailable, totalNumberOfBytes, totalNumberOfFreeBytes;
+                if (GetDiskFreeSpaceExA(drivePath.c_str(), &freeBytesAvailable, &totalNumberOfBytes, &totalNumberOfFreeBytes)) {
+                    float usedBytes = static_cast<float>(totalNumberOfBytes.QuadPart - totalNumberOfFreeBytes.QuadPart);
+                    info.usagePercent = (usedBytes / totalNumberOfBytes.QuadPart) * 100.0f;
+                }
+                
+                CollectDiskPerformance(driveLetter, info);
+                disks.push_back(info);
+            }
+        }
+    }
+    
+    return true;
+}
+
+// Per-volume I/O counters from the disk performance IOCTL. Times and
+// QueryTime are in 100 ns units; QueueDepth is instantaneous.
+void WindowsCollectorBackend::CollectDiskPerformance(char driveLetter, DiskInfo& info) {
+    char volumePath[] = "\\\\.\\?:";
+    volumePath[4] = driveLetter;
+    
+    HANDLE hVolume = CreateFileA(volumePath, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (hVolume == INVALID_HANDLE_VALUE) return;
+    
+    DISK_PERFORMANCE perf = {};
+    DWORD bytesReturned = 0;
+    BOOL ok = DeviceIoControl(hVolume, IOCTL_DISK_PERFORMANCE, nullptr, 0, &perf, sizeof(perf), &bytesReturned, nullptr);
+    CloseHandle(hVolume);
+    if (!ok) return;
+    
+    info.queueDepth = static_cast<float>(perf.QueueDepth);
+    
+    auto prevIt = m_prevDiskPerformance.find(driveLetter);
+    m_prevDiskPerformance[driveLetter] = perf;
+    if (prevIt == m_prevDiskPerformance.end()) return;
+    
+    const DISK_PERFORMANCE& prev = prevIt->second;
+    double elapsed = (perf.QueryTime.QuadPart - prev.QueryTime.QuadPart) / 1e7;
+    if (elapsed <= 0.0) return;
+    
+    DWORD reads = perf.ReadCount - prev.ReadCount;
+    DWORD writes = perf.WriteCount - prev.WriteCount;
+    double ioTimeMs = ((perf.ReadTime.QuadPart - prev.ReadTime.QuadPart) + (perf.WriteTime.QuadPart - prev.WriteTime.QuadPart)) / 1e4;
+    double idle = (perf.IdleTime.QuadPart - prev.IdleTime.QuadPart) / 1e7;
+    
+    info.readMBps = static_cast<float>((perf.BytesRead.QuadPart - prev.BytesRead.QuadPart) / (1024.0 * 1024.0) / elapsed);
+    info.writeMBps = static_cast<float>((perf.BytesWritten.QuadPart - prev.BytesWritten.QuadPart) / (1024.0 * 1024.0) / elapsed);
+    info.readIOPS = static_cast<int>(reads / elapsed);
+    info.writeIOPS = static_cast<int>(writes / elapsed);
+    info.latencyMs = reads + writes > 0 ? static_cast<float>(ioTimeMs / (reads + writes)) : 0.0f;
+    info.busyPercent = static_cast<float>(std::clamp(100.0 * (1.0 - idle / elapsed), 0.0, 100.0));
+}
+
+bool WindowsCollectorBackend::CollectNetwork(NetworkInfo& network) {
+    PMIB_IF_TABLE2 table = nullptr;
+    if (GetIfTable2(&table) != NO_ERROR) {
+        spdlog::error("Failed to read network interface table");
+        return false;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_prevNetSample).count();
+    m_prevNetSample = now;
+    
+    network.interfaces.clear();
+    std::map<ULONG64, MIB_IF_ROW2> rows;
+    
+    for (ULONG i = 0; i < table->NumEntries; i++) {
+        const MIB_IF_ROW2& row = table->Table[i];
+        if (!row.InterfaceAndOperStatusFlags.HardwareInterface || row.OperStatus != IfOperStatusUp) continue;
+        if (row.Type == IF_TYPE_SOFTWARE_LOOPBACK) continue;
+        
+        rows[row.InterfaceLuid.Value] = row;
+        auto prevIt = m_prevNetRows.find(row.InterfaceLuid.Value);
+        bool hasPrev = prevIt != m_prevNetRows.end() && elapsed > 0.0;
+        const MIB_IF_ROW2& prev = hasPrev ? prevIt->second : row;
+        
+        // MIB_IF_ROW2 counters are 64-bit; unsigned subtraction absorbs a wrap.
+        auto rate = [&](ULONG64 current, ULONG64 previous) {
+            return static_cast<float>((current - previous) / (hasPrev ? elapsed : 1.0));
+        };
+        
+        NetworkInterfaceInfo info;
+        char alias[IF_MAX_STRING_SIZE + 1];
+        WideCharToMultiByte(CP_UTF8, 0, row.Alias, -1, alias, sizeof(alias), nullptr, nullptr);
+        info.name = alias;
+        info.downloadMbps = rate(row.InOctets, prev.InOctets) * 8.0f / 1e6f;
+        info.uploadMbps = rate(row.OutOctets, prev.OutOctets) * 8.0f / 1e6f;
+        info.rxPacketsPerSec = rate(row.InUcastPkts + row.InNUcastPkts, prev.InUcastPkts + prev.InNUcastPkts);
+        info.txPacketsPerSec = rate(row.OutUcastPkts + row.OutNUcastPkts, prev.OutUcastPkts + prev.OutNUcastPkts);
+        info.rxDropsPerSec = rate(row.InDiscards, prev.InDiscards);
+        info.txDropsPerSec = rate(row.OutDiscards, prev.OutDiscards);
+        info.rxErrorsPerSec = rate(row.InErrors, prev.InErrors);
+        info.txErrorsPerSec = rate(row.OutErrors, prev.OutErrors);
+        network.interfaces.push_back(info);
+    }
+    
+    FreeMibTable(table);
+    m_prevNetRows = std::move(rows);
+    return true;
+}
+
+bool WindowsCollectorBackend::CollectThermal(ThermalInfo& thermal) {
+    if (!m_thermalQuery || PdhCollectQueryData(m_thermalQuery) != ERROR_SUCCESS) return false;
+    
+    thermal.sensors.clear();
+    thermal.packageTemperature = 0.0f;
+    thermal.newThrottleEvents = 0;
+    thermal.frequencyCapped = false;
+    
+    ReadCounterArray(m_zoneTemperature, [&](const wchar_t* instance, double kelvin) {
+        char label[128];
+        WideCharToMultiByte(CP_UTF8, 0, instance, -1, label, sizeof(label), nullptr, nullptr);
+        
+        ThermalSensor sensor;
+        sensor.kind = ThermalSensorKind::Other;
+        sensor.label = label;
+        sensor.temperature = static_cast<float>(kelvin - 273.15);
+        thermal.sensors.push_back(sensor);
+        
+        // Zones are not tied to a device; the hottest stands in for the package.
+        thermal.packageTemperature = std::max(thermal.packageTemperature, sensor.temperature);
+    });
+    
+    ReadCounterArray(m_zonePassiveLimit, [&](const wchar_t*, double percent) {
+        if (percent < 100.0) thermal.frequencyCapped = true;
+    });
+    
+    // Zone throttling is a state, not a counter; count entries into it.
+    if (thermal.frequencyCapped && !m_wasFrequencyCapped) {
+        m_throttleEvents++;
+        thermal.newThrottleEvents = 1;
+    }
+    m_wasFrequencyCapped = thermal.frequencyCapped;
+    
+    thermal.throttleEvents = m_throttleEvents;
+    thermal.throttling = thermal.frequencyCapped;
+    return !thermal.sensors.empty();
+}
+
+bool WindowsCollectorBackend::CollectPressure(std::vector<PressureInfo>&) {
+    // Windows has no pressure-stall accounting; the engine keeps the
+    // pressure list empty.
+    return false;
+}
+
+bool WindowsCollectorBackend::CollectCgroups(std::vector<CgroupInfo>&) {
+    // Job objects are the closest Windows concept, but they are not a
+    // browsable hierarchy; the engine keeps the cgroup list empty.
+    return false;
+}
+
+bool WindowsCollectorBackend::CollectProcesses(std::vector<ProcessSample>& samples) {
+    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (hSnapshot == INVALID_HANDLE_VALUE) {
+        spdlog::error("Failed to snapshot process list: {}", GetLastError());
+        return false;
+    }
+    
+    PROCESSENTRY32 pe32;
+    pe32.dwSize = sizeof(PROCESSENTRY32);
+    
+    size_t count = 0;
+    if (Process32First(hSnapshot, &pe32)) {
+        do {
+            HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pe32.th32ProcessID);
+            if (!hProcess) continue;  // protected or already exited
+            
+            FILETIME creation, exit, kernel, user;
+            PROCESS_MEMORY_COUNTERS memory = {};
+            DWORD handles = 0;
+            bool hasTimes = GetProcessTimes(hProcess, &creation, &exit, &kernel, &user);
+            GetProcessMemoryInfo(hProcess, &memory, sizeof(memory));
+            GetProcessHandleCount(hProcess, &handles);
+            CloseHandle(hProcess);
+            
+            if (!hasTimes) continue;
+            
+            if (count == samples.size()) samples.emplace_back();
+            ProcessSample& sample = samples[count++];
+            sample.pid = pe32.th32ProcessID;
+            sample.startTime = ToUInt64(creation);
+            sample.name.assign(pe32.szExeFile, pe32.szExeFile + strlen(pe32.szExeFile));
+            sample.cpuTimeNs = (ToUInt64(kernel) + ToUInt64(user)) * 100;  // FILETIME ticks are 100 ns
+            sample.residentBytes = memory.WorkingSetSize;
+            sample.threads = static_cast<int>(pe32.cntThreads);
+            sample.handles = static_cast<int>(handles);
+        } while (Process32Next(hSnapshot, &pe32));
+    }
+    
+    CloseHandle(hSnapshot);
+    samples.resize(count);
+    return true;
+}
+
+// Windows exposes no run-queue wait or per-thread switch counts outside of
+// ETW, so threads report on-CPU time only.
+bool WindowsCollectorBackend::CollectThreads(unsigned long pid, std::vector<ThreadSample>& samples) {
+    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (hSnapshot == INVALID_HANDLE_VALUE) {
+        spdlog::error("Failed to snapshot thread list: {}", GetLastError());
+        return false;
+    }
+    
+    THREADENTRY32 te32;
+    te32.dwSize = sizeof(THREADENTRY32);
+    
+    size_t count = 0;
+    if (Thread32First(hSnapshot, &te32)) {
+        do {
+            if (te32.th32OwnerProcessID != pid) continue;
+            
+            HANDLE hThread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, te32.th32ThreadID);
+            if (!hThread) continue;
+            
+            FILETIME creation, exit, kernel, user;
+            bool hasTimes = GetThreadTimes(hThread, &creation, &exit, &kernel, &user);
+            CloseHandle(hThread);
+            if (!hasTimes) continue;
+            
+            if (count == samples.size()) samples.emplace_back();
+            ThreadSample& sample = samples[count++];
+            sample = ThreadSample{};
+            sample.tid = te32.th32ThreadID;
+            sample.name = "Thread " + std::to_string(te32.th32ThreadID);
+            sample.runTimeNs = (ToUInt64(kernel) + ToUInt64(user)) * 100;
+        } while (Thread32Next(hSnapshot, &te32));
+    }
+    
+    CloseHandle(hSnapshot);
+    samples.resize(count);
+    return true;
+}
+
+// QueryWorkingSet lists every resident page with its share count, which
+// saturates at 7; pages shared more widely are split seven ways.
+bool WindowsCollectorBackend::QueryProcessMemory(unsigned long pid, ProcessMemoryInfo& info) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+    if (!process) return false;
+    
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    const uint64_t pageSize = system.dwPageSize;
+    
+    std::vector<ULONG_PTR> buffer;
+    bool listed = ListWorkingSet(process, buffer);
+    CloseHandle(process);
+    
+    if (!listed) {
+        spdlog::error("Failed to query the working set of process {}: {}", pid, GetLastError());
+        return false;
+    }
+    
+    info = ProcessMemoryInfo{};
+    info.pid = pid;
+    info.sampledAt = std::chrono::steady_clock::now();
+    
+    auto* sets = reinterpret_cast<PSAPI_WORKING_SET_INFORMATION*>(buffer.data());
+    double proportional = 0.0;
+    for (ULONG_PTR i = 0; i < sets->NumberOfEntries; i++) {
+        const PSAPI_WORKING_SET_BLOCK& page = sets->WorkingSetInfo[i];
+        info.residentBytes += pageSize;
+        if (page.Shared && page.ShareCount > 1) {
+            info.sharedBytes += pageSize;
+            proportional += static_cast<double>(pageSize) / page.ShareCount;
+        } else {
+            info.uniqueBytes += pageSize;
+            proportional += static_cast<double>(pageSize);
+        }
+    }
+    info.proportionalBytes = static_cast<uint64_t>(proportional);
+    
+    // Private commit that is not resident may be paged out or may never
+    // have been touched; Windows does not tell them apart, so swapBytes
+    // stays 0 here.
+    return true;
+}
+
+// Windows reports free memory per node but neither node sizes nor
+// allocation counters, so only freeGB is filled.
+bool WindowsCollectorBackend::CollectNuma(std::vector<NumaNodeInfo>& nodes) {
+    ULONG highest = 0;
+    if (!GetNumaHighestNodeNumber(&highest)) return false;
+    
+    nodes.clear();
+    for (USHORT node = 0; node <= highest; node++) {
+        ULONGLONG available = 0;
+        if (!GetNumaAvailableMemoryNodeEx(node, &available)) continue;
+        
+        NumaNodeInfo& info = nodes.emplace_back();
+        info.node = node;
+        info.freeGB = static_cast<float>(available / (1024.0 * 1024.0 * 1024.0));
+    }
+    return !nodes.empty();
+}
+
+// QueryWorkingSetEx reports the node of every resident page; the CPU the
+// process last ran on is not exposed, so homeNode stays unknown.
+bool WindowsCollectorBackend::QueryProcessNuma(unsigned long pid, ProcessNumaInfo& info) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+    if (!process) return false;
+    
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    const uint64_t pageSize = system.dwPageSize;
+    
+    std::vector<ULONG_PTR> buffer;
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> pages;
+    bool queried = ListWorkingSet(process, buffer);
+    if (queried) {
+        auto* sets = reinterpret_cast<PSAPI_WORKING_SET_INFORMATION*>(buffer.data());
+        pages.resize(sets->NumberOfEntries);
+        for (ULONG_PTR i = 0; i < sets->NumberOfEntries; i++) {
+            pages[i].VirtualAddress = reinterpret_cast<PVOID>(sets->WorkingSetInfo[i].VirtualPage * pageSize);
+        }
+        queried = pages.empty() || QueryWorkingSetEx(process, pages.data(), static_cast<DWORD>(pages.size() * sizeof(pages[0])));
+    }
+    CloseHandle(process);
+    
+    if (!queried) {
+        spdlog::error("Failed to query the working set of process {}: {}", pid, GetLastError());
+        return false;
+    }
+    
+    info = ProcessNumaInfo{};
+    info.pid = pid;
+    info.sampledAt = std::chrono::steady_clock::now();
+    for (const auto& page : pages) {
+        if (!page.VirtualAttributes.Valid) continue;
+        size_t node = page.VirtualAttributes.Node;
+        if (node >= info.nodeBytes.size()) info.nodeBytes.resize(node + 1);
+        info.nodeBytes[node] += pageSize;
+    }
+    return true;
+}
+
+}
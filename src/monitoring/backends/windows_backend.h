@@ -0,0 +1,67 @@
+#pragma once
+#include "../collector_backend.h"
+#include <WinSock2.h>
+#include <Windows.h>
+#include <Pdh.h>
+#include <iphlpapi.h>
+#include <winioctl.h>
+#include <array>
+#include <chrono>
+#include <map>
+
+namespace Monitor {
+
+class WindowsCollectorBackend : public CollectorBackend {
+public:
+    WindowsCollectorBackend();
+    ~WindowsCollectorBackend() override;
+    
+    const char* GetName() const override { return "Windows PDH"; }
+    std::vector<std::string> GetCpuIdleStates() const override { return {"C1", "C2", "C3"}; }
+    
+    bool DiscoverTopology(TopologySource& source) override;
+    bool CollectCPU(std::vector<CPUCoreInfo>& cores) override;
+    bool CollectGPU(GPUInfo& gpu) override;
+    bool CollectRAM(RAMInfo& ram) override;
+    bool CollectDisks(std::vector<DiskInfo>& disks) override;
+    bool CollectNetwork(NetworkInfo& network) override;
+    bool CollectProcesses(std::vector<ProcessSample>& samples) override;
+    bool CollectThermal(ThermalInfo& thermal) override;
+    bool CollectPressure(std::vector<PressureInfo>& pressure) override;
+    bool CollectNuma(std::vector<NumaNodeInfo>& nodes) override;
+    bool CollectCgroups(std::vector<CgroupInfo>& groups) override;
+    bool QueryProcessNuma(unsigned long pid, ProcessNumaInfo& info) override;
+    bool CollectThreads(unsigned long pid, std::vector<ThreadSample>& samples) override;
+    bool QueryProcessMemory(unsigned long pid, ProcessMemoryInfo& info) override;
+    
+private:
+    // PDH reports ACPI C1-C3 only; C2 and C3 count as deep idle.
+    static constexpr int kIdleStateCount = 3;
+    
+    void CollectDiskPerformance(char driveLetter, DiskInfo& info);
+    
+    PDH_HQUERY m_cpuQuery = nullptr;
+    std::vector<PDH_HCOUNTER> m_cpuCounters;
+    std::vector<std::array<PDH_HCOUNTER, kIdleStateCount>> m_idleCounters;
+    std::vector<PDH_HCOUNTER> m_frequencyCounters;
+    std::vector<PDH_HCOUNTER> m_performanceCounters;
+    
+    PDH_HQUERY m_memoryQuery = nullptr;
+    PDH_HCOUNTER m_pagesInput = nullptr;
+    PDH_HCOUNTER m_pagesOutput = nullptr;
+    PDH_HCOUNTER m_modifiedBytes = nullptr;
+    PDH_HCOUNTER m_pagingFileUsage = nullptr;
+    
+    PDH_HQUERY m_thermalQuery = nullptr;
+    PDH_HCOUNTER m_zoneTemperature = nullptr;
+    PDH_HCOUNTER m_zonePassiveLimit = nullptr;
+    uint64_t m_throttleEvents = 0;
+    bool m_wasFrequencyCapped = false;
+    
+    std::map<char, DISK_PERFORMANCE> m_prevDiskPerformance;
+    
+    std::map<ULONG64, MIB_IF_ROW2> m_prevNetRows;
+    std::chrono::steady_clock::time_point m_prevNetSample;
+};
+
+}
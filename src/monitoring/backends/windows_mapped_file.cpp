@@ -0,0 +1,104 @@
+#include "../mapped_file.h"
+#include <Windows.h>
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+namespace {
+
+HANDLE AsHandle(intptr_t value) {
+    return reinterpret_cast<HANDLE>(value);
+}
+
+}
+
+// SetEndOfFile allocates the new range, so unlike a sparse Linux file a
+// full disk is reported here.
+bool MappedFile::Create(const std::string& path, size_t size) {
+    Close();
+    
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::error("Cannot create {}: error {}", path, GetLastError());
+        return false;
+    }
+    
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+        spdlog::error("Cannot reserve {} bytes for {}: error {}", size, path, GetLastError());
+        CloseHandle(file);
+        DeleteFileA(path.c_str());
+        return false;
+    }
+    
+    m_file = reinterpret_cast<intptr_t>(file);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size) : nullptr;
+    if (!data) {
+        spdlog::error("Cannot map {}: error {}", path, GetLastError());
+        if (mapping) CloseHandle(mapping);
+        Close();
+        return false;
+    }
+    
+    m_data = static_cast<uint8_t*>(data);
+    m_size = size;
+    m_mapping = reinterpret_cast<intptr_t>(mapping);
+    return true;
+}
+
+bool MappedFile::Open(const std::string& path, bool writable) {
+    Close();
+    
+    // Readers share the file with the recorder still writing it.
+    DWORD access = writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    HANDLE file = CreateFileA(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::error("Cannot open {}: error {}", path, GetLastError());
+        return false;
+    }
+    m_file = reinterpret_cast<intptr_t>(file);
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        spdlog::error("Cannot map {}: empty or unreadable", path);
+        Close();
+        return false;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    void* data = mapping ? MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+        spdlog::error("Cannot map {}: error {}", path, GetLastError());
+        if (mapping) CloseHandle(mapping);
+        Close();
+        return false;
+    }
+    
+    m_data = static_cast<uint8_t*>(data);
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_mapping = reinterpret_cast<intptr_t>(mapping);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(AsHandle(m_mapping));
+    if (m_file != -1) CloseHandle(AsHandle(m_file));
+    
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+    m_mapping = 0;
+}
+
+void MappedFile::Flush(size_t offset, size_t length) {
+    if (!m_data || offset >= m_size) return;
+    FlushViewOfFile(m_data + offset, std::min(length, m_size - offset));
+}
+
+}
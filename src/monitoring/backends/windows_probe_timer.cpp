@@ -0,0 +1,76 @@
+#include "../latency_probe.h"
+#include <Windows.h>
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+namespace {
+
+// Waits on a standard waitable timer, which honours the global timer
+// resolution, so TimerOptimizer changes show up directly in the results.
+// Windows has a single high-resolution clock; ProbeClock is ignored.
+class WindowsProbeTimer : public ProbeTimer {
+public:
+    WindowsProbeTimer() {
+        QueryPerformanceFrequency(&m_frequency);
+    }
+    
+    ~WindowsProbeTimer() override {
+        if (m_timer) CloseHandle(m_timer);
+    }
+    
+    bool Prepare(int cpu, const LatencyProbeConfig& config) override {
+        GROUP_AFFINITY affinity = {};
+        affinity.Group = static_cast<WORD>(cpu / 64);
+        affinity.Mask = KAFFINITY(1) << (cpu % 64);
+        if (!SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr)) {
+            spdlog::error("Latency probe cannot pin to CPU {}: {}", cpu, GetLastError());
+            return false;
+        }
+        
+        // Real-time scheduling classes map to the highest thread priority.
+        if (config.schedClass != ProbeSchedClass::Normal && !SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            spdlog::warn("Latency probe on CPU {} keeps normal priority: {}", cpu, GetLastError());
+        }
+        
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        if (!m_timer) {
+            spdlog::error("Failed to create latency probe timer: {}", GetLastError());
+            return false;
+        }
+        return true;
+    }
+    
+    int64_t Now() override {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        int64_t seconds = counter.QuadPart / m_frequency.QuadPart;
+        int64_t remainder = counter.QuadPart % m_frequency.QuadPart;
+        return seconds * 1000000000ll + remainder * 1000000000ll / m_frequency.QuadPart;
+    }
+    
+    int64_t SleepUntil(int64_t deadlineNs) override {
+        int64_t remaining = deadlineNs - Now();
+        if (remaining > 0) {
+            // Negative due times are relative, in 100 ns units.
+            LARGE_INTEGER due;
+            due.QuadPart = -(remaining / 100);
+            if (SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(m_timer, INFINITE);
+            }
+        }
+        return Now();
+    }
+    
+private:
+    HANDLE m_timer = nullptr;
+    LARGE_INTEGER m_frequency;
+};
+
+}
+
+std::unique_ptr<ProbeTimer> CreateProbeTimer() {
+    return std::make_unique<WindowsProbeTimer>();
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "monitoring_types.h"
+#include "cpu_topology.h"
+#include "collector_scheduler.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Monitor {
+
+// Platform source for the raw samples behind MonitoringEngine. Each Collect*
+// call fills the output in place; returning false means the sample is
+// unavailable this tick and the engine keeps the previous value. Different
+// Collect* methods may run concurrently on different scheduler lanes, but a
+// single method is never re-entered, so per-collector state needs no locking.
+// CollectNetwork fills only the per-interface list; the engine derives the
+// aggregate fields from it.
+//
+// A backend that already holds complete snapshots, such as a recording, can
+// instead push them through StartFeed; the engine then runs no collectors
+// and publishes each fed snapshot as it is.
+class CollectorBackend {
+public:
+    using PressureCallback = std::function<void(const PressureEvent&)>;
+    using SnapshotFeed = std::function<void(const SystemSnapshot& snapshot, CollectorMask changed)>;
+    
+    virtual ~CollectorBackend() = default;
+    
+    virtual const char* GetName() const = 0;
+    
+    // Names of the idle states behind CPUCoreInfo::idleResidency, shallowest
+    // first. Empty when the platform does not expose residency.
+    virtual std::vector<std::string> GetCpuIdleStates() const { return {}; }
+    
+    // Reports the processor layout once; the engine derives the rest and
+    // caches it for the lifetime of the backend.
+    virtual bool DiscoverTopology(TopologySource& source) = 0;
+    
+    virtual bool CollectCPU(std::vector<CPUCoreInfo>& cores) = 0;
+    virtual bool CollectGPU(GPUInfo& gpu) = 0;
+    virtual bool CollectRAM(RAMInfo& ram) = 0;
+    virtual bool CollectDisks(std::vector<DiskInfo>& disks) = 0;
+    virtual bool CollectNetwork(NetworkInfo& network) = 0;
+    virtual bool CollectProcesses(std::vector<ProcessSample>& samples) = 0;
+    virtual bool CollectThermal(ThermalInfo& thermal) = 0;
+    virtual bool CollectThreads(unsigned long pid, std::vector<ThreadSample>& samples) = 0;
+    
+    // Walks the page tables of one process; costs milliseconds for large
+    // processes, so it is never part of a collector tick.
+    virtual bool QueryProcessMemory(unsigned long pid, ProcessMemoryInfo& info) = 0;
+    
+    virtual bool CollectNuma(std::vector<NumaNodeInfo>& nodes) = 0;
+    
+    // Every group below the cgroup v2 root. Backends track the hierarchy
+    // between calls rather than rescanning it.
+    virtual bool CollectCgroups(std::vector<CgroupInfo>& groups) = 0;
+    
+    // Per-node residency of one process; walks its page tables like
+    // QueryProcessMemory and is never part of a tick either.
+    virtual bool QueryProcessNuma(unsigned long pid, ProcessNumaInfo& info) = 0;
+    
+    // Fills the whole-system entry first, then one per monitored cgroup.
+    virtual bool CollectPressure(std::vector<PressureInfo>& pressure) = 0;
+    
+    // Arms a stall trigger and returns its id, or -1 when the platform or
+    // the kernel refuses it. Callbacks run on a backend thread and must not
+    // block; triggers are disarmed when the backend is destroyed.
+    virtual int AddPressureTrigger(const PressureTrigger&, PressureCallback) { return -1; }
+    virtual void RemovePressureTrigger(int) {}
+    
+    // Starts calling `feed` from a backend thread, one call per snapshot,
+    // naming the collectors whose parts differ from the previous call.
+    // Returns false when the backend is polled instead. StopFeed returns
+    // once no call is in flight.
+    virtual bool StartFeed(SnapshotFeed) { return false; }
+    virtual void StopFeed() {}
+};
+
+// Copies the part of `from` that collector `id` fills into `to`.
+void CopyCollectorPart(CollectorId id, const SystemSnapshot& from, SystemSnapshot& to);
+
+std::unique_ptr<CollectorBackend> CreateDefaultBackend();
+
+}
@@ -0,0 +1,379 @@
+#include "collector_scheduler.h"
+#include "thread_usage.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+namespace {
+
+constexpr std::chrono::milliseconds kBudgetWindow{2000};
+
+// A window this far under budget gives one degradation step back.
+constexpr float kRestoreFraction = 0.7f;
+
+// Only collectors costing at least this share of the costliest one that
+// can still be degraded are stretched; cheaper ones would barely bring
+// usage down, however low their priority.
+constexpr float kMinDegradeShare = 0.25f;
+
+}
+
+const char* GetCollectorName(CollectorId id) {
+    switch (id) {
+        case CollectorId::CPU:     return "CPU";
+        case CollectorId::GPU:     return "GPU";
+        case CollectorId::RAM:     return "RAM";
+        case CollectorId::Disk:    return "Disk";
+        case CollectorId::Network: return "Network";
+        case CollectorId::Process: return "Process";
+        case CollectorId::Thermal: return "Thermal";
+        case CollectorId::Pressure: return "Pressure";
+        case CollectorId::Threads: return "Threads";
+        case CollectorId::Latency: return "Latency";
+        case CollectorId::Numa:    return "NUMA";
+        case CollectorId::Cgroups: return "Cgroups";
+        default:                   return "Unknown";
+    }
+}
+
+CollectorScheduler::~CollectorScheduler() {
+    Stop();
+}
+
+void CollectorScheduler::AddCollector(CollectorId id, SchedulerLane lane, std::chrono::milliseconds period, Task task) {
+    if (m_running) {
+        spdlog::error("Cannot add collector {} while the scheduler is running", GetCollectorName(id));
+        return;
+    }
+    
+    Entry& entry = m_entries[static_cast<size_t>(id)];
+    if (!entry.registered) m_order.push_back(id);
+    entry.registered = true;
+    entry.lane = lane;
+    entry.task = std::move(task);
+    entry.periodMs = static_cast<int>(period.count());
+}
+
+void CollectorScheduler::SetPeriod(CollectorId id, std::chrono::milliseconds period) {
+    Entry& entry = m_entries[static_cast<size_t>(id)];
+    entry.periodMs = std::max(1, static_cast<int>(period.count()));
+    
+    // Wake the lane so a shortened period takes effect without waiting out
+    // the old deadline.
+    WakeLane(entry.lane);
+}
+
+std::chrono::milliseconds CollectorScheduler::GetPeriod(CollectorId id) const {
+    return std::chrono::milliseconds(m_entries[static_cast<size_t>(id)].periodMs.load());
+}
+
+void CollectorScheduler::SetPaused(CollectorId id, bool paused) {
+    Entry& entry = m_entries[static_cast<size_t>(id)];
+    if (entry.paused.exchange(paused) == paused) return;
+    
+    WakeLane(entry.lane);
+}
+
+bool CollectorScheduler::IsPaused(CollectorId id) const {
+    return m_entries[static_cast<size_t>(id)].paused.load();
+}
+
+std::chrono::milliseconds CollectorScheduler::EffectivePeriod(const Entry& entry) {
+    return std::chrono::milliseconds(entry.periodMs.load(std::memory_order_relaxed) << entry.degradeLevel.load(std::memory_order_relaxed));
+}
+
+void CollectorScheduler::SetCpuBudget(float percentOfCore) {
+    m_budgetPercent = std::max(0.0f, percentOfCore);
+    if (m_budgetPercent > 0.0f) {
+        spdlog::info("Monitoring CPU budget set to {:.2f}% of one core", percentOfCore);
+        return;
+    }
+    
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (m_entries[i].degradeLevel.exchange(0) > 0) {
+            WakeLane(m_entries[i].lane);
+        }
+    }
+    spdlog::info("Monitoring CPU budget removed");
+}
+
+SchedulerOverhead CollectorScheduler::GetOverhead() const {
+    SchedulerOverhead overhead;
+    overhead.cpuPercent = m_cpuPercent;
+    overhead.wakeupsPerSec = m_wakeupsPerSec;
+    overhead.budgetPercent = m_budgetPercent;
+    
+    for (CollectorId id : m_order) {
+        if (m_entries[static_cast<size_t>(id)].degradeLevel > 0) overhead.degraded.push_back(id);
+    }
+    return overhead;
+}
+
+void CollectorScheduler::CloseBudgetWindow(Clock::time_point now) {
+    double windowNs = std::chrono::duration<double, std::nano>(now - m_windowStart).count();
+    m_windowStart = now;
+    if (windowNs <= 0.0) return;
+    
+    double totalNs = 0.0;
+    for (auto& entry : m_entries) {
+        double ns = static_cast<double>(entry.windowCpuNs.exchange(0, std::memory_order_relaxed));
+        entry.cpuPercent.store(static_cast<float>(100.0 * ns / windowNs), std::memory_order_relaxed);
+        totalNs += ns;
+    }
+    
+    uint64_t wakeups = 0;
+    for (const auto& lane : m_lanes) wakeups += lane.wakeups.load(std::memory_order_relaxed);
+    m_wakeupsPerSec = static_cast<float>((wakeups - m_windowWakeups) * 1e9 / windowNs);
+    m_windowWakeups = wakeups;
+    
+    float usage = static_cast<float>(100.0 * totalNs / windowNs);
+    m_cpuPercent = usage;
+    
+    float budget = m_budgetPercent;
+    if (budget <= 0.0f) return;
+    
+    if (usage > budget) {
+        float costliest = 0.0f;
+        for (CollectorId id : m_order) {
+            const Entry& entry = m_entries[static_cast<size_t>(id)];
+            if (entry.paused || entry.degradeLevel >= kMaxDegradeLevel) continue;
+            costliest = std::max(costliest, entry.cpuPercent.load(std::memory_order_relaxed));
+        }
+        if (costliest <= 0.0f) return;
+        
+        for (auto it = m_order.rbegin(); it != m_order.rend(); ++it) {
+            Entry& entry = m_entries[static_cast<size_t>(*it)];
+            if (entry.paused || entry.degradeLevel >= kMaxDegradeLevel) continue;
+            if (entry.cpuPercent < kMinDegradeShare * costliest) continue;
+            
+            entry.degradeLevel++;
+            spdlog::warn("Monitoring used {:.2f}% of a core against a {:.2f}% budget; degraded {} to every {} ms",
+                         usage, budget, GetCollectorName(*it), EffectivePeriod(entry).count());
+            return;
+        }
+    } else if (usage < budget * kRestoreFraction) {
+        for (CollectorId id : m_order) {
+            Entry& entry = m_entries[static_cast<size_t>(id)];
+            if (entry.degradeLevel == 0) continue;
+            
+            entry.degradeLevel--;
+            WakeLane(entry.lane);
+            spdlog::info("Monitoring back under budget ({:.2f}% of {:.2f}%); restored {} to every {} ms",
+                         usage, budget, GetCollectorName(id), EffectivePeriod(entry).count());
+            return;
+        }
+    }
+}
+
+void CollectorScheduler::WakeLane(SchedulerLane laneId) {
+    Lane& lane = m_lanes[static_cast<size_t>(laneId)];
+    {
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        lane.generation++;
+    }
+    lane.wakeup.notify_all();
+}
+
+void CollectorScheduler::Start() {
+    if (m_running) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_budgetMutex);
+        m_windowStart = Clock::now();
+    }
+    
+    m_running = true;
+    for (size_t i = 0; i < m_lanes.size(); i++) {
+        m_lanes[i].thread = std::thread(&CollectorScheduler::LaneThread, this, static_cast<SchedulerLane>(i));
+    }
+}
+
+void CollectorScheduler::Stop() {
+    if (!m_running) return;
+    
+    m_running = false;
+    for (auto& lane : m_lanes) {
+        {
+            std::lock_guard<std::mutex> lock(lane.mutex);
+        }
+        lane.wakeup.notify_all();
+    }
+    
+    for (auto& lane : m_lanes) {
+        if (lane.thread.joinable()) {
+            lane.thread.join();
+        }
+    }
+}
+
+std::vector<CollectorStats> CollectorScheduler::GetStats() const {
+    std::vector<CollectorStats> stats;
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    HdrHistogram durations;
+    
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        const Entry& entry = m_entries[i];
+        if (!entry.registered) continue;
+        
+        CollectorStats s;
+        s.id = static_cast<CollectorId>(i);
+        s.name = GetCollectorName(s.id);
+        s.lane = entry.lane;
+        s.period = EffectivePeriod(entry);
+        s.runs = entry.runs.load();
+        s.missedDeadlines = entry.missedDeadlines.load();
+        s.overruns = entry.overruns.load();
+        s.lastDuration = std::chrono::microseconds(entry.lastDurationUs.load());
+        s.maxDuration = std::chrono::microseconds(entry.maxDurationUs.load());
+        
+        entry.durationsUs.Snapshot(durations);
+        durations.Subtract(entry.durationsBaseline);
+        s.p50Duration = std::chrono::microseconds(durations.ValueAtPercentile(50.0));
+        s.p99Duration = std::chrono::microseconds(durations.ValueAtPercentile(99.0));
+        s.paused = entry.paused.load();
+        
+        uint64_t runs = std::max<uint64_t>(s.runs, 1);
+        s.cpuTimePerRun = std::chrono::microseconds(entry.cpuTimeNs.load() / 1000 / static_cast<int64_t>(runs));
+        s.syscallsPerRun = static_cast<double>(entry.syscalls.load()) / runs;
+        s.allocationsPerRun = static_cast<double>(entry.allocations.load()) / runs;
+        s.cpuPercent = entry.cpuPercent.load();
+        s.degradeLevel = entry.degradeLevel.load();
+        stats.push_back(s);
+    }
+    
+    return stats;
+}
+
+void CollectorScheduler::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    for (auto& entry : m_entries) {
+        entry.runs = 0;
+        entry.missedDeadlines = 0;
+        entry.overruns = 0;
+        entry.lastDurationUs = 0;
+        entry.maxDurationUs = 0;
+        entry.cpuTimeNs = 0;
+        entry.syscalls = 0;
+        entry.allocations = 0;
+        entry.durationsUs.Snapshot(entry.durationsBaseline);
+    }
+}
+
+void CollectorScheduler::RunEntry(Entry& entry) {
+    ThreadUsage before = ReadThreadUsage();
+    auto start = Clock::now();
+    entry.task();
+    auto durationUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    ThreadUsage after = ReadThreadUsage();
+    
+    int64_t cpuNs = after.cpuTimeNs - before.cpuTimeNs;
+    entry.cpuTimeNs.fetch_add(cpuNs, std::memory_order_relaxed);
+    entry.windowCpuNs.fetch_add(cpuNs, std::memory_order_relaxed);
+    entry.syscalls.fetch_add(after.syscalls - before.syscalls, std::memory_order_relaxed);
+    entry.allocations.fetch_add(after.allocations - before.allocations, std::memory_order_relaxed);
+    
+    entry.runs.fetch_add(1, std::memory_order_relaxed);
+    entry.durationsUs.Record(static_cast<uint64_t>(durationUs));
+    entry.lastDurationUs.store(durationUs, std::memory_order_relaxed);
+    if (durationUs > entry.maxDurationUs.load(std::memory_order_relaxed)) {
+        entry.maxDurationUs.store(durationUs, std::memory_order_relaxed);
+    }
+    if (durationUs > static_cast<int64_t>(EffectivePeriod(entry).count()) * 1000) {
+        entry.overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void CollectorScheduler::LaneThread(SchedulerLane laneId) {
+    // Each lane holds only a handful of collectors, so the deadline queue is
+    // a linear scan that re-reads every period on each pass; period changes
+    // therefore apply to the very next deadline.
+    struct Schedule {
+        size_t index;
+        Clock::time_point base;
+        bool paused;
+    };
+    
+    std::vector<Schedule> schedule;
+    
+    auto now = Clock::now();
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (m_entries[i].registered && m_entries[i].lane == laneId) {
+            schedule.push_back({i, now - EffectivePeriod(m_entries[i]), false});
+        }
+    }
+    
+    if (schedule.empty()) return;
+    
+    Lane& lane = m_lanes[static_cast<size_t>(laneId)];
+    
+    while (m_running) {
+        Schedule* next = nullptr;
+        Clock::time_point deadline = Clock::time_point::max();
+        
+        // Taken before the scan so a pause or period change made during it
+        // still ends the wait below.
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(lane.mutex);
+            generation = lane.generation;
+        }
+        
+        now = Clock::now();
+        for (auto& item : schedule) {
+            auto period = EffectivePeriod(m_entries[item.index]);
+            if (m_entries[item.index].paused.load()) {
+                item.paused = true;
+                continue;
+            }
+            if (item.paused) {
+                item.paused = false;
+                item.base = now - period;
+            }
+            
+            auto when = item.base + period;
+            if (when < deadline) {
+                deadline = when;
+                next = &item;
+            }
+        }
+        
+        {
+            std::unique_lock<std::mutex> lock(lane.mutex);
+            auto woken = [&] { return !m_running.load() || lane.generation != generation; };
+            if (next) {
+                lane.wakeup.wait_until(lock, deadline, woken);
+            } else {
+                lane.wakeup.wait(lock, woken);   // every collector paused
+            }
+        }
+        
+        if (!m_running) break;
+        lane.wakeups.fetch_add(1, std::memory_order_relaxed);
+        
+        now = Clock::now();
+        if (now < deadline) continue;
+        
+        Entry& entry = m_entries[next->index];
+        RunEntry(entry);
+        
+        auto period = EffectivePeriod(entry);
+        Clock::time_point following = deadline + period;
+        now = Clock::now();
+        
+        if (following <= now) {
+            auto behind = (now - following) / period + 1;
+            entry.missedDeadlines.fetch_add(static_cast<uint64_t>(behind), std::memory_order_relaxed);
+            following += period * behind;
+        }
+        
+        next->base = following - period;
+        
+        std::unique_lock<std::mutex> budget(m_budgetMutex, std::try_to_lock);
+        if (budget.owns_lock() && now - m_windowStart >= kBudgetWindow) {
+            CloseBudgetWindow(now);
+        }
+    }
+}
+
+}
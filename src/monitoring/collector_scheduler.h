@@ -0,0 +1,182 @@
+#pragma once
+#include "hdr_histogram.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Monitor {
+
+enum class CollectorId {
+    CPU,
+    GPU,
+    RAM,
+    Disk,
+    Network,
+    Process,
+    Thermal,
+    Pressure,
+    Threads,
+    Latency,
+    Numa,
+    Cgroups,
+    Count
+};
+
+// Set of collectors, one bit per CollectorId.
+using CollectorMask = uint32_t;
+
+constexpr CollectorMask CollectorBit(CollectorId id) {
+    return CollectorMask(1) << static_cast<unsigned>(id);
+}
+
+constexpr CollectorMask kAllCollectors = CollectorBit(CollectorId::Count) - 1;
+
+const char* GetCollectorName(CollectorId id);
+
+// Critical-lane collectors are cheap and latency sensitive; slow scans go to
+// the background lane so they can never delay a CPU sample.
+enum class SchedulerLane {
+    Critical,
+    Background,
+    Count
+};
+
+struct CollectorStats {
+    CollectorId id;
+    const char* name;
+    SchedulerLane lane;
+    std::chrono::milliseconds period;
+    uint64_t runs;
+    uint64_t missedDeadlines;
+    uint64_t overruns;
+    std::chrono::microseconds lastDuration;
+    std::chrono::microseconds maxDuration;
+    std::chrono::microseconds p50Duration;
+    std::chrono::microseconds p99Duration;
+    bool paused;
+    
+    // Self-overhead: averages per run since the last ResetStats, and the
+    // share of one core over the last budget window.
+    std::chrono::microseconds cpuTimePerRun;
+    double syscallsPerRun;
+    double allocationsPerRun;
+    float cpuPercent;
+    int degradeLevel;               // period doubled this many times by the budget
+};
+
+struct SchedulerOverhead {
+    float cpuPercent;               // of one core, over the last budget window
+    float wakeupsPerSec;
+    float budgetPercent;            // 0 when no budget is set
+    std::vector<CollectorId> degraded;
+};
+
+// Deadline-queue scheduler: one thread per lane, each running the collector
+// with the earliest deadline. Deadlines advance at a fixed rate from the
+// previous deadline, so jitter does not accumulate; periods that pass while a
+// collector is still running are skipped and counted as missed deadlines, and
+// a run that takes longer than its period counts as an overrun.
+//
+// Every run is also charged its thread CPU time, syscalls and allocations.
+// Under a CPU budget, the scheduler degrades collectors in reverse
+// registration order, so register the most important ones first.
+class CollectorScheduler {
+public:
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+    
+    CollectorScheduler() = default;
+    ~CollectorScheduler();
+    
+    CollectorScheduler(const CollectorScheduler&) = delete;
+    CollectorScheduler& operator=(const CollectorScheduler&) = delete;
+    
+    void AddCollector(CollectorId id, SchedulerLane lane, std::chrono::milliseconds period, Task task);
+    
+    void SetPeriod(CollectorId id, std::chrono::milliseconds period);
+    std::chrono::milliseconds GetPeriod(CollectorId id) const;
+    
+    // A paused collector keeps its registration but is never run; resuming
+    // runs it at once instead of at its old deadline.
+    void SetPaused(CollectorId id, bool paused);
+    bool IsPaused(CollectorId id) const;
+    
+    void Start();
+    void Stop();
+    bool IsRunning() const { return m_running; }
+    
+    std::vector<CollectorStats> GetStats() const;
+    void ResetStats();
+    
+    // Caps the collectors' CPU use at a percentage of one core, checked over
+    // two-second windows; 0 removes the cap. A window over budget doubles the
+    // period of the lowest-priority collector among those costing at least
+    // a quarter of the costliest one, up to kMaxDegradeLevel times; a window
+    // under 70% of the budget undoes one step on the highest-priority
+    // degraded collector.
+    static constexpr int kMaxDegradeLevel = 4;
+    void SetCpuBudget(float percentOfCore);
+    float GetCpuBudget() const { return m_budgetPercent; }
+    SchedulerOverhead GetOverhead() const;
+    
+private:
+    struct Entry {
+        bool registered = false;
+        SchedulerLane lane = SchedulerLane::Critical;
+        Task task;
+        
+        std::atomic<int> periodMs{1000};
+        std::atomic<bool> paused{false};
+        std::atomic<uint64_t> runs{0};
+        std::atomic<uint64_t> missedDeadlines{0};
+        std::atomic<uint64_t> overruns{0};
+        std::atomic<int64_t> lastDurationUs{0};
+        std::atomic<int64_t> maxDurationUs{0};
+        std::atomic<int64_t> cpuTimeNs{0};
+        std::atomic<uint64_t> syscalls{0};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<int64_t> windowCpuNs{0};
+        std::atomic<float> cpuPercent{0.0f};
+        std::atomic<int> degradeLevel{0};
+        SharedHistogram durationsUs;
+        HdrHistogram durationsBaseline;   // state at the last ResetStats
+    };
+    
+    struct Lane {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        uint64_t generation = 0;
+        std::atomic<uint64_t> wakeups{0};
+    };
+    
+    static std::chrono::milliseconds EffectivePeriod(const Entry& entry);
+    
+    void LaneThread(SchedulerLane lane);
+    void RunEntry(Entry& entry);
+    void WakeLane(SchedulerLane lane);
+    void CloseBudgetWindow(Clock::time_point now);
+    
+    std::array<Entry, static_cast<size_t>(CollectorId::Count)> m_entries;
+    std::array<Lane, static_cast<size_t>(SchedulerLane::Count)> m_lanes;
+    std::vector<CollectorId> m_order;   // registration order, most important first
+    std::atomic<bool> m_running{false};
+    mutable std::mutex m_statsMutex;
+    
+    // Budget window state, guarded by m_budgetMutex; whichever lane finishes
+    // a run after the window ends closes it.
+    std::atomic<float> m_budgetPercent{0.0f};
+    std::mutex m_budgetMutex;
+    Clock::time_point m_windowStart;
+    uint64_t m_windowWakeups = 0;
+    std::atomic<float> m_cpuPercent{0.0f};
+    std::atomic<float> m_wakeupsPerSec{0.0f};
+};
+
+}
@@ -0,0 +1,172 @@
+#include "cpu_topology.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <thread>
+#include <tuple>
+
+namespace Monitor {
+
+namespace {
+
+// Cores ranked below this fraction of the fastest are efficiency cores.
+// Hybrid parts sit far below it (E-cores clock about 70% of P-cores, and
+// big.LITTLE capacities are often under half), while the favored cores of
+// a uniform part differ by a few percent.
+constexpr double kEfficiencyRankRatio = 0.85;
+
+}
+
+std::shared_ptr<const CpuTopology> CpuTopology::Build(TopologySource source) {
+    std::shared_ptr<CpuTopology> topology(new CpuTopology());
+    auto& cpus = topology->m_cpus;
+    cpus = std::move(source.cpus);
+    
+    if (cpus.empty()) {
+        int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int id = 0; id < count; id++) {
+            LogicalCpu& cpu = cpus.emplace_back();
+            cpu.id = id;
+            cpu.core = id;
+        }
+    }
+    
+    std::sort(cpus.begin(), cpus.end(), [](const LogicalCpu& a, const LogicalCpu& b) { return a.id < b.id; });
+    cpus.erase(std::unique(cpus.begin(), cpus.end(), [](const LogicalCpu& a, const LogicalCpu& b) { return a.id == b.id; }), cpus.end());
+    
+    topology->m_cpuIndex.assign(cpus.back().id + 1, -1);
+    for (size_t i = 0; i < cpus.size(); i++) {
+        topology->m_cpuIndex[cpus[i].id] = static_cast<int>(i);
+    }
+    
+    uint32_t topRank = 0;
+    for (const auto& cpu : cpus) topRank = std::max(topRank, cpu.performanceRank);
+    
+    // Cores, in order of their first thread.
+    std::map<std::tuple<int, int, int>, int> coreIndex;
+    std::set<int> packages;
+    std::set<std::pair<int, int>> dies;
+    std::map<int, std::vector<int>> nodes;
+    for (auto& cpu : cpus) {
+        auto [entry, added] = coreIndex.try_emplace({cpu.package, cpu.die, cpu.core}, static_cast<int>(topology->m_cores.size()));
+        if (added) {
+            PhysicalCore& core = topology->m_cores.emplace_back();
+            core.package = cpu.package;
+            core.die = cpu.die;
+            core.maxFrequencyMHz = cpu.maxFrequencyMHz;
+            if (cpu.performanceRank < topRank * kEfficiencyRankRatio) core.coreClass = CoreClass::Efficiency;
+        }
+        
+        PhysicalCore& core = topology->m_cores[entry->second];
+        cpu.coreIndex = entry->second;
+        cpu.coreClass = core.coreClass;
+        cpu.primaryThread = core.threads.empty();
+        core.threads.push_back(cpu.id);
+        
+        packages.insert(cpu.package);
+        dies.insert({cpu.package, cpu.die});
+        nodes[cpu.numaNode].push_back(cpu.id);
+        topology->m_hybrid |= core.coreClass == CoreClass::Efficiency;
+    }
+    topology->m_packageCount = static_cast<int>(packages.size());
+    topology->m_dieCount = static_cast<int>(dies.size());
+    
+    for (auto& [id, nodeCpus] : nodes) {
+        topology->m_nodes.push_back({id, std::move(nodeCpus)});
+    }
+    
+    // Each CPU reports the caches it sits behind, so most domains arrive
+    // once per member.
+    auto& caches = topology->m_caches;
+    for (auto& cache : source.caches) {
+        if (cache.level < 2 || cache.cpus.empty()) continue;
+        std::sort(cache.cpus.begin(), cache.cpus.end());
+        bool known = std::any_of(caches.begin(), caches.end(), [&](const CacheDomain& other) {
+            return other.level == cache.level && other.cpus == cache.cpus;
+        });
+        if (!known) caches.push_back(std::move(cache));
+    }
+    std::sort(caches.begin(), caches.end(), [](const CacheDomain& a, const CacheDomain& b) {
+        return std::tie(a.level, a.cpus.front()) < std::tie(b.level, b.cpus.front());
+    });
+    
+    for (size_t i = 0; i < caches.size(); i++) {
+        for (int id : caches[i].cpus) {
+            if (id < 0 || id >= static_cast<int>(topology->m_cpuIndex.size()) || topology->m_cpuIndex[id] < 0) continue;
+            LogicalCpu& cpu = cpus[topology->m_cpuIndex[id]];
+            if (caches[i].level == 2) cpu.l2Domain = static_cast<int>(i);
+            if (caches[i].level == 3) cpu.l3Domain = static_cast<int>(i);
+        }
+    }
+    
+    return topology;
+}
+
+const LogicalCpu* CpuTopology::FindCpu(int id) const {
+    if (id < 0 || id >= static_cast<int>(m_cpuIndex.size()) || m_cpuIndex[id] < 0) return nullptr;
+    return &m_cpus[m_cpuIndex[id]];
+}
+
+std::vector<int> CpuTopology::GetSiblings(int cpu) const {
+    const LogicalCpu* info = FindCpu(cpu);
+    if (!info) return {};
+    return m_cores[info->coreIndex].threads;
+}
+
+std::vector<int> CpuTopology::GetCpus(CoreClass coreClass) const {
+    std::vector<int> ids;
+    for (const auto& cpu : m_cpus) {
+        if (cpu.coreClass == coreClass) ids.push_back(cpu.id);
+    }
+    return ids;
+}
+
+std::vector<int> CpuTopology::GetPrimaryThreads() const {
+    std::vector<int> ids;
+    for (const auto& core : m_cores) ids.push_back(core.threads.front());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+const CacheDomain* CpuTopology::GetSharedCache(int cpu, int level) const {
+    const LogicalCpu* info = FindCpu(cpu);
+    if (!info) return nullptr;
+    
+    int domain = level == 2 ? info->l2Domain : level == 3 ? info->l3Domain : -1;
+    return domain >= 0 ? &m_caches[domain] : nullptr;
+}
+
+std::string CpuTopology::GetFingerprint() const {
+    std::string text = std::to_string(m_packageCount) + (m_packageCount == 1 ? " package, " : " packages, ");
+    if (m_dieCount > m_packageCount) text += std::to_string(m_dieCount) + " dies, ";
+    
+    if (m_hybrid) {
+        size_t efficiency = std::count_if(m_cores.begin(), m_cores.end(), [](const PhysicalCore& core) {
+            return core.coreClass == CoreClass::Efficiency;
+        });
+        text += std::to_string(m_cores.size() - efficiency) + "P+" + std::to_string(efficiency) + "E cores, ";
+    } else {
+        text += std::to_string(m_cores.size()) + " cores, ";
+    }
+    text += std::to_string(m_cpus.size()) + " threads";
+    
+    // Largest cache level only, e.g. "L3 2x32 MB" for two CCDs.
+    int lastLevel = 0;
+    for (const auto& cache : m_caches) lastLevel = std::max(lastLevel, cache.level);
+    if (lastLevel > 0) {
+        int count = 0;
+        uint64_t sizeKB = 0;
+        for (const auto& cache : m_caches) {
+            if (cache.level != lastLevel) continue;
+            count++;
+            sizeKB = std::max(sizeKB, cache.sizeKB);
+        }
+        text += ", L" + std::to_string(lastLevel) + " " + std::to_string(count) + "x" +
+            (sizeKB >= 1024 ? std::to_string(sizeKB / 1024) + " MB" : std::to_string(sizeKB) + " KB");
+    }
+    
+    text += ", " + std::to_string(m_nodes.size()) + (m_nodes.size() == 1 ? " NUMA node" : " NUMA nodes");
+    return text;
+}
+
+}
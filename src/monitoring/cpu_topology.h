@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Monitor {
+
+enum class CoreClass {
+    Performance,
+    Efficiency
+};
+
+// One logical processor (hardware thread). Backends fill the reported
+// fields; CpuTopology::Build fills the derived ones.
+struct LogicalCpu {
+    int id = 0;
+    int package = 0;
+    int die = 0;
+    int core = 0;                   // any value shared by SMT siblings only
+    int numaNode = 0;
+    uint32_t maxFrequencyMHz = 0;   // 0 when unknown
+    uint32_t performanceRank = 0;   // capacity, efficiency class or max clock
+    
+    int coreIndex = -1;             // into CpuTopology::GetCores
+    int l2Domain = -1;              // into CpuTopology::GetCaches
+    int l3Domain = -1;
+    CoreClass coreClass = CoreClass::Performance;
+    bool primaryThread = true;      // lowest-numbered SMT sibling of its core
+};
+
+struct PhysicalCore {
+    int package = 0;
+    int die = 0;
+    CoreClass coreClass = CoreClass::Performance;
+    uint32_t maxFrequencyMHz = 0;
+    std::vector<int> threads;       // logical CPU ids, ascending
+};
+
+// A cache shared by a set of logical CPUs; only unified or data caches of
+// level 2 and up are kept.
+struct CacheDomain {
+    int level = 0;
+    uint64_t sizeKB = 0;
+    std::vector<int> cpus;
+};
+
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+// What a backend reports; duplicate cache domains are merged by Build.
+struct TopologySource {
+    std::vector<LogicalCpu> cpus;
+    std::vector<CacheDomain> caches;
+};
+
+// Processor layout: packages, dies, physical cores and their SMT siblings,
+// L2/L3 sharing domains, NUMA nodes and hybrid core classes. Built once per
+// backend and never modified, so it is shared without locking through
+// MonitoringEngine::GetTopology.
+class CpuTopology {
+public:
+    // An empty source gives a flat layout of hardware_concurrency cores.
+    static std::shared_ptr<const CpuTopology> Build(TopologySource source);
+    
+    const std::vector<LogicalCpu>& GetCpus() const { return m_cpus; }
+    const std::vector<PhysicalCore>& GetCores() const { return m_cores; }
+    const std::vector<CacheDomain>& GetCaches() const { return m_caches; }
+    const std::vector<NumaNode>& GetNodes() const { return m_nodes; }
+    
+    int GetPackageCount() const { return m_packageCount; }
+    int GetDieCount() const { return m_dieCount; }
+    bool IsHybrid() const { return m_hybrid; }
+    bool HasSMT() const { return m_cores.size() < m_cpus.size(); }
+    
+    const LogicalCpu* FindCpu(int id) const;
+    
+    // SMT siblings of `cpu`, itself included.
+    std::vector<int> GetSiblings(int cpu) const;
+    std::vector<int> GetCpus(CoreClass coreClass) const;
+    
+    // One logical CPU per physical core, for spreading work without sharing
+    // execution units.
+    std::vector<int> GetPrimaryThreads() const;
+    
+    // The L2 or L3 domain `cpu` belongs to, or nullptr when unknown.
+    const CacheDomain* GetSharedCache(int cpu, int level) const;
+    
+    // One-line summary, e.g. "1 package, 8P+16E cores, 32 threads,
+    // L3 1x36 MB, 1 NUMA node".
+    std::string GetFingerprint() const;
+    
+private:
+    CpuTopology() = default;
+    
+    std::vector<LogicalCpu> m_cpus;
+    std::vector<int> m_cpuIndex;    // id -> index into m_cpus, -1 for gaps
+    std::vector<PhysicalCore> m_cores;
+    std::vector<CacheDomain> m_caches;
+    std::vector<NumaNode> m_nodes;
+    int m_packageCount = 0;
+    int m_dieCount = 0;
+    bool m_hybrid = false;
+};
+
+}
@@ -0,0 +1,271 @@
+#include "gorilla_codec.h"
+#include <bit>
+
+namespace Monitor {
+
+void BitWriter::Write(uint64_t value, int bits) {
+    if (bits < 64) {
+        value &= (1ull << bits) - 1;
+    }
+    
+    int offset = static_cast<int>(m_bitCount % 64);
+    if (offset == 0) {
+        m_words.push_back(0);
+    }
+    
+    int free = 64 - offset;
+    if (bits <= free) {
+        m_words.back() |= value << (free - bits);
+    } else {
+        int spill = bits - free;
+        m_words.back() |= value >> spill;
+        m_words.push_back(value << (64 - spill));
+    }
+    
+    m_bitCount += bits;
+}
+
+std::vector<uint64_t> BitWriter::Release() {
+    std::vector<uint64_t> words = std::move(m_words);
+    words.shrink_to_fit();
+    Clear();
+    return words;
+}
+
+void BitWriter::Clear() {
+    m_words.clear();
+    m_bitCount = 0;
+}
+
+uint64_t BitReader::Read(int bits) {
+    size_t word = m_bitPos / 64;
+    int offset = static_cast<int>(m_bitPos % 64);
+    m_bitPos += bits;
+    
+    if (word >= m_words.size()) return 0;
+    
+    int available = 64 - offset;
+    if (bits <= available) {
+        return (m_words[word] << offset) >> (64 - bits);
+    }
+    
+    int rest = bits - available;
+    uint64_t high = m_words[word] & ((1ull << available) - 1);
+    uint64_t low = word + 1 < m_words.size() ? m_words[word + 1] >> (64 - rest) : 0;
+    return (high << rest) | low;
+}
+
+void TimestampEncoder::Append(BitWriter& out, int64_t timestampUs) {
+    if (m_first) {
+        out.Write(static_cast<uint64_t>(timestampUs), 64);
+        m_prev = timestampUs;
+        m_first = false;
+        return;
+    }
+    
+    int64_t delta = timestampUs - m_prev;
+    int64_t dod = delta - m_prevDelta;
+    m_prev = timestampUs;
+    m_prevDelta = delta;
+    
+    if (dod == 0) {
+        out.WriteBit(false);
+    } else if (dod >= -63 && dod <= 64) {
+        out.Write(0b10, 2);
+        out.Write(static_cast<uint64_t>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        out.Write(0b110, 3);
+        out.Write(static_cast<uint64_t>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        out.Write(0b1110, 4);
+        out.Write(static_cast<uint64_t>(dod + 2047), 12);
+    } else if (dod >= -524287 && dod <= 524288) {
+        out.Write(0b11110, 5);
+        out.Write(static_cast<uint64_t>(dod + 524287), 20);
+    } else {
+        out.Write(0b11111, 5);
+        out.Write(static_cast<uint64_t>(dod), 64);
+    }
+}
+
+int64_t TimestampDecoder::Next(BitReader& in) {
+    if (m_first) {
+        m_prev = static_cast<int64_t>(in.Read(64));
+        m_first = false;
+        return m_prev;
+    }
+    
+    int64_t dod = 0;
+    if (in.ReadBit()) {
+        if (!in.ReadBit()) {
+            dod = static_cast<int64_t>(in.Read(7)) - 63;
+        } else if (!in.ReadBit()) {
+            dod = static_cast<int64_t>(in.Read(9)) - 255;
+        } else if (!in.ReadBit()) {
+            dod = static_cast<int64_t>(in.Read(12)) - 2047;
+        } else if (!in.ReadBit()) {
+            dod = static_cast<int64_t>(in.Read(20)) - 524287;
+        } else {
+            dod = static_cast<int64_t>(in.Read(64));
+        }
+    }
+    
+    m_prevDelta += dod;
+    m_prev += m_prevDelta;
+    return m_prev;
+}
+
+void FloatEncoder::Append(BitWriter& out, float value) {
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    
+    if (m_first) {
+        out.Write(bits, 32);
+        m_prev = bits;
+        m_first = false;
+        return;
+    }
+    
+    uint32_t x = bits ^ m_prev;
+    m_prev = bits;
+    
+    if (x == 0) {
+        out.WriteBit(false);
+        return;
+    }
+    
+    out.WriteBit(true);
+    
+    int leading = std::countl_zero(x);
+    int trailing = std::countr_zero(x);
+    
+    if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing) {
+        out.WriteBit(false);
+        out.Write(x >> m_trailing, 32 - m_leading - m_trailing);
+    } else {
+        int meaningful = 32 - leading - trailing;
+        out.WriteBit(true);
+        out.Write(static_cast<uint64_t>(leading), 5);
+        out.Write(static_cast<uint64_t>(meaningful - 1), 5);
+        out.Write(x >> trailing, meaningful);
+        m_leading = leading;
+        m_trailing = trailing;
+    }
+}
+
+float FloatDecoder::Next(BitReader& in) {
+    if (m_first) {
+        m_prev = static_cast<uint32_t>(in.Read(32));
+        m_first = false;
+        return std::bit_cast<float>(m_prev);
+    }
+    
+    if (in.ReadBit()) {
+        if (in.ReadBit()) {
+            m_leading = static_cast<int>(in.Read(5));
+            int meaningful = static_cast<int>(in.Read(5)) + 1;
+            m_trailing = 32 - m_leading - meaningful;
+        }
+        
+        int meaningful = 32 - m_leading - m_trailing;
+        uint32_t x = static_cast<uint32_t>(in.Read(meaningful)) << m_trailing;
+        m_prev ^= x;
+    }
+    
+    return std::bit_cast<float>(m_prev);
+}
+
+size_t CompressedBlock::GetMemoryBytes() const {
+    size_t bytes = sizeof(*this) + timestamps.capacity() * sizeof(uint64_t);
+    for (const auto& column : columns) {
+        bytes += sizeof(column) + column.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+void CompressedBlock::DecodeColumn(size_t column, int64_t sinceUs,
+                                   std::vector<int64_t>& timestampsOut, std::vector<float>& valuesOut) const {
+    if (column >= columns.size() || lastTimestampUs < sinceUs) return;
+    
+    BitReader timeBits(timestamps);
+    BitReader valueBits(columns[column]);
+    TimestampDecoder timeDecoder;
+    FloatDecoder valueDecoder;
+    
+    timestampsOut.reserve(timestampsOut.size() + rowCount);
+    valuesOut.reserve(valuesOut.size() + rowCount);
+    
+    for (uint32_t row = 0; row < rowCount; row++) {
+        int64_t timestamp = timeDecoder.Next(timeBits);
+        float value = valueDecoder.Next(valueBits);
+        
+        if (timestamp >= sinceUs) {
+            timestampsOut.push_back(timestamp);
+            valuesOut.push_back(value);
+        }
+    }
+}
+
+void CompressedBlock::DecodeTimestamps(std::vector<int64_t>& out) const {
+    BitReader timeBits(timestamps);
+    TimestampDecoder decoder;
+    
+    out.reserve(out.size() + rowCount);
+    for (uint32_t row = 0; row < rowCount; row++) {
+        out.push_back(decoder.Next(timeBits));
+    }
+}
+
+BlockBuilder::BlockBuilder(size_t columns)
+    : m_columnCount(columns),
+      m_columnBits(columns),
+      m_columnEncoders(columns) {}
+
+void BlockBuilder::Append(int64_t timestampUs, std::span<const float> values) {
+    if (m_rowCount == 0) {
+        m_firstTimestampUs = timestampUs;
+    }
+    m_lastTimestampUs = timestampUs;
+    
+    m_timestampEncoder.Append(m_timestampBits, timestampUs);
+    
+    for (size_t c = 0; c < m_columnCount; c++) {
+        float value = c < values.size() ? values[c] : 0.0f;
+        m_columnEncoders[c].Append(m_columnBits[c], value);
+    }
+    
+    m_rowCount++;
+}
+
+size_t BlockBuilder::GetPendingBytes() const {
+    size_t bytes = m_timestampBits.GetByteCount();
+    for (const auto& bits : m_columnBits) {
+        bytes += bits.GetByteCount();
+    }
+    return bytes;
+}
+
+CompressedBlock BlockBuilder::Seal() {
+    CompressedBlock block;
+    block.rowCount = m_rowCount;
+    block.firstTimestampUs = m_firstTimestampUs;
+    block.lastTimestampUs = m_lastTimestampUs;
+    block.timestamps = m_timestampBits.Release();
+    
+    block.columns.reserve(m_columnCount);
+    for (auto& bits : m_columnBits) {
+        block.columns.push_back(bits.Release());
+    }
+    
+    Reset();
+    return block;
+}
+
+void BlockBuilder::Reset() {
+    m_rowCount = 0;
+    m_timestampEncoder = TimestampEncoder();
+    for (auto& encoder : m_columnEncoders) {
+        encoder = FloatEncoder();
+    }
+}
+
+}
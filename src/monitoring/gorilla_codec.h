@@ -0,0 +1,132 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Monitor {
+
+class BitWriter {
+public:
+    void Write(uint64_t value, int bits);
+    void WriteBit(bool bit) { Write(bit ? 1 : 0, 1); }
+    
+    size_t GetBitCount() const { return m_bitCount; }
+    size_t GetByteCount() const { return (m_bitCount + 7) / 8; }
+    
+    std::vector<uint64_t> Release();
+    void Clear();
+    
+private:
+    std::vector<uint64_t> m_words;
+    size_t m_bitCount = 0;
+};
+
+class BitReader {
+public:
+    explicit BitReader(std::span<const uint64_t> words) : m_words(words) {}
+    
+    uint64_t Read(int bits);
+    bool ReadBit() { return Read(1) != 0; }
+    
+private:
+    std::span<const uint64_t> m_words;
+    size_t m_bitPos = 0;
+};
+
+// Gorilla-style encoders (Pelkonen et al., VLDB 2015), adapted to the
+// engine's microsecond timestamps and 32-bit float values.
+//
+// Timestamps: delta-of-delta with the buckets
+//   '0' (dod 0) | '10'+7 | '110'+9 | '1110'+12 | '11110'+20 | '11111'+64 bits.
+// A 100 ms collector with sub-millisecond jitter lands in the 12/20-bit
+// buckets; a perfectly regular one costs one bit per sample.
+//
+// Values: XOR with the previous value; '0' when identical, '10' + bits when
+// the meaningful bits fit the previous window, otherwise
+// '11' + 5 bits leading zeros + 5 bits (length - 1) + bits.
+class TimestampEncoder {
+public:
+    void Append(BitWriter& out, int64_t timestampUs);
+    
+private:
+    int64_t m_prev = 0;
+    int64_t m_prevDelta = 0;
+    bool m_first = true;
+};
+
+class TimestampDecoder {
+public:
+    int64_t Next(BitReader& in);
+    
+private:
+    int64_t m_prev = 0;
+    int64_t m_prevDelta = 0;
+    bool m_first = true;
+};
+
+class FloatEncoder {
+public:
+    void Append(BitWriter& out, float value);
+    
+private:
+    uint32_t m_prev = 0;
+    int m_leading = -1;
+    int m_trailing = 0;
+    bool m_first = true;
+};
+
+class FloatDecoder {
+public:
+    float Next(BitReader& in);
+    
+private:
+    uint32_t m_prev = 0;
+    int m_leading = 0;
+    int m_trailing = 0;
+    bool m_first = true;
+};
+
+// Immutable compressed run of rows for a table: one timestamp stream shared
+// by every column plus one value stream per column.
+struct CompressedBlock {
+    uint32_t rowCount = 0;
+    int64_t firstTimestampUs = 0;
+    int64_t lastTimestampUs = 0;
+    std::vector<uint64_t> timestamps;
+    std::vector<std::vector<uint64_t>> columns;
+    
+    size_t GetMemoryBytes() const;
+    
+    // Sequential decode of one column; appends to the outputs. Rows before
+    // sinceUs are decoded but not emitted.
+    void DecodeColumn(size_t column, int64_t sinceUs,
+                      std::vector<int64_t>& timestampsOut, std::vector<float>& valuesOut) const;
+    void DecodeTimestamps(std::vector<int64_t>& out) const;
+};
+
+class BlockBuilder {
+public:
+    explicit BlockBuilder(size_t columns);
+    
+    void Append(int64_t timestampUs, std::span<const float> values);
+    uint32_t GetRowCount() const { return m_rowCount; }
+    size_t GetPendingBytes() const;
+    
+    CompressedBlock Seal();
+    
+private:
+    void Reset();
+    
+    size_t m_columnCount;
+    uint32_t m_rowCount = 0;
+    int64_t m_firstTimestampUs = 0;
+    int64_t m_lastTimestampUs = 0;
+    
+    BitWriter m_timestampBits;
+    TimestampEncoder m_timestampEncoder;
+    std::vector<BitWriter> m_columnBits;
+    std::vector<FloatEncoder> m_columnEncoders;
+};
+
+}
@@ -0,0 +1,230 @@
+#include "hdr_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Monitor {
+
+namespace {
+
+constexpr uint8_t kFormatVersion = 1;
+
+std::atomic<uint64_t> g_nextHistogramId{1};
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool GetVarint(std::span<const uint8_t> data, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+}
+
+uint64_t HdrHistogram::BucketLowerBound(size_t index) {
+    if (index < kSubBuckets) return index;
+    int shift = static_cast<int>(index >> kSubBucketBits) - 1;
+    uint64_t base = (index & (kSubBuckets - 1)) + kSubBuckets;
+    return base << shift;
+}
+
+uint64_t HdrHistogram::BucketUpperBound(size_t index) {
+    if (index < kSubBuckets) return index;
+    int shift = static_cast<int>(index >> kSubBucketBits) - 1;
+    uint64_t base = (index & (kSubBuckets - 1)) + kSubBuckets;
+    return ((base + 1) << shift) - 1;
+}
+
+void HdrHistogram::RecordCount(uint64_t value, uint64_t count) {
+    if (count == 0) return;
+    m_counts[BucketIndex(value)] += count;
+    m_count += count;
+    m_sum += static_cast<double>(value) * count;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+}
+
+void HdrHistogram::Merge(const HdrHistogram& other) {
+    for (size_t i = 0; i < kBucketCount; i++) {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+void HdrHistogram::Subtract(const HdrHistogram& earlier) {
+    size_t first = kBucketCount;
+    size_t last = 0;
+    m_count = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        m_counts[i] -= std::min(m_counts[i], earlier.m_counts[i]);
+        if (m_counts[i]) {
+            first = std::min(first, i);
+            last = i;
+            m_count += m_counts[i];
+        }
+    }
+    m_sum = std::max(0.0, m_sum - earlier.m_sum);
+    
+    if (m_count == 0) {
+        m_min = UINT64_MAX;
+        m_max = 0;
+        m_sum = 0.0;
+        return;
+    }
+    m_min = std::max(m_min, BucketLowerBound(first));
+    m_max = std::min(m_max, BucketUpperBound(last));
+}
+
+void HdrHistogram::Reset() {
+    m_counts.fill(0);
+    m_count = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+    m_sum = 0.0;
+}
+
+uint64_t HdrHistogram::ValueAtPercentile(double percentile) const {
+    if (m_count == 0) return 0;
+    
+    double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * m_count)));
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += m_counts[i];
+        if (seen >= rank) return std::min(BucketUpperBound(i), m_max);
+    }
+    return m_max;
+}
+
+double HdrHistogram::GetMean() const {
+    return m_count ? m_sum / static_cast<double>(m_count) : 0.0;
+}
+
+// Layout: version, sub-bucket bits, varint count/min/max, varint sum
+// rounded to an integer, varint number of non-empty buckets, then a varint
+// (gap from the previous non-empty index, count) pair for each.
+void HdrHistogram::Serialize(std::vector<uint8_t>& out) const {
+    out.push_back(kFormatVersion);
+    out.push_back(static_cast<uint8_t>(kSubBucketBits));
+    PutVarint(out, m_count);
+    PutVarint(out, GetMin());
+    PutVarint(out, m_max);
+    PutVarint(out, static_cast<uint64_t>(std::llround(m_sum)));
+    
+    uint64_t buckets = 0;
+    for (uint64_t count : m_counts) buckets += count != 0;
+    PutVarint(out, buckets);
+    
+    size_t previous = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        if (!m_counts[i]) continue;
+        PutVarint(out, i - previous);
+        PutVarint(out, m_counts[i]);
+        previous = i;
+    }
+}
+
+bool HdrHistogram::Deserialize(std::span<const uint8_t> data) {
+    Reset();
+    if (data.size() < 2 || data[0] != kFormatVersion || data[1] != kSubBucketBits) return false;
+    
+    size_t pos = 2;
+    uint64_t count = 0, minValue = 0, maxValue = 0, sum = 0, buckets = 0;
+    if (!GetVarint(data, pos, count) || !GetVarint(data, pos, minValue) || !GetVarint(data, pos, maxValue) ||
+        !GetVarint(data, pos, sum) || !GetVarint(data, pos, buckets) || buckets > kBucketCount) {
+        return false;
+    }
+    
+    uint64_t index = 0;
+    uint64_t total = 0;
+    for (uint64_t b = 0; b < buckets; b++) {
+        uint64_t gap = 0, bucketCount = 0;
+        if (!GetVarint(data, pos, gap) || !GetVarint(data, pos, bucketCount)) break;
+        index += gap;
+        if (index >= kBucketCount) break;
+        m_counts[index] = bucketCount;
+        total += bucketCount;
+    }
+    
+    if (total != count) {
+        Reset();
+        return false;
+    }
+    
+    m_count = count;
+    m_min = count ? minValue : UINT64_MAX;
+    m_max = maxValue;
+    m_sum = static_cast<double>(sum);
+    return true;
+}
+
+SharedHistogram::SharedHistogram()
+    : m_id(g_nextHistogramId.fetch_add(1, std::memory_order_relaxed)) {}
+
+SharedHistogram::~SharedHistogram() {
+    Shard* shard = m_shards.load(std::memory_order_acquire);
+    while (shard) {
+        Shard* next = shard->next;
+        delete shard;
+        shard = next;
+    }
+}
+
+SharedHistogram::Shard* SharedHistogram::AttachShard() {
+    // A thread evicted from its cache finds its old shard again instead of
+    // growing the list.
+    auto self = std::this_thread::get_id();
+    Shard* shard = m_shards.load(std::memory_order_acquire);
+    while (shard && shard->owner != self) shard = shard->next;
+    
+    if (!shard) {
+        shard = new Shard();
+        shard->owner = self;
+        shard->next = m_shards.load(std::memory_order_relaxed);
+        while (!m_shards.compare_exchange_weak(shard->next, shard, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+    
+    size_t slot = t_cache.next++ % ShardCache::kEntries;
+    t_cache.ids[slot] = m_id;
+    t_cache.shards[slot] = shard;
+    return shard;
+}
+
+void SharedHistogram::Snapshot(HdrHistogram& out) const {
+    out.Reset();
+    for (Shard* shard = m_shards.load(std::memory_order_acquire); shard; shard = shard->next) {
+        uint64_t count = 0;
+        for (size_t i = 0; i < HdrHistogram::kBucketCount; i++) {
+            uint64_t value = shard->counts[i].load(std::memory_order_relaxed);
+            out.m_counts[i] += value;
+            count += value;
+        }
+        if (count == 0) continue;
+        out.m_count += count;
+        out.m_sum += static_cast<double>(shard->sum.load(std::memory_order_relaxed));
+        out.m_min = std::min(out.m_min, shard->min.load(std::memory_order_relaxed));
+        out.m_max = std::max(out.m_max, shard->max.load(std::memory_order_relaxed));
+    }
+}
+
+void SharedHistogram::SnapshotInterval(HdrHistogram& previous, HdrHistogram& interval) const {
+    Snapshot(interval);
+    HdrHistogram cumulative = interval;
+    interval.Subtract(previous);
+    previous = cumulative;
+}
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace Monitor {
+
+// High-dynamic-range histogram of non-negative integers (typically ns or
+// us). Buckets are log-linear: exact below 32, then 32 sub-buckets per power
+// of two, so any value up to 2^64 is stored within about 3% using a fixed
+// 1920 counters. Not thread-safe; see SharedHistogram for concurrent use.
+class HdrHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) << kSubBucketBits;
+    
+    static size_t BucketIndex(uint64_t value) {
+        if (value < kSubBuckets) return static_cast<size_t>(value);
+        int shift = std::bit_width(value) - 1 - kSubBucketBits;
+        return (static_cast<size_t>(shift + 1) << kSubBucketBits) + static_cast<size_t>((value >> shift) - kSubBuckets);
+    }
+    
+    static uint64_t BucketLowerBound(size_t index);
+    static uint64_t BucketUpperBound(size_t index);
+    
+    void Record(uint64_t value) { RecordCount(value, 1); }
+    void RecordCount(uint64_t value, uint64_t count);
+    
+    void Merge(const HdrHistogram& other);
+    
+    // Removes an earlier cumulative state of the same series, leaving the
+    // values recorded since. Min and max are narrowed to bucket bounds.
+    void Subtract(const HdrHistogram& earlier);
+    
+    void Reset();
+    
+    // Highest value equivalent to the given percentile (0-100), capped at
+    // the exact maximum. 0 when empty.
+    uint64_t ValueAtPercentile(double percentile) const;
+    
+    uint64_t GetCount() const { return m_count; }
+    uint64_t GetMin() const { return m_count ? m_min : 0; }
+    uint64_t GetMax() const { return m_max; }
+    double GetMean() const;
+    
+    uint64_t GetBucketCount(size_t index) const { return m_counts[index]; }
+    
+    // Compact form: non-empty buckets as varint (index gap, count) pairs
+    // behind a small header, typically a few hundred bytes.
+    void Serialize(std::vector<uint8_t>& out) const;
+    bool Deserialize(std::span<const uint8_t> data);
+    
+private:
+    friend class SharedHistogram;
+    
+    std::array<uint64_t, kBucketCount> m_counts{};
+    uint64_t m_count = 0;
+    uint64_t m_min = UINT64_MAX;
+    uint64_t m_max = 0;
+    double m_sum = 0.0;
+};
+
+// HdrHistogram that any number of threads record into without locks. Each
+// recording thread writes its own shard, found through a small thread-local
+// cache, so Record is a handful of uncontended relaxed stores. Readers merge
+// the shards; a snapshot taken while threads record is consistent per
+// bucket, not across buckets.
+class SharedHistogram {
+public:
+    SharedHistogram();
+    ~SharedHistogram();
+    
+    SharedHistogram(const SharedHistogram&) = delete;
+    SharedHistogram& operator=(const SharedHistogram&) = delete;
+    
+    void Record(uint64_t value) {
+        Shard* shard = LocalShard();
+        auto bump = [](std::atomic<uint64_t>& counter, uint64_t by) {
+            counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+        };
+        bump(shard->counts[HdrHistogram::BucketIndex(value)], 1);
+        bump(shard->sum, value);
+        if (value > shard->max.load(std::memory_order_relaxed)) shard->max.store(value, std::memory_order_relaxed);
+        if (value < shard->min.load(std::memory_order_relaxed)) shard->min.store(value, std::memory_order_relaxed);
+    }
+    
+    // Everything recorded so far, merged across threads.
+    void Snapshot(HdrHistogram& out) const;
+    
+    // Values recorded since the previous call; `previous` holds the last
+    // cumulative snapshot and is updated. For a single periodic reader.
+    void SnapshotInterval(HdrHistogram& previous, HdrHistogram& interval) const;
+    
+private:
+    struct Shard {
+        std::array<std::atomic<uint64_t>, HdrHistogram::kBucketCount> counts{};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> min{UINT64_MAX};
+        std::atomic<uint64_t> max{0};
+        std::thread::id owner;
+        Shard* next = nullptr;
+    };
+    
+    // Recently used shards of the calling thread, keyed by histogram id.
+    // Ids are never reused, so entries of destroyed histograms never match.
+    struct ShardCache {
+        static constexpr size_t kEntries = 4;
+        std::array<uint64_t, kEntries> ids{};
+        std::array<Shard*, kEntries> shards{};
+        size_t next = 0;
+    };
+    
+    Shard* LocalShard() {
+        for (size_t i = 0; i < ShardCache::kEntries; i++) {
+            if (t_cache.ids[i] == m_id) return t_cache.shards[i];
+        }
+        return AttachShard();
+    }
+    
+    Shard* AttachShard();
+    
+    static thread_local ShardCache t_cache;
+    
+    const uint64_t m_id;
+    std::atomic<Shard*> m_shards{nullptr};
+};
+
+inline thread_local SharedHistogram::ShardCache SharedHistogram::t_cache;
+
+}
@@ -0,0 +1,125 @@
+#include "latency_probe.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+namespace {
+
+constexpr std::chrono::microseconds kMinPeriod{100};
+constexpr std::chrono::microseconds kMaxPeriod{1000000};
+
+void StoreMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+}
+
+LatencyProbe::~LatencyProbe() {
+    Stop();
+}
+
+bool LatencyProbe::Start(const LatencyProbeConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        spdlog::error("Latency probe is already running");
+        return false;
+    }
+    
+    m_config = config;
+    m_config.period = std::clamp(config.period, kMinPeriod, kMaxPeriod);
+    if (m_config.cpus.empty()) {
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+            m_config.cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    
+    m_probes.clear();
+    m_running = true;
+    for (int cpu : m_config.cpus) {
+        auto probe = std::make_unique<CpuProbe>();
+        probe->cpu = cpu;
+        probe->thread = std::thread(&LatencyProbe::ProbeThread, this, std::ref(*probe));
+        m_probes.push_back(std::move(probe));
+    }
+    
+    spdlog::info("Latency probe started on {} CPUs, {} us period", m_probes.size(), m_config.period.count());
+    return true;
+}
+
+void LatencyProbe::Stop() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) return;
+    
+    // Threads notice within one period; no wakeup is needed.
+    m_running = false;
+    for (auto& probe : m_probes) {
+        if (probe->thread.joinable()) probe->thread.join();
+    }
+    m_probes.clear();
+    
+    spdlog::info("Latency probe stopped");
+}
+
+void LatencyProbe::ProbeThread(CpuProbe& probe) {
+    auto timer = CreateProbeTimer();
+    if (!timer->Prepare(probe.cpu, m_config)) {
+        probe.failed = true;
+        return;
+    }
+    
+    const int64_t period = std::chrono::duration_cast<std::chrono::nanoseconds>(m_config.period).count();
+    int64_t deadline = timer->Now() + period;
+    
+    while (m_running.load(std::memory_order_relaxed)) {
+        int64_t woke = timer->SleepUntil(deadline);
+        uint64_t overshoot = static_cast<uint64_t>(std::max<int64_t>(0, woke - deadline));
+        
+        probe.overshootNs.Record(overshoot);
+        StoreMax(probe.intervalMaxNs, overshoot);
+        StoreMax(probe.peakNs, overshoot);
+        
+        // A wakeup later than the next deadline skips the periods it
+        // overran instead of firing them back to back.
+        deadline += period;
+        if (woke >= deadline) {
+            int64_t skipped = (woke - deadline) / period + 1;
+            probe.missedDeadlines.fetch_add(static_cast<uint64_t>(skipped), std::memory_order_relaxed);
+            deadline += skipped * period;
+        }
+    }
+}
+
+void LatencyProbe::Collect(std::vector<LatencyStats>& stats) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    size_t count = 0;
+    for (auto& probe : m_probes) {
+        if (probe->failed) continue;
+        
+        if (count == stats.size()) stats.emplace_back();
+        LatencyStats& entry = stats[count++];
+        entry = LatencyStats{};
+        entry.cpu = probe->cpu;
+        
+        uint64_t missed = probe->missedDeadlines.load(std::memory_order_relaxed);
+        entry.missedDeadlines = missed - probe->reportedMissed;
+        probe->reportedMissed = missed;
+        
+        HdrHistogram interval;
+        probe->overshootNs.SnapshotInterval(probe->reported, interval);
+        entry.samples = interval.GetCount();
+        
+        // The histogram bounds its max to a bucket; the exact one is tracked
+        // beside it.
+        entry.maxUs = probe->intervalMaxNs.exchange(0, std::memory_order_relaxed) / 1000.0f;
+        entry.peakUs = probe->peakNs.load(std::memory_order_relaxed) / 1000.0f;
+        entry.p50Us = std::min(interval.ValueAtPercentile(50.0) / 1000.0f, entry.maxUs);
+        entry.p99Us = std::min(interval.ValueAtPercentile(99.0) / 1000.0f, entry.maxUs);
+        entry.p999Us = std::min(interval.ValueAtPercentile(99.9) / 1000.0f, entry.maxUs);
+    }
+    stats.resize(count);
+}
+
+}
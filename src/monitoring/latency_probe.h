@@ -0,0 +1,98 @@
+#pragma once
+#include "monitoring_types.h"
+#include "hdr_histogram.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Monitor {
+
+enum class ProbeClock {
+    Monotonic,
+    Boottime,
+    Realtime
+};
+
+enum class ProbeSchedClass {
+    Normal,
+    Fifo,
+    RoundRobin
+};
+
+struct LatencyProbeConfig {
+    std::vector<int> cpus;                       // empty probes every CPU
+    std::chrono::microseconds period{1000};
+    ProbeClock clock = ProbeClock::Monotonic;
+    ProbeSchedClass schedClass = ProbeSchedClass::Normal;
+    int priority = 50;                           // for Fifo and RoundRobin
+    std::chrono::nanoseconds timerSlack{1};      // 0 keeps the thread default
+};
+
+// Platform half of the probe: pins the calling thread and sleeps until
+// absolute deadlines. One instance per probe thread; implemented next to
+// the collector backends.
+class ProbeTimer {
+public:
+    virtual ~ProbeTimer() = default;
+    
+    // Runs on the probe thread before its first wait. Returns false when the
+    // thread cannot be pinned to `cpu`; a refused scheduling class only warns.
+    virtual bool Prepare(int cpu, const LatencyProbeConfig& config) = 0;
+    
+    // Nanoseconds on the configured clock.
+    virtual int64_t Now() = 0;
+    
+    // Sleeps until `deadlineNs` and returns the time it woke up.
+    virtual int64_t SleepUntil(int64_t deadlineNs) = 0;
+};
+
+std::unique_ptr<ProbeTimer> CreateProbeTimer();
+
+// Timer wakeup-jitter probe. One pinned thread per CPU sleeps on absolute
+// deadlines and records how late each wakeup was, so interrupt, DPC and
+// timer-resolution effects show up as per-CPU latency percentiles.
+class LatencyProbe {
+public:
+    LatencyProbe() = default;
+    ~LatencyProbe();
+    
+    LatencyProbe(const LatencyProbe&) = delete;
+    LatencyProbe& operator=(const LatencyProbe&) = delete;
+    
+    bool Start(const LatencyProbeConfig& config);
+    void Stop();
+    bool IsRunning() const { return m_running; }
+    
+    // Fills one entry per probed CPU with the wakeups since the previous
+    // call. Meant for a single periodic caller.
+    void Collect(std::vector<LatencyStats>& stats);
+    
+private:
+    // The probe thread is the only writer; Collect keeps the previous
+    // cumulative histogram to form intervals.
+    struct CpuProbe {
+        int cpu = -1;
+        std::thread thread;
+        SharedHistogram overshootNs;
+        std::atomic<uint64_t> missedDeadlines{0};
+        std::atomic<uint64_t> intervalMaxNs{0};
+        std::atomic<uint64_t> peakNs{0};
+        std::atomic<bool> failed{false};
+        
+        HdrHistogram reported;
+        uint64_t reportedMissed = 0;
+    };
+    
+    void ProbeThread(CpuProbe& probe);
+    
+    std::mutex m_mutex;
+    LatencyProbeConfig m_config;
+    std::vector<std::unique_ptr<CpuProbe>> m_probes;
+    std::atomic<bool> m_running{false};
+};
+
+}
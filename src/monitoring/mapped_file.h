@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace Monitor {
+
+// A whole file mapped into memory, shared with the page cache so that what
+// one process writes is visible to readers of the same file right away and
+// survives the writer crashing. Implemented next to the collector backends.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    
+    MappedFile(MappedFile&& other) noexcept { Swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+            Swap(other);
+        }
+        return *this;
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Creates `path`, or truncates it, to `size` zero bytes with the disk
+    // space reserved up front, so a full disk fails here rather than on a
+    // later store into the mapping.
+    bool Create(const std::string& path, size_t size);
+    
+    // Maps an existing file as it is; a writable mapping may repair it.
+    bool Open(const std::string& path, bool writable);
+    void Close();
+    
+    bool IsOpen() const { return m_data != nullptr; }
+    uint8_t* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+    
+    // Starts writing a range back to disk without waiting for it.
+    void Flush(size_t offset, size_t length);
+    
+private:
+    void Swap(MappedFile& other) {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_file, other.m_file);
+        std::swap(m_mapping, other.m_mapping);
+    }
+    
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    intptr_t m_file = -1;      // descriptor or file HANDLE
+    intptr_t m_mapping = 0;    // mapping HANDLE where the platform has one
+};
+
+}
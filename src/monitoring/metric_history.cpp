@@ -0,0 +1,473 @@
+#include "metric_history.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+namespace {
+
+struct RollupSpec {
+    std::chrono::seconds bucket;
+    std::chrono::seconds retention;
+};
+
+constexpr RollupSpec kRollupSpecs[] = {
+    {std::chrono::seconds(1), std::chrono::hours(1)},
+    {std::chrono::seconds(10), std::chrono::hours(6)},
+    {std::chrono::minutes(1), std::chrono::hours(24)},
+    {std::chrono::minutes(10), std::chrono::hours(24 * 7)},
+};
+
+static_assert(std::size(kRollupSpecs) == static_cast<size_t>(RollupLevel::Count));
+
+// The newest `rows` entries of a ring column ending at head, oldest first.
+template <typename T>
+RingSpan<T> SliceRing(const T* column, size_t capacity, uint64_t head, size_t rows) {
+    RingSpan<T> view;
+    if (rows == 0) return view;
+    
+    size_t end = static_cast<size_t>(head % capacity);
+    if (end == 0) end = capacity;
+    
+    if (rows <= end) {
+        view.first = std::span<const T>(column + end - rows, rows);
+    } else {
+        size_t wrapped = rows - end;
+        view.first = std::span<const T>(column + capacity - wrapped, wrapped);
+        view.second = std::span<const T>(column, end);
+    }
+    
+    return view;
+}
+
+// Number of trailing entries of a monotonic ring at or after sinceUs.
+size_t CountSince(const RingSpan<int64_t>& timestamps, int64_t sinceUs) {
+    size_t skip = 0;
+    if (!timestamps.first.empty() && timestamps.first.back() < sinceUs) {
+        skip = timestamps.first.size() + static_cast<size_t>(
+            std::lower_bound(timestamps.second.begin(), timestamps.second.end(), sinceUs) - timestamps.second.begin());
+    } else {
+        skip = static_cast<size_t>(
+            std::lower_bound(timestamps.first.begin(), timestamps.first.end(), sinceUs) - timestamps.first.begin());
+    }
+    return timestamps.size() - skip;
+}
+
+}
+
+RollupTier::RollupTier(int64_t bucketUs, size_t capacity, size_t columns)
+    : m_bucketUs(bucketUs),
+      m_capacity(std::max(capacity, kGuardBuckets * 2)),
+      m_columnCount(columns),
+      m_starts(new int64_t[m_capacity]()),
+      m_counts(new uint32_t[m_capacity]()),
+      m_values(new float[m_capacity * columns * StatCount]()),
+      m_openMin(columns), m_openMax(columns), m_openLast(columns), m_openSum(columns),
+      m_closedMin(columns), m_closedMax(columns), m_closedLast(columns), m_closedSum(columns) {}
+
+size_t RollupTier::GetMemoryBytes() const {
+    return m_capacity * (sizeof(int64_t) + sizeof(uint32_t) + sizeof(float) * m_columnCount * StatCount);
+}
+
+bool RollupTier::Add(int64_t timestampUs, uint32_t count, const float* mins, const float* maxs,
+                     const double* sums, const float* lasts) {
+    int64_t bucketStart = timestampUs - timestampUs % m_bucketUs;
+    bool closed = false;
+    
+    if (m_openCount > 0 && bucketStart != m_openStartUs) {
+        Close();
+        closed = true;
+    }
+    
+    if (m_openCount == 0) {
+        m_openStartUs = bucketStart;
+        std::fill(m_openMin.begin(), m_openMin.end(), std::numeric_limits<float>::infinity());
+        std::fill(m_openMax.begin(), m_openMax.end(), -std::numeric_limits<float>::infinity());
+        std::fill(m_openSum.begin(), m_openSum.end(), 0.0);
+    }
+    
+    // fmin/fmax skip NaN gaps; the sum (and so the average) keeps them.
+    for (size_t c = 0; c < m_columnCount; c++) {
+        m_openMin[c] = std::fmin(m_openMin[c], mins[c]);
+        m_openMax[c] = std::fmax(m_openMax[c], maxs[c]);
+        m_openSum[c] += sums[c];
+        m_openLast[c] = lasts[c];
+    }
+    m_openCount += count;
+    
+    return closed;
+}
+
+void RollupTier::Close() {
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    size_t row = static_cast<size_t>(head % m_capacity);
+    
+    m_starts[row] = m_openStartUs;
+    m_counts[row] = m_openCount;
+    
+    for (size_t c = 0; c < m_columnCount; c++) {
+        m_values[(Min * m_columnCount + c) * m_capacity + row] = m_openMin[c];
+        m_values[(Max * m_columnCount + c) * m_capacity + row] = m_openMax[c];
+        m_values[(Avg * m_columnCount + c) * m_capacity + row] = static_cast<float>(m_openSum[c] / m_openCount);
+        m_values[(Last * m_columnCount + c) * m_capacity + row] = m_openLast[c];
+    }
+    
+    m_head.store(head + 1, std::memory_order_release);
+    
+    m_closedStartUs = m_openStartUs;
+    m_closedCount = m_openCount;
+    m_closedMin.swap(m_openMin);
+    m_closedMax.swap(m_openMax);
+    m_closedSum.swap(m_openSum);
+    m_closedLast.swap(m_openLast);
+    m_openCount = 0;
+}
+
+RollupView RollupTier::Read(size_t column, int64_t sinceUs) const {
+    RollupView view;
+    if (column >= m_columnCount) return view;
+    
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    size_t available = static_cast<size_t>(std::min<uint64_t>(head, m_capacity - kGuardBuckets));
+    size_t rows = CountSince(SliceRing(m_starts.get(), m_capacity, head, available), sinceUs);
+    
+    auto stat = [&](Stat s) {
+        return SliceRing(m_values.get() + (s * m_columnCount + column) * m_capacity, m_capacity, head, rows);
+    };
+    
+    view.bucketStartUs = SliceRing(m_starts.get(), m_capacity, head, rows);
+    view.counts = SliceRing(m_counts.get(), m_capacity, head, rows);
+    view.min = stat(Min);
+    view.max = stat(Max);
+    view.avg = stat(Avg);
+    view.last = stat(Last);
+    return view;
+}
+
+SeriesTable::SeriesTable(std::string name, std::vector<std::string> columns, size_t capacity)
+    : m_name(std::move(name)),
+      m_columns(std::move(columns)),
+      m_capacity(std::max(capacity, kGuardRows * 2)),
+      m_timestamps(new int64_t[m_capacity]()),
+      m_values(new float[m_capacity * m_columns.size()]()) {}
+
+size_t SeriesTable::GetMemoryBytes() const {
+    return m_capacity * (sizeof(int64_t) + sizeof(float) * m_columns.size());
+}
+
+int SeriesTable::FindColumn(const std::string& column) const {
+    auto it = std::find(m_columns.begin(), m_columns.end(), column);
+    return it == m_columns.end() ? -1 : static_cast<int>(it - m_columns.begin());
+}
+
+void SeriesTable::Append(int64_t timestampUs, std::span<const float> values) {
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    size_t row = static_cast<size_t>(head % m_capacity);
+    size_t count = std::min(values.size(), m_columns.size());
+    
+    m_timestamps[row] = timestampUs;
+    for (size_t c = 0; c < count; c++) {
+        m_values[c * m_capacity + row] = values[c];
+    }
+    
+    m_head.store(head + 1, std::memory_order_release);
+    
+    if (!m_rollups.empty()) {
+        for (size_t c = 0; c < count; c++) {
+            m_rowSums[c] = values[c];
+        }
+        
+        // A raw row is its own min, max, sum and last; each closed bucket
+        // cascades into the next coarser tier.
+        bool closed = m_rollups[0]->Add(timestampUs, 1, values.data(), values.data(), m_rowSums.data(), values.data());
+        for (size_t level = 1; closed && level < m_rollups.size(); level++) {
+            const RollupTier& finer = *m_rollups[level - 1];
+            closed = m_rollups[level]->Add(finer.GetClosedStartUs(), finer.GetClosedCount(),
+                                           finer.GetClosedMin(), finer.GetClosedMax(),
+                                           finer.GetClosedSum(), finer.GetClosedLast());
+        }
+    }
+    
+    if (m_builder) {
+        m_builder->Append(timestampUs, values);
+        
+        if (m_builder->GetRowCount() >= m_rowsPerBlock) {
+            auto block = std::make_shared<const CompressedBlock>(m_builder->Seal());
+            size_t added = block->GetMemoryBytes();
+            size_t removed = 0;
+            
+            std::lock_guard<std::mutex> lock(m_archiveMutex);
+            m_archive.push_back(block);
+            m_lastArchivedUs = block->lastTimestampUs;
+            m_archivedRows.fetch_add(block->rowCount, std::memory_order_relaxed);
+            
+            auto dropOldest = [&] {
+                removed += m_archive.front()->GetMemoryBytes();
+                m_archivedRows.fetch_sub(m_archive.front()->rowCount, std::memory_order_relaxed);
+                m_archive.pop_front();
+            };
+            while (!m_archive.empty() && m_archive.front()->lastTimestampUs < timestampUs - m_retentionUs) {
+                dropOldest();
+            }
+            
+            // Over the shared cap, this table gives up its own oldest blocks
+            // but keeps the one just sealed.
+            if (m_archiveBudget) {
+                size_t expired = removed;
+                size_t used = m_archiveBudget->usedBytes.fetch_add(added, std::memory_order_relaxed) + added - expired;
+                while (m_archive.size() > 1 && used > m_archiveBudget->limitBytes) {
+                    size_t before = removed;
+                    dropOldest();
+                    used -= removed - before;
+                }
+                m_archiveBudget->usedBytes.fetch_sub(removed, std::memory_order_relaxed);
+                
+                if (removed > expired && !m_archiveCutLogged) {
+                    spdlog::warn("Archive budget of {} MB reached; history table '{}' keeps {:.1f} h of {:.1f} h",
+                                 m_archiveBudget->limitBytes / (1024 * 1024), m_name,
+                                 (timestampUs - m_archive.front()->firstTimestampUs) / 3.6e9, m_retentionUs / 3.6e9);
+                    m_archiveCutLogged = true;
+                }
+            }
+            
+            m_archiveBytes.store(m_archiveBytes.load(std::memory_order_relaxed) + added - removed,
+                                 std::memory_order_relaxed);
+        }
+    }
+}
+
+void SeriesTable::EnableArchive(std::chrono::seconds retention, ArchiveBudget* budget, uint32_t rowsPerBlock) {
+    if (m_head.load() != 0) {
+        spdlog::error("Archive for history table '{}' must be enabled before the first sample", m_name);
+        return;
+    }
+    
+    // The open block is served from the raw ring, so it must fit there.
+    m_rowsPerBlock = std::min<uint32_t>(rowsPerBlock, static_cast<uint32_t>(m_capacity - kGuardRows));
+    m_retentionUs = std::chrono::duration_cast<std::chrono::microseconds>(retention).count();
+    m_archiveBudget = budget;
+    m_builder = std::make_unique<BlockBuilder>(m_columns.size());
+}
+
+void SeriesTable::EnableRollups(size_t maxBytes) {
+    if (m_head.load() != 0) {
+        spdlog::error("Rollups for history table '{}' must be enabled before the first sample", m_name);
+        return;
+    }
+    
+    // Start, count and four statistics per metric for every bucket.
+    size_t bucketBytes = sizeof(int64_t) + sizeof(uint32_t) + sizeof(float) * 4 * m_columns.size();
+    size_t fullBuckets = 0;
+    for (const auto& spec : kRollupSpecs) {
+        fullBuckets += static_cast<size_t>(spec.retention / spec.bucket) + RollupTier::kGuardBuckets;
+    }
+    
+    double scale = 1.0;
+    if (fullBuckets * bucketBytes > maxBytes) {
+        scale = static_cast<double>(maxBytes) / static_cast<double>(fullBuckets * bucketBytes);
+        spdlog::warn("Rollups for history table '{}' need {} KB, only {} KB of budget left; keeping {:.0f}% of "
+                     "their retention", m_name, fullBuckets * bucketBytes / 1024, maxBytes / 1024, scale * 100.0);
+    }
+    
+    m_rollups.clear();
+    for (const auto& spec : kRollupSpecs) {
+        int64_t bucketUs = std::chrono::duration_cast<std::chrono::microseconds>(spec.bucket).count();
+        size_t buckets = static_cast<size_t>(static_cast<double>(spec.retention / spec.bucket) * scale);
+        m_rollups.push_back(std::make_unique<RollupTier>(bucketUs, buckets + RollupTier::kGuardBuckets,
+                                                         m_columns.size()));
+    }
+    m_rowSums.assign(m_columns.size(), 0.0);
+}
+
+RollupView SeriesTable::ReadRollup(size_t column, RollupLevel level, int64_t sinceUs) const {
+    size_t index = static_cast<size_t>(level);
+    if (index >= m_rollups.size()) return {};
+    return m_rollups[index]->Read(column, sinceUs);
+}
+
+size_t SeriesTable::GetRollupBytes() const {
+    size_t bytes = 0;
+    for (const auto& tier : m_rollups) {
+        bytes += tier->GetMemoryBytes();
+    }
+    return bytes;
+}
+
+RollupLevel SeriesTable::SelectRollupLevel(int64_t spanUs, size_t maxPoints) {
+    for (size_t level = 0; level < std::size(kRollupSpecs); level++) {
+        int64_t bucketUs = std::chrono::duration_cast<std::chrono::microseconds>(kRollupSpecs[level].bucket).count();
+        if (spanUs / bucketUs <= static_cast<int64_t>(maxPoints)) {
+            return static_cast<RollupLevel>(level);
+        }
+    }
+    return RollupLevel::TenMinutes;
+}
+
+void SeriesTable::ReadArchive(size_t column, int64_t sinceUs,
+                              std::vector<int64_t>& timestampsUs, std::vector<float>& values) const {
+    if (column >= m_columns.size()) return;
+    
+    std::vector<std::shared_ptr<const CompressedBlock>> blocks;
+    int64_t lastArchivedUs;
+    {
+        std::lock_guard<std::mutex> lock(m_archiveMutex);
+        for (const auto& block : m_archive) {
+            if (block->lastTimestampUs >= sinceUs) blocks.push_back(block);
+        }
+        lastArchivedUs = m_lastArchivedUs;
+    }
+    
+    for (const auto& block : blocks) {
+        block->DecodeColumn(column, sinceUs, timestampsUs, values);
+    }
+    
+    SeriesView recent = ReadSince(column, std::max(sinceUs, lastArchivedUs + 1));
+    for (size_t i = 0; i < recent.values.size(); i++) {
+        timestampsUs.push_back(recent.timestampsUs[i]);
+        values.push_back(recent.values[i]);
+    }
+}
+
+RingSpan<int64_t> SeriesTable::ReadTimestamps(size_t maxRows) const {
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    size_t available = static_cast<size_t>(std::min<uint64_t>(head, m_capacity - kGuardRows));
+    return SliceRing(m_timestamps.get(), m_capacity, head, std::min(maxRows, available));
+}
+
+SeriesView SeriesTable::Read(size_t column, size_t maxRows) const {
+    SeriesView view;
+    if (column >= m_columns.size()) return view;
+    
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    size_t rows = std::min(maxRows, static_cast<size_t>(std::min<uint64_t>(head, m_capacity - kGuardRows)));
+    
+    view.timestampsUs = SliceRing(m_timestamps.get(), m_capacity, head, rows);
+    view.values = SliceRing(m_values.get() + column * m_capacity, m_capacity, head, rows);
+    return view;
+}
+
+SeriesView SeriesTable::ReadSince(size_t column, int64_t sinceUs) const {
+    SeriesView view;
+    if (column >= m_columns.size()) return view;
+    
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    size_t available = static_cast<size_t>(std::min<uint64_t>(head, m_capacity - kGuardRows));
+    size_t rows = CountSince(SliceRing(m_timestamps.get(), m_capacity, head, available), sinceUs);
+    
+    view.timestampsUs = SliceRing(m_timestamps.get(), m_capacity, head, rows);
+    view.values = SliceRing(m_values.get() + column * m_capacity, m_capacity, head, rows);
+    return view;
+}
+
+MetricHistory::MetricHistory(size_t budgetBytes)
+    : m_budgetBytes(budgetBytes) {}
+
+SeriesTable& MetricHistory::AddTable(const std::string& name, std::vector<std::string> columns, size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_tablesMutex);
+    
+    for (auto& table : m_tables) {
+        if (table->GetName() == name) return *table;
+    }
+    return AddTableLocked(name, std::move(columns), capacity);
+}
+
+SeriesTable& MetricHistory::AddTableGeneration(const std::string& name, std::vector<std::string> columns,
+                                               size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_tablesMutex);
+    return AddTableLocked(name, std::move(columns), capacity);
+}
+
+SeriesTable& MetricHistory::AddTableLocked(const std::string& name, std::vector<std::string> columns,
+                                           size_t capacity) {
+    size_t rowBytes = sizeof(int64_t) + sizeof(float) * columns.size();
+    size_t remaining = m_budgetBytes > m_usedBytes ? m_budgetBytes - m_usedBytes : 0;
+    if (capacity * rowBytes > remaining) {
+        size_t reduced = remaining / rowBytes;
+        spdlog::warn("History table '{}' needs {} KB, only {} KB of budget left; keeping {} of {} rows",
+                     name, capacity * rowBytes / 1024, remaining / 1024, reduced, capacity);
+        capacity = reduced;
+    }
+    
+    m_tables.push_back(std::make_unique<SeriesTable>(name, std::move(columns), capacity));
+    SeriesTable& table = *m_tables.back();
+    m_usedBytes += table.GetMemoryBytes();
+    
+    if (m_archiveRetention.count() > 0) {
+        table.EnableArchive(m_archiveRetention, &m_archiveBudget);
+    }
+    if (m_rollupsEnabled) {
+        // Half of what is left at most, so tables added later still get a
+        // ring of their own.
+        table.EnableRollups(m_budgetBytes > m_usedBytes ? (m_budgetBytes - m_usedBytes) / 2 : 0);
+        m_usedBytes += table.GetRollupBytes();
+    }
+    return table;
+}
+
+const SeriesTable* MetricHistory::FindTable(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_tablesMutex);
+    
+    // Newest generation first.
+    for (auto it = m_tables.rbegin(); it != m_tables.rend(); ++it) {
+        if ((*it)->GetName() == name) return it->get();
+    }
+    return nullptr;
+}
+
+std::vector<std::string> MetricHistory::GetTableNames() const {
+    std::lock_guard<std::mutex> lock(m_tablesMutex);
+    
+    std::vector<std::string> names;
+    for (auto& table : m_tables) {
+        if (std::find(names.begin(), names.end(), table->GetName()) == names.end()) names.push_back(table->GetName());
+    }
+    return names;
+}
+
+MetricRef MetricHistory::Find(const std::string& metric) const {
+    auto dot = metric.find('.');
+    if (dot == std::string::npos) return {};
+    
+    const SeriesTable* table = FindTable(metric.substr(0, dot));
+    if (!table) return {};
+    
+    int column = table->FindColumn(metric.substr(dot + 1));
+    if (column < 0) return {};
+    
+    return {table, static_cast<size_t>(column)};
+}
+
+size_t MetricHistory::GetMemoryBytes() const {
+    std::lock_guard<std::mutex> lock(m_tablesMutex);
+    return m_usedBytes;
+}
+
+size_t MetricHistory::GetArchiveBytes() const {
+    std::lock_guard<std::mutex> lock(m_tablesMutex);
+    
+    size_t bytes = 0;
+    for (auto& table : m_tables) {
+        bytes += table->GetArchiveBytes();
+    }
+    return bytes;
+}
+
+size_t MetricHistory::GetRollupBytes() const {
+    std::lock_guard<std::mutex> lock(m_tablesMutex);
+    
+    size_t bytes = 0;
+    for (auto& table : m_tables) {
+        bytes += table->GetRollupBytes();
+    }
+    return bytes;
+}
+
+int64_t MetricHistory::NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
@@ -0,0 +1,281 @@
+#pragma once
+#include "gorilla_codec.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Monitor {
+
+// Oldest-to-newest view over a ring column. A wrapped ring yields two
+// contiguous spans; neither is a copy.
+template <typename T>
+struct RingSpan {
+    std::span<const T> first;
+    std::span<const T> second;
+    
+    size_t size() const { return first.size() + second.size(); }
+    bool empty() const { return size() == 0; }
+    
+    T operator[](size_t i) const {
+        return i < first.size() ? first[i] : second[i - first.size()];
+    }
+    
+    T back() const { return second.empty() ? first.back() : second.back(); }
+    
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (const T& value : first) fn(value);
+        for (const T& value : second) fn(value);
+    }
+};
+
+struct SeriesView {
+    RingSpan<int64_t> timestampsUs;
+    RingSpan<float> values;
+};
+
+enum class RollupLevel {
+    Second,
+    TenSeconds,
+    Minute,
+    TenMinutes,
+    Count
+};
+
+struct RollupView {
+    RingSpan<int64_t> bucketStartUs;
+    RingSpan<uint32_t> counts;
+    RingSpan<float> min;
+    RingSpan<float> max;
+    RingSpan<float> avg;
+    RingSpan<float> last;
+};
+
+// One resolution of min/max/avg/last aggregates, laid out like SeriesTable
+// (shared bucket-start and count columns, one ring per statistic and
+// metric). Buckets are aligned to multiples of the bucket width so coarser
+// tiers nest exactly; a bucket is published when the first sample of the
+// next bucket arrives, and its totals then cascade into the next tier.
+class RollupTier {
+public:
+    static constexpr size_t kGuardBuckets = 2;
+    
+    RollupTier(int64_t bucketUs, size_t capacity, size_t columns);
+    
+    int64_t GetBucketUs() const { return m_bucketUs; }
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetMemoryBytes() const;
+    
+    // Writer side. Folds one raw row (count 1) or one closed finer bucket
+    // into the open bucket; returns true when that closed the previous
+    // bucket, whose totals are then in the Closed* accessors.
+    bool Add(int64_t timestampUs, uint32_t count, const float* mins, const float* maxs,
+             const double* sums, const float* lasts);
+    
+    int64_t GetClosedStartUs() const { return m_closedStartUs; }
+    uint32_t GetClosedCount() const { return m_closedCount; }
+    const float* GetClosedMin() const { return m_closedMin.data(); }
+    const float* GetClosedMax() const { return m_closedMax.data(); }
+    const double* GetClosedSum() const { return m_closedSum.data(); }
+    const float* GetClosedLast() const { return m_closedLast.data(); }
+    
+    RollupView Read(size_t column, int64_t sinceUs) const;
+    
+private:
+    enum Stat { Min, Max, Avg, Last, StatCount };
+    
+    void Close();
+    
+    int64_t m_bucketUs;
+    size_t m_capacity;
+    size_t m_columnCount;
+    
+    std::unique_ptr<int64_t[]> m_starts;
+    std::unique_ptr<uint32_t[]> m_counts;
+    std::unique_ptr<float[]> m_values;
+    std::atomic<uint64_t> m_head{0};
+    
+    int64_t m_openStartUs = 0;
+    uint32_t m_openCount = 0;
+    std::vector<float> m_openMin, m_openMax, m_openLast;
+    std::vector<double> m_openSum;
+    
+    int64_t m_closedStartUs = 0;
+    uint32_t m_closedCount = 0;
+    std::vector<float> m_closedMin, m_closedMax, m_closedLast;
+    std::vector<double> m_closedSum;
+};
+
+// Byte cap shared by the compressed archives of several tables. A table
+// that seals a block while the total is over drops its own oldest blocks.
+struct ArchiveBudget {
+    size_t limitBytes = 0;
+    std::atomic<size_t> usedBytes{0};
+};
+
+// Fixed-capacity, struct-of-arrays ring for metrics that are sampled
+// together: one shared timestamp column plus one contiguous float column per
+// metric. Single writer (the owning collector); any number of readers.
+//
+// Readers get spans straight into the columns. Rows become visible once the
+// writer has released the new head, and a row is only rewritten after the
+// writer laps the ring, so reads are capped at capacity - kGuardRows to
+// leave a grace period for a reader to finish with its view.
+class SeriesTable {
+public:
+    static constexpr size_t kGuardRows = 64;
+    
+    SeriesTable(std::string name, std::vector<std::string> columns, size_t capacity);
+    
+    const std::string& GetName() const { return m_name; }
+    const std::vector<std::string>& GetColumns() const { return m_columns; }
+    size_t GetColumnCount() const { return m_columns.size(); }
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetMemoryBytes() const;
+    
+    int FindColumn(const std::string& column) const;
+    
+    // Writer side. values.size() must equal the column count; missing
+    // values should be NaN.
+    void Append(int64_t timestampUs, std::span<const float> values);
+    
+    uint64_t GetRowCount() const { return m_head.load(std::memory_order_acquire); }
+    
+    RingSpan<int64_t> ReadTimestamps(size_t maxRows) const;
+    SeriesView Read(size_t column, size_t maxRows) const;
+    
+    // Rows whose timestamp is at or after sinceUs.
+    SeriesView ReadSince(size_t column, int64_t sinceUs) const;
+    
+    // Long-term history. Every appended row is also encoded into Gorilla
+    // blocks of rowsPerBlock rows; sealed blocks older than the retention
+    // are dropped, and so are the oldest ones while `budget` is exceeded.
+    // The budget must outlive the table. Must be enabled before the first
+    // Append.
+    void EnableArchive(std::chrono::seconds retention, ArchiveBudget* budget = nullptr,
+                       uint32_t rowsPerBlock = kDefaultRowsPerBlock);
+    size_t GetArchiveBytes() const { return m_archiveBytes.load(std::memory_order_relaxed); }
+    uint64_t GetArchivedRowCount() const { return m_archivedRows.load(std::memory_order_relaxed); }
+    
+    // Decodes archived rows at or after sinceUs, oldest first, followed by
+    // the not-yet-sealed rows from the raw ring. Appends to the outputs.
+    void ReadArchive(size_t column, int64_t sinceUs,
+                     std::vector<int64_t>& timestampsUs, std::vector<float>& values) const;
+    
+    static constexpr uint32_t kDefaultRowsPerBlock = 1024;
+    
+    // Multi-resolution aggregates maintained on every Append: 1 s buckets
+    // for 1 h, 10 s for 6 h, 1 min for 24 h and 10 min for 7 days, each
+    // with min/max/avg/last. Every tier's retention is shortened by the
+    // same factor when that would take more than maxBytes. Must be enabled
+    // before the first Append.
+    void EnableRollups(size_t maxBytes = std::numeric_limits<size_t>::max());
+    RollupView ReadRollup(size_t column, RollupLevel level, int64_t sinceUs) const;
+    size_t GetRollupBytes() const;
+    
+    // Finest level that covers spanUs in at most maxPoints buckets.
+    static RollupLevel SelectRollupLevel(int64_t spanUs, size_t maxPoints);
+    
+private:    
+    std::string m_name;
+    std::vector<std::string> m_columns;
+    size_t m_capacity;
+    
+    std::unique_ptr<int64_t[]> m_timestamps;
+    std::unique_ptr<float[]> m_values;
+    std::atomic<uint64_t> m_head{0};
+    
+    std::unique_ptr<BlockBuilder> m_builder;
+    uint32_t m_rowsPerBlock = kDefaultRowsPerBlock;
+    int64_t m_retentionUs = 0;
+    ArchiveBudget* m_archiveBudget = nullptr;
+    bool m_archiveCutLogged = false;
+    
+    mutable std::mutex m_archiveMutex;
+    std::deque<std::shared_ptr<const CompressedBlock>> m_archive;
+    int64_t m_lastArchivedUs = std::numeric_limits<int64_t>::min();
+    std::atomic<size_t> m_archiveBytes{0};
+    std::atomic<uint64_t> m_archivedRows{0};
+    
+    std::vector<std::unique_ptr<RollupTier>> m_rollups;
+    std::vector<double> m_rowSums;
+};
+
+struct MetricRef {
+    const SeriesTable* table = nullptr;
+    size_t column = 0;
+    
+    explicit operator bool() const { return table != nullptr; }
+    SeriesView Read(size_t maxRows) const { return table->Read(column, maxRows); }
+    SeriesView ReadSince(int64_t sinceUs) const { return table->ReadSince(column, sinceUs); }
+    RollupView ReadRollup(RollupLevel level, int64_t sinceUs) const { return table->ReadRollup(column, level, sinceUs); }
+};
+
+// Central history for every engine metric, one SeriesTable per collector.
+// Tables live as long as the store, so resolved MetricRefs stay valid; a
+// newer generation of a table takes over its name for later lookups.
+//
+// Memory budget: a table costs capacity * (8 + 4 * columns) bytes. The
+// default 256 MB budget fits the worst case we plan for: 256 cores x 5
+// metrics x 1 h at 100 ms = 36,000 rows x 1,280 columns = ~184 MB of floats
+// plus 288 KB of timestamps. A 16-core desktop uses ~12 MB. Tables that
+// would exceed the remaining budget get a shorter ring instead. Rollup
+// tiers are charged to the same budget after the ring, ~131 KB per metric
+// at full retention (~8.5 MB for a 16-core CPU table), and keep a shorter
+// retention when that is more than half of what is left. The compressed
+// archive has a cap of its own, 128 MB by default and shared by all tables
+// (GetArchiveBytes); 24 h of the 256-core table would otherwise reach ~1 GB.
+class MetricHistory {
+public:
+    static constexpr size_t kDefaultBudgetBytes = 256ull * 1024 * 1024;
+    static constexpr size_t kDefaultArchiveBudgetBytes = 128ull * 1024 * 1024;
+    
+    explicit MetricHistory(size_t budgetBytes = kDefaultBudgetBytes);
+    
+    // Compressed retention applied to tables added after the call; zero
+    // disables the archive. Defaults to 24 hours, cut short for the oldest
+    // blocks once all archives together exceed the archive budget.
+    void SetArchiveRetention(std::chrono::seconds retention) { m_archiveRetention = retention; }
+    void SetArchiveBudget(size_t bytes) { m_archiveBudget.limitBytes = bytes; }
+    void SetRollupsEnabled(bool enabled) { m_rollupsEnabled = enabled; }
+    
+    SeriesTable& AddTable(const std::string& name, std::vector<std::string> columns, size_t capacity);
+    
+    // Adds a table under the name of an existing one, for when its columns
+    // change; FindTable and Find return the newest generation.
+    SeriesTable& AddTableGeneration(const std::string& name, std::vector<std::string> columns, size_t capacity);
+    const SeriesTable* FindTable(const std::string& name) const;
+    std::vector<std::string> GetTableNames() const;
+    
+    // Metric names are "<table>.<column>", e.g. "cpu.core3.usage".
+    MetricRef Find(const std::string& metric) const;
+    
+    // Raw rings and rollup tiers, as charged to the budget.
+    size_t GetMemoryBytes() const;
+    size_t GetArchiveBytes() const;
+    size_t GetRollupBytes() const;
+    size_t GetBudgetBytes() const { return m_budgetBytes; }
+    
+    static int64_t NowUs();
+    
+private:
+    SeriesTable& AddTableLocked(const std::string& name, std::vector<std::string> columns, size_t capacity);
+    
+    mutable std::mutex m_tablesMutex;
+    std::vector<std::unique_ptr<SeriesTable>> m_tables;
+    size_t m_budgetBytes;
+    size_t m_usedBytes = 0;
+    std::chrono::seconds m_archiveRetention = std::chrono::hours(24);
+    ArchiveBudget m_archiveBudget{kDefaultArchiveBudgetBytes};
+    bool m_rollupsEnabled = true;
+};
+
+}
@@ -1,18 +1,155 @@
 #include "monitoring_engine.h"
-#include <Windows.h>
-#include <Pdh.h>
-#include <PdhMsg.h>
-
-#undef min
-#undef max
-
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include <spdlog/spdlog.h>
 
-#pragma comment(lib, "pdh.lib")
-
 namespace Monitor {
 
+namespace {
+
+constexpr std::chrono::milliseconds kProcessPeriod{1000};
+constexpr size_t kTopProcessCount = 64;
+constexpr std::chrono::milliseconds kMinPollingRate{100};
+constexpr std::chrono::milliseconds kMaxPollingRate{5000};
+constexpr std::chrono::hours kHistoryWindow{1};
+// A history table is laid out again at most this often and this many times
+// when devices or groups appear, each layout holding its own ring.
+constexpr std::chrono::minutes kHistoryRelayoutInterval{1};
+constexpr int kMaxHistoryGenerations = 8;
+constexpr std::chrono::milliseconds kDiskPeriod{1000};
+constexpr std::chrono::milliseconds kThermalPeriod{1000};
+constexpr std::chrono::milliseconds kPressurePeriod{1000};
+constexpr std::chrono::milliseconds kThreadPeriod{500};
+constexpr std::chrono::milliseconds kLatencyPeriod{1000};
+constexpr std::chrono::milliseconds kNumaPeriod{1000};
+constexpr std::chrono::milliseconds kCgroupPeriod{1000};
+
+// Slices and services are recorded in history; scopes below them come and
+// go with every session and would only leave gaps.
+constexpr int kCgroupHistoryDepth = 2;
+constexpr std::chrono::seconds kProcessMemoryMaxAge{2};
+constexpr std::chrono::milliseconds kProcessMemoryQueryInterval{250};
+
+constexpr const char* kDiskMetrics[] = {
+    "readMBps", "writeMBps", "readIOPS", "writeIOPS", "latencyMs", "queueDepth", "busyPercent", "usagePercent",
+    "temperature"
+};
+
+constexpr const char* kInterfaceMetrics[] = {
+    "downloadMbps", "uploadMbps", "packetsPerSec", "dropsPerSec", "errorsPerSec"
+};
+
+constexpr const char* kLatencyMetrics[] = {"p50Us", "p99Us", "p999Us", "maxUs"};
+
+constexpr const char* kNumaMetrics[] = {
+    "usedGB", "freeGB", "hitsPerSec", "missesPerSec", "foreignPerSec", "remotePerSec"
+};
+
+constexpr const char* kPressureMetrics[] = {
+    "cpu.some", "cpu.full", "memory.some", "memory.full", "io.some", "io.full"
+};
+
+constexpr const char* kCgroupMetrics[] = {
+    "cpuPercent", "throttledPercent", "memoryMB", "ioReadMBps", "ioWriteMBps"
+};
+
+std::string PressureColumnPrefix(const std::string& group) {
+    return group.empty() ? std::string() : group + "/";
+}
+
+void AggregateNetwork(NetworkInfo& network) {
+    network.adapterName = "Default";
+    network.uploadMbps = 0.0f;
+    network.downloadMbps = 0.0f;
+    network.latencyMs = 0.0f;
+    network.packetLoss = 0.0f;
+    network.packetsPerSec = 0.0f;
+    network.dropsPerSec = 0.0f;
+    network.errorsPerSec = 0.0f;
+    
+    float busiest = -1.0f;
+    for (const auto& iface : network.interfaces) {
+        network.uploadMbps += iface.uploadMbps;
+        network.downloadMbps += iface.downloadMbps;
+        network.packetsPerSec += iface.rxPacketsPerSec + iface.txPacketsPerSec;
+        network.dropsPerSec += iface.rxDropsPerSec + iface.txDropsPerSec;
+        network.errorsPerSec += iface.rxErrorsPerSec + iface.txErrorsPerSec;
+        
+        if (iface.uploadMbps + iface.downloadMbps > busiest) {
+            busiest = iface.uploadMbps + iface.downloadMbps;
+            network.adapterName = iface.name;
+        }
+    }
+    
+    float offered = network.packetsPerSec + network.dropsPerSec;
+    network.packetLoss = offered > 0.0f ? 100.0f * network.dropsPerSec / offered : 0.0f;
+}
+
+// Temperatures come from the thermal collector's latest reading. Package
+// sensors cover every CPU of the package; per-core sensors refine them.
+void ApplyCpuTemperatures(std::vector<CPUCoreInfo>& cores, const ThermalInfo& thermal) {
+    auto apply = [&](ThermalSensorKind kind) {
+        for (const auto& sensor : thermal.sensors) {
+            if (sensor.kind != kind) continue;
+            for (int cpu : sensor.cpus) {
+                for (auto& core : cores) {
+                    if (core.coreID == cpu) core.temperature = sensor.temperature;
+                }
+            }
+        }
+    };
+    apply(ThermalSensorKind::CPUPackage);
+    apply(ThermalSensorKind::CPUCore);
+}
+
+void ApplyDiskTemperatures(std::vector<DiskInfo>& disks, const ThermalInfo& thermal) {
+    for (const auto& sensor : thermal.sensors) {
+        if (sensor.kind != ThermalSensorKind::Disk) continue;
+        for (auto& disk : disks) {
+            if (disk.name == sensor.device) disk.temperature = sensor.temperature;
+        }
+    }
+}
+
+void ApplyGpuTemperature(GPUInfo& gpu, const ThermalInfo& thermal) {
+    float hottest = -1.0f;
+    for (const auto& sensor : thermal.sensors) {
+        if (sensor.kind == ThermalSensorKind::GPU) hottest = std::max(hottest, sensor.temperature);
+    }
+    if (hottest >= 0.0f) gpu.temperature = hottest;
+}
+
+constexpr CollectorId kCriticalCollectors[] = {
+    CollectorId::CPU,
+    CollectorId::GPU,
+    CollectorId::RAM,
+    CollectorId::Network
+};
+
+}
+
+void CopyCollectorPart(CollectorId id, const SystemSnapshot& from, SystemSnapshot& to) {
+    switch (id) {
+        case CollectorId::CPU:      to.cpu = from.cpu; break;
+        case CollectorId::GPU:      to.gpu = from.gpu; break;
+        case CollectorId::RAM:      to.ram = from.ram; break;
+        case CollectorId::Disk:     to.disks = from.disks; break;
+        case CollectorId::Network:  to.network = from.network; break;
+        case CollectorId::Process:  to.processes = from.processes; break;
+        case CollectorId::Thermal:  to.thermal = from.thermal; break;
+        case CollectorId::Pressure: to.pressure = from.pressure; break;
+        case CollectorId::Threads:
+            to.threadsPid = from.threadsPid;
+            to.threads = from.threads;
+            break;
+        case CollectorId::Latency:  to.latency = from.latency; break;
+        case CollectorId::Numa:     to.numa = from.numa; break;
+        case CollectorId::Cgroups:  to.cgroups = from.cgroups; break;
+        default: break;
+    }
+}
+
 MonitoringEngine& MonitoringEngine::Get() {
     static MonitoringEngine instance;
     return instance;
@@ -20,6 +157,12 @@ MonitoringEngine& MonitoringEngine::Get() {
 
 MonitoringEngine::MonitoringEngine() {
     m_lastUpdate = std::chrono::steady_clock::now();
+    m_backend = CreateDefaultBackend();
+    RegisterCollectors();
+    
+    for (size_t i = 0; i < m_configuredPeriodMs.size(); i++) {
+        m_configuredPeriodMs[i] = static_cast<int>(m_scheduler.GetPeriod(static_cast<CollectorId>(i)).count());
+    }
 }
 
 MonitoringEngine::~MonitoringEngine() {
@@ -29,210 +172,905 @@ MonitoringEngine::~MonitoringEngine() {
 void MonitoringEngine::Start(int pollingRateMs) {
     if (m_running) return;
     
-    m_pollingRateMs = pollingRateMs;
+    SetPollingRate(pollingRateMs);
     m_running = true;
-    m_thread = std::thread(&MonitoringEngine::MonitoringThread, this);
+    m_feeding = m_backend->StartFeed([this](const SystemSnapshot& snapshot, CollectorMask changed) {
+        ApplyFeed(snapshot, changed);
+    });
+    if (m_feeding) {
+        spdlog::info("Monitoring engine started, fed by {} backend", m_backend->GetName());
+        return;
+    }
+    m_scheduler.Start();
     
-    spdlog::info("Monitoring engine started with polling rate: {}ms", pollingRateMs);
+    spdlog::info("Monitoring engine started with polling rate: {}ms ({} backend)", pollingRateMs, m_backend->GetName());
 }
 
 void MonitoringEngine::Stop() {
     if (!m_running) return;
     
     m_running = false;
-    if (m_thread.joinable()) {
-        m_thread.join();
+    if (m_feeding.exchange(false)) {
+        m_backend->StopFeed();
+    } else {
+        m_scheduler.Stop();
     }
     
     spdlog::info("Monitoring engine stopped");
 }
 
 void MonitoringEngine::SetPollingRate(int ms) {
-    m_pollingRateMs = std::max(100, std::min(5000, ms));
+    m_pollingRateMs = std::clamp(ms, static_cast<int>(kMinPollingRate.count()), static_cast<int>(kMaxPollingRate.count()));
+    
+    {
+        std::lock_guard<std::mutex> lock(m_periodMutex);
+        for (CollectorId id : kCriticalCollectors) {
+            m_configuredPeriodMs[static_cast<size_t>(id)] = m_pollingRateMs;
+        }
+    }
+    ApplyDemand();
+}
+
+void MonitoringEngine::SetCollectorPeriod(CollectorId id, int ms) {
+    {
+        std::lock_guard<std::mutex> lock(m_periodMutex);
+        m_configuredPeriodMs[static_cast<size_t>(id)] = std::max(static_cast<int>(kMinPollingRate.count()), ms);
+    }
+    ApplyDemand();
+}
+
+void MonitoringEngine::SetAdaptiveSampling(bool enabled) {
+    if (m_adaptiveSampling.exchange(enabled) == enabled) return;
+    
+    spdlog::info("Adaptive sampling {}", enabled ? "enabled" : "disabled");
+    ApplyDemand();
+}
+
+// Called with m_periodMutex held.
+void MonitoringEngine::ApplyPeriod(CollectorId id) {
+    size_t index = static_cast<size_t>(id);
+    int base = m_demandPeriodMs[index] > 0 ? m_demandPeriodMs[index] : m_configuredPeriodMs[index];
+    base = std::max(base, static_cast<int>(kMinPollingRate.count()));
+    
+    int period = base;
+    if (m_adaptiveSampling) {
+        int ceiling = std::max(base, static_cast<int>(kMaxPollingRate.count()));
+        period = std::min(base * m_volatility[index].GetBackoff(), ceiling);
+    }
+    
+    if (m_scheduler.GetPeriod(id).count() != period) {
+        m_scheduler.SetPeriod(id, std::chrono::milliseconds(period));
+    }
+}
+
+std::vector<CollectorStats> MonitoringEngine::GetCollectorStats() const {
+    return m_scheduler.GetStats();
+}
+
+void MonitoringEngine::RegisterCollectors() {
+    auto period = std::chrono::milliseconds(m_pollingRateMs.load());
+    
+    m_scheduler.AddCollector(CollectorId::CPU, SchedulerLane::Critical, period,
+                             [this] { UpdateCPUInfo(); PublishSnapshot(CollectorId::CPU); });
+    m_scheduler.AddCollector(CollectorId::GPU, SchedulerLane::Critical, period,
+                             [this] { UpdateGPUInfo(); PublishSnapshot(CollectorId::GPU); });
+    m_scheduler.AddCollector(CollectorId::RAM, SchedulerLane::Critical, period,
+                             [this] { UpdateRAMInfo(); PublishSnapshot(CollectorId::RAM); });
+    m_scheduler.AddCollector(CollectorId::Network, SchedulerLane::Critical, period,
+                             [this] { UpdateNetworkInfo(); PublishSnapshot(CollectorId::Network); });
+    m_scheduler.AddCollector(CollectorId::Process, SchedulerLane::Background, kProcessPeriod,
+                             [this] { UpdateProcessInfo(); PublishSnapshot(CollectorId::Process); });
+    m_scheduler.AddCollector(CollectorId::Disk, SchedulerLane::Background, kDiskPeriod,
+                             [this] { UpdateDiskInfo(); PublishSnapshot(CollectorId::Disk); });
+    m_scheduler.AddCollector(CollectorId::Thermal, SchedulerLane::Background, kThermalPeriod,
+                             [this] { UpdateThermalInfo(); PublishSnapshot(CollectorId::Thermal); });
+    m_scheduler.AddCollector(CollectorId::Pressure, SchedulerLane::Background, kPressurePeriod,
+                             [this] { UpdatePressureInfo(); PublishSnapshot(CollectorId::Pressure); });
+    m_scheduler.AddCollector(CollectorId::Threads, SchedulerLane::Background, kThreadPeriod,
+                             [this] { UpdateThreadInfo(); PublishSnapshot(CollectorId::Threads); });
+    m_scheduler.AddCollector(CollectorId::Latency, SchedulerLane::Background, kLatencyPeriod,
+                             [this] { UpdateLatencyInfo(); PublishSnapshot(CollectorId::Latency); });
+    m_scheduler.AddCollector(CollectorId::Numa, SchedulerLane::Background, kNumaPeriod,
+                             [this] { UpdateNumaInfo(); PublishSnapshot(CollectorId::Numa); });
+    m_scheduler.AddCollector(CollectorId::Cgroups, SchedulerLane::Background, kCgroupPeriod,
+                             [this] { UpdateCgroupInfo(); PublishSnapshot(CollectorId::Cgroups); });
+}
+
+void MonitoringEngine::SetBackend(std::unique_ptr<CollectorBackend> backend) {
+    if (m_running) {
+        spdlog::error("Cannot replace collector backend while monitoring is running");
+        return;
+    }
+    
+    if (!backend) return;
+    
+    m_backend = std::move(backend);
+    {
+        std::lock_guard<std::mutex> lock(m_topologyMutex);
+        m_topology.reset();
+    }
+    m_processTracker.Reset();
+    m_threadTracker.Reset();
+    
+    // Nothing sampled from the previous backend carries over. History
+    // tables live on for the refs resolved into them, but each collector's
+    // next record lays out a new generation from the new backend's sample.
+    {
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        m_staging = SystemSnapshot{};
+    }
+    m_scratch = SystemSnapshot{};
+    {
+        std::lock_guard<std::mutex> lock(m_processMemoryMutex);
+        m_processMemory.clear();
+        m_processNuma.clear();
+    }
+    for (auto& tracker : m_volatility) tracker.Reset();
+    for (auto& layout : m_historyLayouts) {
+        if (layout.table) layout = HistoryLayout{.table = layout.table, .stale = true};
+    }
+    ApplyDemand();
+    
+    spdlog::info("Monitoring backend set to {}", m_backend->GetName());
+}
+
+const char* MonitoringEngine::GetBackendName() const {
+    return m_backend->GetName();
+}
+
+std::vector<std::string> MonitoringEngine::GetCpuIdleStates() const {
+    return m_backend->GetCpuIdleStates();
+}
+
+std::shared_ptr<const CpuTopology> MonitoringEngine::GetTopology() {
+    std::lock_guard<std::mutex> lock(m_topologyMutex);
+    if (m_topology) return m_topology;
+    
+    TopologySource source;
+    if (!m_backend->DiscoverTopology(source)) {
+        spdlog::warn("CPU topology unavailable from {}; assuming one thread per core", m_backend->GetName());
+        source = {};
+    }
+    m_topology = CpuTopology::Build(std::move(source));
+    spdlog::info("CPU topology: {}", m_topology->GetFingerprint());
+    return m_topology;
+}
+
+int MonitoringEngine::Subscribe(CollectorMask groups, SubscriptionHub::Callback callback, std::chrono::milliseconds interval) {
+    int id = m_subscriptions.Subscribe(groups, std::move(callback), interval);
+    ApplyDemand();
+    return id;
+}
+
+int MonitoringEngine::Subscribe(CollectorMask groups, std::chrono::milliseconds interval) {
+    int id = m_subscriptions.Subscribe(groups, interval);
+    ApplyDemand();
+    return id;
+}
+
+void MonitoringEngine::Unsubscribe(int id) {
+    m_subscriptions.Unsubscribe(id);
+    ApplyDemand();
+}
+
+void MonitoringEngine::SetSubscriptionGroups(int id, CollectorMask groups) {
+    m_subscriptions.SetGroups(id, groups);
+    ApplyDemand();
+}
+
+void MonitoringEngine::SetSubscriptionInterval(int id, std::chrono::milliseconds interval) {
+    m_subscriptions.SetInterval(id, interval);
+    ApplyDemand();
+}
+
+CollectorMask MonitoringEngine::PollSubscription(int id) {
+    return m_subscriptions.Poll(id);
+}
+
+CollectorMask MonitoringEngine::WaitSubscription(int id, std::chrono::milliseconds timeout) {
+    return m_subscriptions.Wait(id, timeout);
+}
+
+void MonitoringEngine::SetDemandDriven(bool enabled) {
+    if (m_demandDriven.exchange(enabled) == enabled) return;
+    
+    spdlog::info("Demand-driven collection {}", enabled ? "enabled" : "disabled");
+    ApplyDemand();
+}
+
+void MonitoringEngine::ApplyDemand() {
+    std::lock_guard<std::mutex> lock(m_periodMutex);
+    CollectorMask demand = m_demandDriven ? m_subscriptions.GetDemand() : kAllCollectors;
+    
+    for (size_t i = 0; i < static_cast<size_t>(CollectorId::Count); i++) {
+        auto id = static_cast<CollectorId>(i);
+        auto configured = std::chrono::milliseconds(m_configuredPeriodMs[i]);
+        m_demandPeriodMs[i] = static_cast<int>(m_subscriptions.GetDemandInterval(id, configured).count());
+        ApplyPeriod(id);
+        
+        bool paused = (demand & CollectorBit(id)) == 0;
+        if (m_scheduler.IsPaused(id) == paused) continue;
+        
+        m_scheduler.SetPaused(id, paused);
+        spdlog::debug("Collector {} {}", GetCollectorName(id), paused ? "paused: no subscribers" : "resumed");
+    }
+}
+
+SnapshotHandle MonitoringEngine::GetSnapshot() const {
+    return m_publisher.Acquire();
 }
 
 std::vector<CPUCoreInfo> MonitoringEngine::GetCPUInfo() {
-    std::lock_guard<std::mutex> lock(m_cpuMutex);
-    return m_cpuInfo;
+    return GetSnapshot()->cpu;
 }
 
 GPUInfo MonitoringEngine::GetGPUInfo() {
-    std::lock_guard<std::mutex> lock(m_gpuMutex);
-    return m_gpuInfo;
+    return GetSnapshot()->gpu;
 }
 
 RAMInfo MonitoringEngine::GetRAMInfo() {
-    std::lock_guard<std::mutex> lock(m_ramMutex);
-    return m_ramInfo;
+    return GetSnapshot()->ram;
 }
 
 std::vector<DiskInfo> MonitoringEngine::GetDiskInfo() {
-    std::lock_guard<std::mutex> lock(m_diskMutex);
-    return m_diskInfo;
+    return GetSnapshot()->disks;
 }
 
 NetworkInfo MonitoringEngine::GetNetworkInfo() {
-    std::lock_guard<std::mutex> lock(m_networkMutex);
-    return m_networkInfo;
+    return GetSnapshot()->network;
 }
 
 std::vector<ProcessInfo> MonitoringEngine::GetTopProcesses(int count) {
-    std::lock_guard<std::mutex> lock(m_processMutex);
+    auto snapshot = GetSnapshot();
+    const auto& processes = snapshot->processes;
     
-    if (count >= static_cast<int>(m_topProcesses.size())) {
-        return m_topProcesses;
+    if (count >= static_cast<int>(processes.size())) {
+        return processes;
     }
     
-    return std::vector<ProcessInfo>(m_topProcesses.begin(), m_topProcesses.begin() + count);
+    return std::vector<ProcessInfo>(processes.begin(), processes.begin() + count);
 }
 
-void MonitoringEngine::MonitoringThread() {
-    while (m_running) {
-        auto start = std::chrono::steady_clock::now();
-        
-        UpdateCPUInfo();
-        UpdateGPUInfo();
-        UpdateRAMInfo();
-        UpdateDiskInfo();
-        UpdateNetworkInfo();
-        UpdateProcessInfo();
-        
-        m_lastUpdate = std::chrono::steady_clock::now();
-        
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start
-        );
-        
-        int sleepTime = m_pollingRateMs - static_cast<int>(elapsed.count());
-        if (sleepTime > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(sleepTime));
-        }
+std::vector<PressureInfo> MonitoringEngine::GetPressureInfo() {
+    return GetSnapshot()->pressure;
+}
+
+std::vector<NumaNodeInfo> MonitoringEngine::GetNumaInfo() {
+    return GetSnapshot()->numa;
+}
+
+std::vector<CgroupInfo> MonitoringEngine::GetCgroupInfo() {
+    return GetSnapshot()->cgroups;
+}
+
+int MonitoringEngine::AddPressureTrigger(const PressureTrigger& trigger, CollectorBackend::PressureCallback callback) {
+    int id = m_backend->AddPressureTrigger(trigger, std::move(callback));
+    if (id >= 0) {
+        spdlog::info("Armed {} pressure trigger {}: {} us stall per {} us window",
+                     trigger.group.empty() ? "system" : trigger.group, id,
+                     trigger.stall.count(), trigger.window.count());
     }
+    return id;
 }
 
-void MonitoringEngine::UpdateCPUInfo() {
-    std::lock_guard<std::mutex> lock(m_cpuMutex);
+void MonitoringEngine::RemovePressureTrigger(int id) {
+    m_backend->RemovePressureTrigger(id);
+}
+
+void MonitoringEngine::SetThreadWatch(unsigned long pid) {
+    if (m_threadWatchPid.exchange(pid) == pid) return;
     
-    SYSTEM_INFO sysInfo;
-    GetSystemInfo(&sysInfo);
-    int coreCount = sysInfo.dwNumberOfProcessors;
+    if (pid) {
+        spdlog::info("Watching threads of process {}", pid);
+    } else {
+        spdlog::info("Stopped watching threads");
+    }
+}
+
+std::vector<ThreadSchedInfo> MonitoringEngine::GetThreadSchedInfo(unsigned long pid) {
+    auto snapshot = GetSnapshot();
+    if (pid == 0 || snapshot->threadsPid != pid) return {};
+    return snapshot->threads;
+}
+
+// Page-table walks share one rate limit. A fresh enough entry, or any entry
+// while the limit holds, is returned as is; expired entries of processes no
+// view asked about for a while are dropped on the next walk.
+template <typename Info, typename Query>
+bool MonitoringEngine::QueryCached(std::map<unsigned long, Info>& cache, unsigned long pid, Info& info, Query query) {
+    auto now = std::chrono::steady_clock::now();
     
-    m_cpuInfo.clear();
-    m_cpuInfo.reserve(coreCount);
+    auto cached = cache.find(pid);
+    bool hasCached = cached != cache.end();
+    bool throttled = now - m_lastProcessMemoryQuery < kProcessMemoryQueryInterval;
+    if (hasCached && (throttled || now - cached->second.sampledAt < kProcessMemoryMaxAge)) {
+        info = cached->second;
+        return true;
+    }
+    if (throttled) return false;
     
-    static PDH_HQUERY cpuQuery = nullptr;
-    static std::vector<PDH_HCOUNTER> cpuCounters;
+    m_lastProcessMemoryQuery = now;
+    if (!query(info)) {
+        if (hasCached) cache.erase(cached);
+        return false;
+    }
     
-    if (cpuQuery == nullptr) {
-        PdhOpenQuery(nullptr, 0, &cpuQuery);
-        cpuCounters.resize(coreCount);
+    std::erase_if(cache, [&](const auto& entry) {
+        return now - entry.second.sampledAt > kProcessMemoryMaxAge * 10;
+    });
+    cache[pid] = info;
+    return true;
+}
+
+bool MonitoringEngine::QueryProcessMemory(unsigned long pid, ProcessMemoryInfo& info) {
+    std::lock_guard<std::mutex> lock(m_processMemoryMutex);
+    return QueryCached(m_processMemory, pid, info, [&](ProcessMemoryInfo& result) {
+        return m_backend->QueryProcessMemory(pid, result);
+    });
+}
+
+bool MonitoringEngine::QueryProcessNuma(unsigned long pid, ProcessNumaInfo& info) {
+    auto topology = GetTopology();
+    
+    std::lock_guard<std::mutex> lock(m_processMemoryMutex);
+    return QueryCached(m_processNuma, pid, info, [&](ProcessNumaInfo& result) {
+        if (!m_backend->QueryProcessNuma(pid, result)) return false;
         
-        for (int i = 0; i < coreCount; i++) {
-            wchar_t counterPath[256];
-            swprintf_s(counterPath, L"\\Processor(%d)\\%% Processor Time", i);
-            PdhAddCounterW(cpuQuery, counterPath, 0, &cpuCounters[i]);
+        if (const LogicalCpu* cpu = topology->FindCpu(result.lastCpu)) result.homeNode = cpu->numaNode;
+        uint64_t total = 0, remote = 0;
+        for (size_t node = 0; node < result.nodeBytes.size(); node++) {
+            total += result.nodeBytes[node];
+            if (result.homeNode >= 0 && static_cast<int>(node) != result.homeNode) remote += result.nodeBytes[node];
         }
-        
-        PdhCollectQueryData(cpuQuery);
+        result.remotePercent = total > 0 ? 100.0f * remote / total : 0.0f;
+        return true;
+    });
+}
+
+bool MonitoringEngine::StartLatencyProbe(const LatencyProbeConfig& config) {
+    return m_latencyProbe.Start(config);
+}
+
+void MonitoringEngine::StopLatencyProbe() {
+    m_latencyProbe.Stop();
+}
+
+std::vector<LatencyStats> MonitoringEngine::GetLatencyStats() {
+    return GetSnapshot()->latency;
+}
+
+bool MonitoringEngine::StartRecording(const RecorderConfig& config) {
+    bool started = m_recorder.Start(config);
+    ApplyDemand();
+    return started;
+}
+
+void MonitoringEngine::StopRecording() {
+    m_recorder.Stop();
+    ApplyDemand();
+}
+
+void MonitoringEngine::PublishSnapshot(CollectorId source) {
+    PublishSnapshot(CollectorBit(source));
+}
+
+void MonitoringEngine::PublishSnapshot(CollectorMask sources) {
+    std::lock_guard<std::mutex> lock(m_stagingMutex);
+    
+    m_lastUpdate = std::chrono::steady_clock::now();
+    
+    SystemSnapshot* slot = m_publisher.BeginWrite();
+    if (!slot) {
+        spdlog::warn("All snapshot slots pinned by readers, dropping tick");
+        return;
     }
     
-    PdhCollectQueryData(cpuQuery);
+    // Copy-assignment reuses the slot's existing vector and string capacity,
+    // so steady-state publishing does not allocate either.
+    slot->timestamp = m_lastUpdate;
+    slot->cpu = m_staging.cpu;
+    slot->gpu = m_staging.gpu;
+    slot->ram = m_staging.ram;
+    slot->disks = m_staging.disks;
+    slot->network = m_staging.network;
+    slot->processes = m_staging.processes;
+    slot->thermal = m_staging.thermal;
+    slot->pressure = m_staging.pressure;
+    slot->threadsPid = m_staging.threadsPid;
+    slot->threads = m_staging.threads;
+    slot->latency = m_staging.latency;
+    slot->numa = m_staging.numa;
+    slot->cgroups = m_staging.cgroups;
     
-    for (int i = 0; i < coreCount; i++) {
-        CPUCoreInfo info;
-        info.coreID = i;
-        info.frequency = 0.0f;
-        info.temperature = 0.0f;
-        info.cState = 0.0f;
-        
-        PDH_FMT_COUNTERVALUE counterVal;
-        if (PdhGetFormattedCounterValue(cpuCounters[i], PDH_FMT_DOUBLE, nullptr, &counterVal) == ERROR_SUCCESS) {
-            info.usage = static_cast<float>(counterVal.doubleValue);
-        } else {
-            info.usage = 0.0f;
+    m_publisher.Publish();
+    m_subscriptions.Notify(sources);
+}
+
+// Fed parts bypass the trackers and temperature merging, which already ran
+// when the snapshot was first captured; history is appended as the live
+// collector would have.
+void MonitoringEngine::ApplyFeed(const SystemSnapshot& snapshot, CollectorMask changed) {
+    for (size_t i = 0; i < static_cast<size_t>(CollectorId::Count); i++) {
+        auto id = static_cast<CollectorId>(i);
+        if (!(changed & CollectorBit(id))) continue;
+        if (id == CollectorId::Threads && snapshot.threadsPid == 0) continue;
+        if (id == CollectorId::Latency && snapshot.latency.empty()) continue;
+        RecordHistory(id, snapshot);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        for (size_t i = 0; i < static_cast<size_t>(CollectorId::Count); i++) {
+            auto id = static_cast<CollectorId>(i);
+            if (changed & CollectorBit(id)) CopyCollectorPart(id, snapshot, m_staging);
         }
-        
-        m_cpuInfo.push_back(info);
+    }
+    PublishSnapshot(changed);
+}
+
+void MonitoringEngine::UpdateCPUInfo() {
+    if (m_backend->CollectCPU(m_scratch.cpu)) {
+        {
+            std::lock_guard<std::mutex> lock(m_stagingMutex);
+            ApplyCpuTemperatures(m_scratch.cpu, m_staging.thermal);
+        }
+        RecordHistory(CollectorId::CPU, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        m_staging.cpu.swap(m_scratch.cpu);
     }
 }
 
 void MonitoringEngine::UpdateGPUInfo() {
-    std::lock_guard<std::mutex> lock(m_gpuMutex);
-    
-    m_gpuInfo.name = "Unknown GPU";
-    m_gpuInfo.coreClock = 0.0f;
-    m_gpuInfo.memoryClock = 0.0f;
-    m_gpuInfo.temperature = 0.0f;
-    m_gpuInfo.usage = 0.0f;
-    m_gpuInfo.memoryUsage = 0.0f;
-    m_gpuInfo.memoryTotal = 0.0f;
-    m_gpuInfo.powerUsage = 0.0f;
-    m_gpuInfo.fanSpeed = 0;
+    if (m_backend->CollectGPU(m_scratch.gpu)) {
+        {
+            std::lock_guard<std::mutex> lock(m_stagingMutex);
+            ApplyGpuTemperature(m_scratch.gpu, m_staging.thermal);
+        }
+        RecordHistory(CollectorId::GPU, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        std::swap(m_staging.gpu, m_scratch.gpu);
+    }
 }
 
 void MonitoringEngine::UpdateRAMInfo() {
-    std::lock_guard<std::mutex> lock(m_ramMutex);
-    
-    MEMORYSTATUSEX memInfo;
-    memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-    GlobalMemoryStatusEx(&memInfo);
-    
-    m_ramInfo.totalGB = static_cast<float>(memInfo.ullTotalPhys) / (1024.0f * 1024.0f * 1024.0f);
-    m_ramInfo.availableGB = static_cast<float>(memInfo.ullAvailPhys) / (1024.0f * 1024.0f * 1024.0f);
-    m_ramInfo.usedGB = m_ramInfo.totalGB - m_ramInfo.availableGB;
-    m_ramInfo.usagePercent = static_cast<float>(memInfo.dwMemoryLoad);
-    m_ramInfo.speedMHz = 0;
-    m_ramInfo.latencyNs = 0.0f;
+    if (m_backend->CollectRAM(m_scratch.ram)) {
+        RecordHistory(CollectorId::RAM, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        m_staging.ram = m_scratch.ram;
+    }
 }
 
 void MonitoringEngine::UpdateDiskInfo() {
-    std::lock_guard<std::mutex> lock(m_diskMutex);
+    if (m_backend->CollectDisks(m_scratch.disks)) {
+        {
+            std::lock_guard<std::mutex> lock(m_stagingMutex);
+            ApplyDiskTemperatures(m_scratch.disks, m_staging.thermal);
+        }
+        RecordHistory(CollectorId::Disk, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        m_staging.disks.swap(m_scratch.disks);
+    }
+}
+
+void MonitoringEngine::UpdateNetworkInfo() {
+    if (m_backend->CollectNetwork(m_scratch.network)) {
+        AggregateNetwork(m_scratch.network);
+        RecordHistory(CollectorId::Network, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        std::swap(m_staging.network, m_scratch.network);
+    }
+}
+
+void MonitoringEngine::UpdateThermalInfo() {
+    if (m_backend->CollectThermal(m_scratch.thermal)) {
+        RecordHistory(CollectorId::Thermal, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        std::swap(m_staging.thermal, m_scratch.thermal);
+        
+        // Refresh the staged devices too, so the snapshot does not wait for
+        // their next collector tick to show the new reading.
+        ApplyCpuTemperatures(m_staging.cpu, m_staging.thermal);
+        ApplyGpuTemperature(m_staging.gpu, m_staging.thermal);
+        ApplyDiskTemperatures(m_staging.disks, m_staging.thermal);
+    }
+}
+
+void MonitoringEngine::UpdatePressureInfo() {
+    if (m_backend->CollectPressure(m_scratch.pressure)) {
+        RecordHistory(CollectorId::Pressure, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        m_staging.pressure.swap(m_scratch.pressure);
+    }
+}
+
+void MonitoringEngine::UpdateThreadInfo() {
+    unsigned long pid = m_threadWatchPid;
+    if (pid == 0 && m_scratch.threadsPid == 0) return;
     
-    m_diskInfo.clear();
+    if (pid != m_scratch.threadsPid) {
+        m_threadTracker.Reset();
+        m_scratch.threadsPid = pid;
+    }
     
-    DWORD drives = GetLogicalDrives();
-    for (int i = 0; i < 26; i++) {
-        if (drives & (1 << i)) {
-            char driveLetter = 'A' + i;
-            std::string drivePath = std::string(1, driveLetter) + ":\\";
-            
-            UINT driveType = GetDriveTypeA(drivePath.c_str());
-            if (driveType == DRIVE_FIXED || driveType == DRIVE_REMOVABLE) {
-                DiskInfo info;
-                info.name = drivePath;
-                info.readMBps = 0.0f;
-                info.writeMBps = 0.0f;
-                info.readIOPS = 0;
-                info.writeIOPS = 0;
-                info.latencyMs = 0.0f;
-                info.temperature = 0.0f;
-                
-                ULARGE_INTEGER freeBytesAvailable, totalNumberOfBytes, totalNumberOfFreeBytes;
-                if (GetDiskFreeSpaceExA(drivePath.c_str(), &freeBytesAvailable, &totalNumberOfBytes, &totalNumberOfFreeBytes)) {
-                    float usedBytes = static_cast<float>(totalNumberOfBytes.QuadPart - totalNumberOfFreeBytes.QuadPart);
-                    info.usagePercent = (usedBytes / totalNumberOfBytes.QuadPart) * 100.0f;
-                }
-                
-                m_diskInfo.push_back(info);
-            }
+    if (pid != 0 && m_backend->CollectThreads(pid, m_threadSamples)) {
+        m_threadTracker.Update(m_threadSamples, std::chrono::steady_clock::now(), m_scratch.threads);
+        RecordHistory(CollectorId::Threads, m_scratch);
+    } else {
+        // Gone: stop watching, unless another process was picked meanwhile.
+        if (pid != 0 && m_threadWatchPid.compare_exchange_strong(pid, 0)) {
+            spdlog::info("Process {} exited, stopped watching its threads", pid);
         }
+        m_scratch.threads.clear();
     }
+    
+    std::lock_guard<std::mutex> lock(m_stagingMutex);
+    m_staging.threadsPid = m_scratch.threadsPid;
+    m_staging.threads.swap(m_scratch.threads);
 }
 
-void MonitoringEngine::UpdateNetworkInfo() {
-    std::lock_guard<std::mutex> lock(m_networkMutex);
+void MonitoringEngine::UpdateLatencyInfo() {
+    if (!m_latencyProbe.IsRunning() && m_scratch.latency.empty()) return;
     
-    m_networkInfo.adapterName = "Default";
-    m_networkInfo.uploadMbps = 0.0f;
-    m_networkInfo.downloadMbps = 0.0f;
-    m_networkInfo.latencyMs = 0.0f;
-    m_networkInfo.packetLoss = 0.0f;
+    m_latencyProbe.Collect(m_scratch.latency);
+    if (!m_scratch.latency.empty()) {
+        RecordHistory(CollectorId::Latency, m_scratch);
+    }
+    
+    std::lock_guard<std::mutex> lock(m_stagingMutex);
+    m_staging.latency = m_scratch.latency;
+}
+
+void MonitoringEngine::UpdateNumaInfo() {
+    if (m_backend->CollectNuma(m_scratch.numa)) {
+        RecordHistory(CollectorId::Numa, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        m_staging.numa.swap(m_scratch.numa);
+    }
+}
+
+void MonitoringEngine::UpdateCgroupInfo() {
+    if (m_backend->CollectCgroups(m_scratch.cgroups)) {
+        RecordHistory(CollectorId::Cgroups, m_scratch);
+        std::lock_guard<std::mutex> lock(m_stagingMutex);
+        m_staging.cgroups.swap(m_scratch.cgroups);
+    }
 }
 
 void MonitoringEngine::UpdateProcessInfo() {
-    std::lock_guard<std::mutex> lock(m_processMutex);
+    if (!m_backend->CollectProcesses(m_processSamples)) return;
+    
+    // Only the busiest processes are published; the tracker still keeps
+    // state for every process so their CPU deltas stay continuous.
+    m_processTracker.Update(m_processSamples, std::chrono::steady_clock::now(), kTopProcessCount, m_scratch.processes);
+    
+    std::lock_guard<std::mutex> lock(m_stagingMutex);
+    m_staging.processes.swap(m_scratch.processes);
+}
+
+SeriesTable* MonitoringEngine::GetHistoryTable(CollectorId id, const SystemSnapshot& sample) {
+    HistoryLayout& layout = m_historyLayouts[static_cast<size_t>(id)];
+    auto now = std::chrono::steady_clock::now();
+    if (layout.table && (!layout.stale || layout.generation + 1 >= kMaxHistoryGenerations ||
+                         now - layout.laidOut < kHistoryRelayoutInterval)) {
+        return layout.table;
+    }
+    
+    layout.namedColumns.clear();
+    layout.numberedColumns.clear();
+    std::vector<std::string> columns;
+    std::string name;
+    
+    switch (id) {
+        case CollectorId::CPU:
+            name = "cpu";
+            columns.push_back("usage");
+            for (const char* metric : {"usage", "frequency", "temperature", "cState"}) {
+                for (const auto& core : sample.cpu) {
+                    columns.push_back("core" + std::to_string(core.coreID) + "." + metric);
+                }
+            }
+            break;
+        case CollectorId::GPU:
+            name = "gpu";
+            columns = {"usage", "coreClock", "memoryClock", "temperature", "memoryUsage", "powerUsage"};
+            break;
+        case CollectorId::RAM:
+            name = "ram";
+            columns = {"usedGB", "availableGB", "usagePercent", "cachedGB", "dirtyMB", "swapUsedGB", "swapInMBps",
+                       "swapOutMBps", "committedGB"};
+            break;
+        case CollectorId::Disk:
+            name = "disk";
+            for (const char* metric : kDiskMetrics) {
+                for (const auto& disk : sample.disks) {
+                    if (metric == kDiskMetrics[0]) layout.namedColumns.emplace(disk.name, columns.size());
+                    columns.push_back(disk.name + "." + metric);
+                }
+            }
+            break;
+        case CollectorId::Thermal:
+            name = "thermal";
+            columns = {"packageTemperature", "throttleEvents", "frequencyCapped"};
+            break;
+        case CollectorId::Latency:
+            name = "latency";
+            for (const char* metric : kLatencyMetrics) {
+                for (const auto& cpu : sample.latency) {
+                    if (metric == kLatencyMetrics[0]) layout.numberedColumns.emplace(cpu.cpu, columns.size());
+                    columns.push_back("cpu" + std::to_string(cpu.cpu) + "." + metric);
+                }
+            }
+            break;
+        case CollectorId::Numa:
+            name = "numa";
+            for (const char* metric : kNumaMetrics) {
+                for (const auto& node : sample.numa) {
+                    if (metric == kNumaMetrics[0]) layout.numberedColumns.emplace(node.node, columns.size());
+                    columns.push_back("node" + std::to_string(node.node) + "." + metric);
+                }
+            }
+            break;
+        case CollectorId::Cgroups:
+            name = "cgroup";
+            for (const auto& group : sample.cgroups) {
+                if (group.depth > kCgroupHistoryDepth) continue;
+                layout.namedColumns.emplace(group.path, columns.size());
+                for (const char* metric : kCgroupMetrics) {
+                    columns.push_back(group.path + "/" + metric);
+                }
+            }
+            break;
+        case CollectorId::Threads:
+            name = "threads";
+            columns = {"cpuUsage", "runDelayPercent", "maxRunDelayPercent", "switchesPerSec", "migrationsPerSec"};
+            break;
+        case CollectorId::Pressure:
+            name = "pressure";
+            for (const auto& info : sample.pressure) {
+                layout.namedColumns.emplace(info.group, columns.size());
+                for (const char* metric : kPressureMetrics) {
+                    columns.push_back(PressureColumnPrefix(info.group) + metric);
+                }
+            }
+            break;
+        case CollectorId::Network:
+            name = "network";
+            columns = {"downloadMbps", "uploadMbps", "packetsPerSec", "dropsPerSec", "errorsPerSec", "packetLoss"};
+            for (const char* metric : kInterfaceMetrics) {
+                for (const auto& iface : sample.network.interfaces) {
+                    if (metric == kInterfaceMetrics[0]) layout.namedColumns.emplace(iface.name, columns.size());
+                    columns.push_back(iface.name + "." + metric);
+                }
+            }
+            break;
+        default:
+            return nullptr;
+    }
+    
+    // Critical-lane tables are sized for the fastest polling rate so a rate
+    // change never shortens the window; background tables for their
+    // configured period, which adaptive back-off only ever stretches.
+    std::chrono::milliseconds period;
+    {
+        std::lock_guard<std::mutex> lock(m_periodMutex);
+        period = std::chrono::milliseconds(m_configuredPeriodMs[static_cast<size_t>(id)]);
+    }
+    if (id == CollectorId::CPU || id == CollectorId::GPU || id == CollectorId::RAM || id == CollectorId::Network) {
+        period = kMinPollingRate;
+    }
+    size_t capacity = static_cast<size_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(kHistoryWindow).count() / period.count());
+    
+    layout.row.assign(columns.size(), 0.0f);
+    layout.stale = false;
+    layout.laidOut = now;
+    
+    if (!layout.table) {
+        layout.table = &m_history.AddTable(name, std::move(columns), capacity);
+        return layout.table;
+    }
     
-    m_topProcesses.clear();
+    layout.generation++;
+    if (layout.generation + 1 == kMaxHistoryGenerations) {
+        spdlog::warn("History table '{}' laid out {} times; devices and groups added later are not recorded",
+                     name, kMaxHistoryGenerations);
+    } else {
+        spdlog::info("History table '{}' laid out again, {} columns", name, columns.size());
+    }
+    layout.table = &m_history.AddTableGeneration(name, std::move(columns), capacity);
+    return layout.table;
+}
+
+void MonitoringEngine::RecordHistory(CollectorId id, const SystemSnapshot& sample) {
+    SeriesTable* table = GetHistoryTable(id, sample);
+    if (!table) return;
+    
+    HistoryLayout& layout = m_historyLayouts[static_cast<size_t>(id)];
+    std::vector<float>& row = layout.row;
+    size_t i = 0;
+    
+    // Devices that disappear leave NaN gaps; ones that appear are recorded
+    // from the table's next generation on.
+    auto put = [&](float value) { if (i < row.size()) row[i++] = value; };
+    auto resolve = [&](const auto& columns, const auto& key) {
+        auto it = columns.find(key);
+        if (it != columns.end()) return static_cast<int>(it->second);
+        layout.stale = true;
+        return -1;
+    };
+    constexpr float kMissing = std::numeric_limits<float>::quiet_NaN();
+    
+    switch (id) {
+        case CollectorId::CPU: {
+            size_t cores = (row.size() - 1) / 4;
+            float total = 0.0f;
+            for (const auto& core : sample.cpu) total += core.usage;
+            put(sample.cpu.empty() ? 0.0f : total / sample.cpu.size());
+            
+            size_t n = std::min(cores, sample.cpu.size());
+            for (size_t c = 0; c < cores; c++) {
+                row[1 + c] = c < n ? sample.cpu[c].usage : kMissing;
+                row[1 + cores + c] = c < n ? sample.cpu[c].frequency : kMissing;
+                row[1 + cores * 2 + c] = c < n ? sample.cpu[c].temperature : kMissing;
+                row[1 + cores * 3 + c] = c < n ? sample.cpu[c].cState : kMissing;
+            }
+            break;
+        }
+        case CollectorId::GPU:
+            put(sample.gpu.usage);
+            put(sample.gpu.coreClock);
+            put(sample.gpu.memoryClock);
+            put(sample.gpu.temperature);
+            put(sample.gpu.memoryUsage);
+            put(sample.gpu.powerUsage);
+            break;
+        case CollectorId::RAM:
+            put(sample.ram.usedGB);
+            put(sample.ram.availableGB);
+            put(sample.ram.usagePercent);
+            put(sample.ram.cachedGB);
+            put(sample.ram.dirtyMB);
+            put(sample.ram.swapUsedGB);
+            put(sample.ram.swapInMBps);
+            put(sample.ram.swapOutMBps);
+            put(sample.ram.committedGB);
+            break;
+        case CollectorId::Disk: {
+            size_t disks = row.size() / std::size(kDiskMetrics);
+            std::fill(row.begin(), row.end(), kMissing);
+            
+            for (const auto& disk : sample.disks) {
+                int column = resolve(layout.namedColumns, disk.name);
+                if (column < 0) continue;
+                size_t d = static_cast<size_t>(column);
+                row[d] = disk.readMBps;
+                row[d + disks] = disk.writeMBps;
+                row[d + disks * 2] = static_cast<float>(disk.readIOPS);
+                row[d + disks * 3] = static_cast<float>(disk.writeIOPS);
+                row[d + disks * 4] = disk.latencyMs;
+                row[d + disks * 5] = disk.queueDepth;
+                row[d + disks * 6] = disk.busyPercent;
+                row[d + disks * 7] = disk.usagePercent;
+                row[d + disks * 8] = disk.temperature;
+            }
+            break;
+        }
+        case CollectorId::Thermal:
+            put(sample.thermal.packageTemperature);
+            put(static_cast<float>(sample.thermal.newThrottleEvents));
+            put(sample.thermal.frequencyCapped ? 1.0f : 0.0f);
+            break;
+        case CollectorId::Latency: {
+            size_t cpus = row.size() / std::size(kLatencyMetrics);
+            std::fill(row.begin(), row.end(), kMissing);
+            
+            for (const auto& cpu : sample.latency) {
+                int column = resolve(layout.numberedColumns, cpu.cpu);
+                if (column < 0 || cpu.samples == 0) continue;
+                size_t c = static_cast<size_t>(column);
+                row[c] = cpu.p50Us;
+                row[c + cpus] = cpu.p99Us;
+                row[c + cpus * 2] = cpu.p999Us;
+                row[c + cpus * 3] = cpu.maxUs;
+            }
+            break;
+        }
+        case CollectorId::Numa: {
+            size_t nodes = row.size() / std::size(kNumaMetrics);
+            std::fill(row.begin(), row.end(), kMissing);
+            
+            for (const auto& node : sample.numa) {
+                int column = resolve(layout.numberedColumns, node.node);
+                if (column < 0) continue;
+                size_t n = static_cast<size_t>(column);
+                row[n] = node.usedGB;
+                row[n + nodes] = node.freeGB;
+                row[n + nodes * 2] = node.hitsPerSec;
+                row[n + nodes * 3] = node.missesPerSec;
+                row[n + nodes * 4] = node.foreignPerSec;
+                row[n + nodes * 5] = node.remotePerSec;
+            }
+            break;
+        }
+        case CollectorId::Cgroups:
+            std::fill(row.begin(), row.end(), kMissing);
+            for (const auto& group : sample.cgroups) {
+                if (group.depth > kCgroupHistoryDepth) continue;
+                int column = resolve(layout.namedColumns, group.path);
+                if (column < 0) continue;
+                size_t g = static_cast<size_t>(column);
+                row[g] = group.cpuPercent;
+                row[g + 1] = group.throttledPercent;
+                row[g + 2] = static_cast<float>(group.memoryBytes / (1024.0 * 1024.0));
+                row[g + 3] = group.ioReadMBps;
+                row[g + 4] = group.ioWriteMBps;
+            }
+            break;
+        case CollectorId::Threads: {
+            // Totals over the watched process; runDelayPercent is thread-time
+            // spent waiting for a CPU, so it can exceed 100 with many threads.
+            float cpuUsage = 0.0f, runDelay = 0.0f, maxRunDelay = 0.0f, switches = 0.0f, migrations = 0.0f;
+            for (const auto& thread : sample.threads) {
+                cpuUsage += thread.cpuUsage;
+                runDelay += thread.runDelayPercent;
+                maxRunDelay = std::max(maxRunDelay, thread.runDelayPercent);
+                switches += thread.voluntarySwitchesPerSec + thread.involuntarySwitchesPerSec;
+                migrations += thread.migrationsPerSec;
+            }
+            put(cpuUsage);
+            put(runDelay);
+            put(maxRunDelay);
+            put(switches);
+            put(migrations);
+            break;
+        }
+        case CollectorId::Pressure:
+            // Share of wall time stalled per tick, "some" then "full" for
+            // each resource, grouped by cgroup.
+            std::fill(row.begin(), row.end(), kMissing);
+            for (const auto& info : sample.pressure) {
+                int column = resolve(layout.namedColumns, info.group);
+                if (column < 0) continue;
+                size_t p = static_cast<size_t>(column);
+                for (const auto& stall : info.resources) {
+                    row[p++] = stall.somePercent;
+                    row[p++] = stall.fullPercent;
+                }
+            }
+            break;
+        case CollectorId::Network: {
+            put(sample.network.downloadMbps);
+            put(sample.network.uploadMbps);
+            put(sample.network.packetsPerSec);
+            put(sample.network.dropsPerSec);
+            put(sample.network.errorsPerSec);
+            put(sample.network.packetLoss);
+            
+            size_t interfaces = (row.size() - i) / std::size(kInterfaceMetrics);
+            std::fill(row.begin() + i, row.end(), kMissing);
+            
+            for (const auto& iface : sample.network.interfaces) {
+                int column = resolve(layout.namedColumns, iface.name);
+                if (column < 0) continue;
+                size_t n = static_cast<size_t>(column);
+                row[n] = iface.downloadMbps;
+                row[n + interfaces] = iface.uploadMbps;
+                row[n + interfaces * 2] = iface.rxPacketsPerSec + iface.txPacketsPerSec;
+                row[n + interfaces * 3] = iface.rxDropsPerSec + iface.txDropsPerSec;
+                row[n + interfaces * 4] = iface.rxErrorsPerSec + iface.txErrorsPerSec;
+            }
+            break;
+        }
+        default:
+            return;
+    }
+    
+    table->Append(MetricHistory::NowUs(), row);
+    
+    if (m_adaptiveSampling && m_volatility[static_cast<size_t>(id)].Update(row)) {
+        std::lock_guard<std::mutex> lock(m_periodMutex);
+        ApplyPeriod(id);
+    }
 }
 
 }
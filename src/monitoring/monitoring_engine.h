@@ -1,71 +1,26 @@
 #pragma once
+#include "monitoring_types.h"
+#include "collector_backend.h"
+#include "snapshot_publisher.h"
+#include "collector_scheduler.h"
+#include "subscription_hub.h"
+#include "telemetry_recorder.h"
+#include "volatility_tracker.h"
+#include "metric_history.h"
+#include "process_tracker.h"
+#include "latency_probe.h"
+#include <array>
 #include <string>
 #include <vector>
 #include <map>
-#include <thread>
+#include <memory>
 #include <mutex>
 #include <atomic>
 #include <chrono>
 
 namespace Monitor {
 
-struct CPUCoreInfo {
-    int coreID;
-    float frequency;
-    float temperature;
-    float usage;
-    float cState;
-};
-
-struct GPUInfo {
-    std::string name;
-    float coreClock;
-    float memoryClock;
-    float temperature;
-    float usage;
-    float memoryUsage;
-    float memoryTotal;
-    float powerUsage;
-    int fanSpeed;
-};
-
-struct RAMInfo {
-    float totalGB;
-    float usedGB;
-    float availableGB;
-    float usagePercent;
-    int speedMHz;
-    float latencyNs;
-};
-
-struct DiskInfo {
-    std::string name;
-    float readMBps;
-    float writeMBps;
-    int readIOPS;
-    int writeIOPS;
-    float latencyMs;
-    float temperature;
-    float usagePercent;
-};
-
-struct NetworkInfo {
-    std::string adapterName;
-    float uploadMbps;
-    float downloadMbps;
-    float latencyMs;
-    float packetLoss;
-};
-
-struct ProcessInfo {
-    std::string name;
-    unsigned long pid;
-    float cpuUsage;
-    float gpuUsage;
-    float memoryMB;
-    int threads;
-    int handles;
-};
+using SnapshotHandle = SnapshotPublisher::Handle;
 
 class MonitoringEngine {
 public:
@@ -76,19 +31,125 @@ public:
     void Stop();
     bool IsRunning() const { return m_running; }
     
+    // Pins the latest published snapshot without locking or copying. Prefer
+    // this on per-frame paths; the Get*Info helpers below copy out of it.
+    SnapshotHandle GetSnapshot() const;
+    uint64_t GetSnapshotVersion() const { return m_publisher.GetVersion(); }
+    
     std::vector<CPUCoreInfo> GetCPUInfo();
     GPUInfo GetGPUInfo();
     RAMInfo GetRAMInfo();
     std::vector<DiskInfo> GetDiskInfo();
     NetworkInfo GetNetworkInfo();
     std::vector<ProcessInfo> GetTopProcesses(int count = 10);
+    std::vector<PressureInfo> GetPressureInfo();
+    std::vector<NumaNodeInfo> GetNumaInfo();
+    std::vector<CgroupInfo> GetCgroupInfo();
+    
+    // Push delivery instead of polling: `callback` runs on the hub thread
+    // after a collector in `groups` publishes, with the newest snapshot when
+    // it fell behind. The signal form is drained with PollSubscription or
+    // WaitSubscription from the consumer's own loop. Each collector runs at
+    // the shortest `interval` its subscribers ask for; zero leaves it at
+    // the configured period.
+    int Subscribe(CollectorMask groups, SubscriptionHub::Callback callback, std::chrono::milliseconds interval = {});
+    int Subscribe(CollectorMask groups, std::chrono::milliseconds interval = {});
+    void Unsubscribe(int id);
+    void SetSubscriptionGroups(int id, CollectorMask groups);
+    void SetSubscriptionInterval(int id, std::chrono::milliseconds interval);
+    CollectorMask PollSubscription(int id);
+    CollectorMask WaitSubscription(int id, std::chrono::milliseconds timeout);
+    
+    // Collectors some subscriber asks for. In demand-driven mode the rest
+    // are paused until a subscription names them; off by default so that
+    // polling consumers keep getting fresh data.
+    CollectorMask GetDemand() const { return m_subscriptions.GetDemand(); }
+    void SetDemandDriven(bool enabled);
+    bool IsDemandDriven() const { return m_demandDriven; }
+    
+    // Stall notifications between polling ticks, armed in the kernel where
+    // the backend supports it. Returns -1 when the trigger is refused.
+    // Triggers belong to the current backend and end with it.
+    int AddPressureTrigger(const PressureTrigger& trigger, CollectorBackend::PressureCallback callback);
+    void RemovePressureTrigger(int id);
+    
+    // Samples run-queue delay, CPU time, switches and migrations of every
+    // thread of one process into SystemSnapshot::threads; 0 stops. The watch
+    // ends by itself when the process exits.
+    void SetThreadWatch(unsigned long pid);
+    unsigned long GetThreadWatch() const { return m_threadWatchPid; }
+    std::vector<ThreadSchedInfo> GetThreadSchedInfo(unsigned long pid);
+    
+    // PSS/USS of one process, for detail views. Never sampled on a tick:
+    // each call reuses a result younger than two seconds, and new page-table
+    // walks are rate-limited across all callers, so a refused query (false)
+    // should simply be retried on a later frame.
+    bool QueryProcessMemory(unsigned long pid, ProcessMemoryInfo& info);
+    
+    // Resident pages of one process per NUMA node, with remotePercent
+    // measured against the node it last ran on. Cached and rate-limited
+    // together with QueryProcessMemory.
+    bool QueryProcessNuma(unsigned long pid, ProcessNumaInfo& info);
+    
+    // Timer wakeup-jitter probe; results appear in SystemSnapshot::latency
+    // once per second while it runs.
+    bool StartLatencyProbe(const LatencyProbeConfig& config = {});
+    void StopLatencyProbe();
+    bool IsLatencyProbeRunning() const { return m_latencyProbe.IsRunning(); }
+    std::vector<LatencyStats> GetLatencyStats();
     
+    // Appends every published snapshot to memory-mapped segment files from
+    // a writer thread of its own; see TelemetryRecorder. The recording
+    // subscribes to every collector, so demand-driven mode keeps them all
+    // running while it lasts.
+    bool StartRecording(const RecorderConfig& config = {});
+    void StopRecording();
+    bool IsRecording() const { return m_recorder.IsRunning(); }
+    RecorderStats GetRecordingStats() const { return m_recorder.GetStats(); }
+    
+    // Sets the configured period of the critical-lane collectors (CPU, GPU,
+    // RAM, network). Slow collectors keep their own periods.
     void SetPollingRate(int ms);
+    void SetCollectorPeriod(CollectorId id, int ms);
+    
+    // Lets a collector whose history has been flat for a while stretch its
+    // period up to VolatilityTracker::kMaxBackoff times (but not past 5 s
+    // unless already longer); a sudden change restores it at once. On by
+    // default.
+    void SetAdaptiveSampling(bool enabled);
+    bool IsAdaptiveSampling() const { return m_adaptiveSampling; }
+    
+    // Per-collector cost, including CPU time, syscalls and allocations per
+    // run, plus the engine-wide share of a core and wakeups per second.
+    std::vector<CollectorStats> GetCollectorStats() const;
+    SchedulerOverhead GetSelfOverhead() const { return m_scheduler.GetOverhead(); }
+    
+    // Keeps collection under `percentOfCore` of one core (0 for no limit)
+    // by stretching the periods of the least important collectors first;
+    // see CollectorScheduler::SetCpuBudget. Degraded collectors are listed
+    // in GetSelfOverhead and logged as they change.
+    void SetCpuBudget(float percentOfCore) { m_scheduler.SetCpuBudget(percentOfCore); }
+    float GetCpuBudget() const { return m_scheduler.GetCpuBudget(); }
+    
+    // A backend that feeds snapshots (see CollectorBackend::StartFeed)
+    // replaces the collectors while the engine runs: each fed snapshot is
+    // published as it is, with only the timestamp and history taken here.
+    void SetBackend(std::unique_ptr<CollectorBackend> backend);
+    const char* GetBackendName() const;
+    std::vector<std::string> GetCpuIdleStates() const;
+    
+    // Processor layout of the current backend, discovered on first use and
+    // shared read-only afterwards. Never null.
+    std::shared_ptr<const CpuTopology> GetTopology();
+    
+    // Shared time series of every metric; consumers read spans from it
+    // instead of keeping their own copies.
+    const MetricHistory& GetHistory() const { return m_history; }
     
 private:
     MonitoringEngine();
     
-    void MonitoringThread();
+    void RegisterCollectors();
     
     void UpdateCPUInfo();
     void UpdateGPUInfo();
@@ -96,24 +157,89 @@ private:
     void UpdateDiskInfo();
     void UpdateNetworkInfo();
     void UpdateProcessInfo();
+    void UpdateThermalInfo();
+    void UpdatePressureInfo();
+    void UpdateThreadInfo();
+    void UpdateLatencyInfo();
+    void UpdateNumaInfo();
+    void UpdateCgroupInfo();
+    
+    void PublishSnapshot(CollectorId source);
+    void PublishSnapshot(CollectorMask sources);
+    void ApplyFeed(const SystemSnapshot& snapshot, CollectorMask changed);
+    void ApplyDemand();
+    void ApplyPeriod(CollectorId id);
+    
+    template <typename Info, typename Query>
+    bool QueryCached(std::map<unsigned long, Info>& cache, unsigned long pid, Info& info, Query query);
+    
+    void RecordHistory(CollectorId id, const SystemSnapshot& sample);
+    SeriesTable* GetHistoryTable(CollectorId id, const SystemSnapshot& sample);
     
-    std::thread m_thread;
     std::atomic<bool> m_running{false};
+    std::atomic<bool> m_feeding{false};
     std::atomic<int> m_pollingRateMs{1000};
     
-    std::mutex m_cpuMutex;
-    std::mutex m_gpuMutex;
-    std::mutex m_ramMutex;
-    std::mutex m_diskMutex;
-    std::mutex m_networkMutex;
-    std::mutex m_processMutex;
-    
-    std::vector<CPUCoreInfo> m_cpuInfo;
-    GPUInfo m_gpuInfo;
-    RAMInfo m_ramInfo;
-    std::vector<DiskInfo> m_diskInfo;
-    NetworkInfo m_networkInfo;
-    std::vector<ProcessInfo> m_topProcesses;
+    std::unique_ptr<CollectorBackend> m_backend;
+    CollectorScheduler m_scheduler;
+    
+    // Collector-side state. Each collector fills only its own member of
+    // m_scratch, so lanes never race on it; m_staging holds the latest good
+    // values of every collector and is guarded by m_stagingMutex, which also
+    // keeps the publisher single-writer.
+    SystemSnapshot m_scratch;
+    SystemSnapshot m_staging;
+    std::mutex m_stagingMutex;
+    SnapshotPublisher m_publisher;
+    SubscriptionHub m_subscriptions{m_publisher};
+    TelemetryRecorder m_recorder{m_subscriptions, m_publisher};
+    
+    // Scheduler periods follow from the configured period, the fastest
+    // subscriber interval and the volatility back-off; m_periodMutex
+    // serializes recomputing them.
+    std::mutex m_periodMutex;
+    std::atomic<bool> m_demandDriven{false};
+    std::atomic<bool> m_adaptiveSampling{true};
+    std::array<int, static_cast<size_t>(CollectorId::Count)> m_configuredPeriodMs{};
+    std::array<int, static_cast<size_t>(CollectorId::Count)> m_demandPeriodMs{};
+    std::array<VolatilityTracker, static_cast<size_t>(CollectorId::Count)> m_volatility;
+    
+    std::vector<ProcessSample> m_processSamples;
+    ProcessTracker m_processTracker;
+    
+    std::atomic<unsigned long> m_threadWatchPid{0};
+    std::vector<ThreadSample> m_threadSamples;
+    ThreadTracker m_threadTracker;
+    
+    LatencyProbe m_latencyProbe;
+    
+    std::mutex m_topologyMutex;
+    std::shared_ptr<const CpuTopology> m_topology;
+    
+    // On-demand page-table walks, cached per pid; guarded by
+    // m_processMemoryMutex.
+    std::mutex m_processMemoryMutex;
+    std::map<unsigned long, ProcessMemoryInfo> m_processMemory;
+    std::map<unsigned long, ProcessNumaInfo> m_processNuma;
+    std::chrono::steady_clock::time_point m_lastProcessMemoryQuery;
+    
+    // The history table of each collector and the row it is filled from.
+    // Devices, interfaces and groups resolve to the column of their first
+    // metric by name or number; ones the table has no columns for, or a new
+    // backend, mark it stale, and the next record lays out a new generation
+    // of the table.
+    struct HistoryLayout {
+        SeriesTable* table = nullptr;
+        std::vector<float> row;
+        std::map<std::string, size_t, std::less<>> namedColumns;
+        std::map<int, size_t> numberedColumns;
+        bool stale = false;
+        int generation = 0;
+        std::chrono::steady_clock::time_point laidOut;
+    };
+    
+    MetricHistory m_history;
+    std::array<HistoryLayout, static_cast<size_t>(CollectorId::Count)> m_historyLayouts;
     
     std::chrono::steady_clock::time_point m_lastUpdate;
 };
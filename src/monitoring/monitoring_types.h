@@ -0,0 +1,319 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Monitor {
+
+struct CPUCoreInfo {
+    int coreID;
+    float frequency;                  // MHz, as sampled this tick
+    float temperature;
+    float usage;
+    float cState;                     // % of the tick in deep idle states
+    std::vector<float> idleResidency; // % per idle state, see GetCpuIdleStates
+};
+
+struct GPUInfo {
+    std::string name;
+    float coreClock;
+    float memoryClock;
+    float temperature;
+    float usage;
+    float memoryUsage;
+    float memoryTotal;
+    float powerUsage;
+    int fanSpeed;
+};
+
+struct RAMInfo {
+    float totalGB;
+    float usedGB;
+    float availableGB;
+    float usagePercent;
+    int speedMHz;
+    float latencyNs;
+    
+    // Breakdown; whatever a platform cannot see stays 0.
+    float cachedGB = 0.0f;             // file cache
+    float buffersGB = 0.0f;            // block-device metadata
+    float dirtyMB = 0.0f;              // modified, waiting for writeback
+    float writebackMB = 0.0f;          // being written back now
+    float slabGB = 0.0f;               // kernel allocator (pools on Windows)
+    float slabReclaimableGB = 0.0f;
+    float swapTotalGB = 0.0f;
+    float swapUsedGB = 0.0f;
+    float swapInMBps = 0.0f;
+    float swapOutMBps = 0.0f;
+    float hugePagesTotalGB = 0.0f;     // reserved explicit huge pages
+    float hugePagesUsedGB = 0.0f;
+    float transparentHugeGB = 0.0f;    // anonymous memory in huge pages
+    float committedGB = 0.0f;          // commit charge
+    float commitLimitGB = 0.0f;
+};
+
+struct DiskInfo {
+    std::string name;
+    float readMBps;
+    float writeMBps;
+    int readIOPS;
+    int writeIOPS;
+    float latencyMs;          // average per completed I/O
+    float temperature;
+    float usagePercent;       // space used
+    float queueDepth;         // average requests in flight
+    float busyPercent;        // time with at least one request in flight
+    std::vector<std::string> mountPoints;
+};
+
+struct NetworkInterfaceInfo {
+    std::string name;
+    float uploadMbps;
+    float downloadMbps;
+    float rxPacketsPerSec;
+    float txPacketsPerSec;
+    float rxDropsPerSec;
+    float txDropsPerSec;
+    float rxErrorsPerSec;
+    float txErrorsPerSec;
+};
+
+// Top-level fields aggregate every non-loopback interface; adapterName is
+// the busiest one. packetLoss is the percentage of packets dropped.
+struct NetworkInfo {
+    std::string adapterName;
+    float uploadMbps;
+    float downloadMbps;
+    float latencyMs;
+    float packetLoss;
+    float packetsPerSec;
+    float dropsPerSec;
+    float errorsPerSec;
+    std::vector<NetworkInterfaceInfo> interfaces;
+};
+
+struct ProcessInfo {
+    std::string name;
+    unsigned long pid;
+    float cpuUsage;
+    float gpuUsage;
+    float memoryMB;
+    int threads;
+    int handles;
+};
+
+enum class ThermalSensorKind {
+    CPUCore,
+    CPUPackage,
+    GPU,
+    Disk,
+    Other
+};
+
+// One temperature sensor, mapped once at discovery to the logical CPUs or
+// the device it measures.
+struct ThermalSensor {
+    ThermalSensorKind kind = ThermalSensorKind::Other;
+    std::string label;
+    std::string device;              // disk name for Disk sensors
+    std::vector<int> cpus;           // logical CPUs for CPUCore/CPUPackage
+    float temperature = 0.0f;
+    float criticalTemperature = 0.0f; // 0 when the sensor reports none
+};
+
+struct ThermalInfo {
+    std::vector<ThermalSensor> sensors;
+    float packageTemperature = 0.0f;   // hottest CPU package
+    uint64_t throttleEvents = 0;       // cumulative core + package events
+    uint32_t newThrottleEvents = 0;    // since the previous tick
+    bool frequencyCapped = false;      // a thermal cooling device limits the CPU
+    bool throttling = false;           // either of the two above, this tick
+};
+
+enum class PressureResource {
+    CPU,
+    Memory,
+    IO,
+    Count
+};
+
+// Pressure-stall information for one resource. "some" is time in which at
+// least one runnable task was stalled on the resource, "full" time in which
+// all of them were. Totals are cumulative; the stall fields cover the time
+// since the previous tick.
+struct PressureStall {
+    float someAvg10 = 0.0f;         // kernel's 10 s running average, %
+    float fullAvg10 = 0.0f;
+    uint64_t someTotalUs = 0;
+    uint64_t fullTotalUs = 0;
+    uint64_t someStallUs = 0;       // since the previous tick
+    uint64_t fullStallUs = 0;
+    float somePercent = 0.0f;       // share of wall time stalled this tick
+    float fullPercent = 0.0f;
+};
+
+struct PressureInfo {
+    std::string group;              // cgroup path; empty for the whole system
+    std::array<PressureStall, static_cast<size_t>(PressureResource::Count)> resources{};
+    
+    const PressureStall& operator[](PressureResource resource) const {
+        return resources[static_cast<size_t>(resource)];
+    }
+};
+
+// Kernel-side stall trigger: fires when tasks stall on the resource for at
+// least `stall` within any `window`, without waiting for a polling tick.
+// Linux only accepts windows that are multiples of 2 s from unprivileged
+// processes, hence the default.
+struct PressureTrigger {
+    PressureResource resource = PressureResource::Memory;
+    bool full = false;
+    std::chrono::microseconds stall{150000};
+    std::chrono::microseconds window{2000000};
+    std::string group;              // cgroup path; empty for the whole system
+};
+
+struct PressureEvent {
+    int triggerId = -1;
+    PressureTrigger trigger;
+    std::chrono::steady_clock::time_point time;
+};
+
+// One cgroup v2 group, counting itself and its descendants. Rates and
+// event counts cover the time since the previous tick. throttledPercent is
+// the share of that time the group's CPU quota kept it off the CPU, the
+// sign of quota starvation even when cpuPercent looks modest.
+struct CgroupInfo {
+    std::string path;                  // under the cgroup root, e.g. "system.slice/sshd.service"
+    int depth = 1;
+    float cpuPercent = 0.0f;           // % of one CPU
+    float throttledPercent = 0.0f;
+    uint64_t throttledPeriods = 0;
+    uint64_t memoryBytes = 0;          // memory.current
+    uint64_t memoryHighEvents = 0;     // reclaim forced by memory.high
+    uint64_t memoryMaxEvents = 0;      // allocations that hit memory.max
+    uint64_t oomKills = 0;
+    float ioReadMBps = 0.0f;
+    float ioWriteMBps = 0.0f;
+    std::vector<unsigned long> pids;   // processes directly in this group
+};
+
+// Raw per-process counters as a backend reads them. Counters are
+// cumulative; ProcessTracker turns them into rates between ticks.
+// startTime is any value that is fixed for the lifetime of a process, so
+// (pid, startTime) identifies it even when the PID is reused.
+struct ProcessSample {
+    unsigned long pid = 0;
+    uint64_t startTime = 0;
+    std::string name;
+    uint64_t cpuTimeNs = 0;
+    uint64_t residentBytes = 0;
+    int threads = 0;
+    int handles = 0;
+};
+
+// How one process's resident memory is shared. The proportional set size
+// splits each shared page between the processes mapping it, so PSS sums to
+// the real footprint across processes; the unique set size is what exiting
+// the process would free.
+struct ProcessMemoryInfo {
+    unsigned long pid = 0;
+    uint64_t residentBytes = 0;
+    uint64_t proportionalBytes = 0;    // PSS
+    uint64_t uniqueBytes = 0;          // USS
+    uint64_t sharedBytes = 0;
+    uint64_t swapBytes = 0;
+    std::chrono::steady_clock::time_point sampledAt;
+};
+
+// Memory of one NUMA node and the page allocations it served per second.
+// A hit is placed on the node the allocating task preferred; a miss landed
+// here because that node was short of memory, and counts as foreign on the
+// node that was preferred. remotePerSec counts pages placed here for tasks
+// running on another node. Platforms without the counters leave them 0.
+struct NumaNodeInfo {
+    int node = 0;
+    float totalGB = 0.0f;
+    float freeGB = 0.0f;
+    float usedGB = 0.0f;
+    float hitsPerSec = 0.0f;
+    float missesPerSec = 0.0f;
+    float foreignPerSec = 0.0f;
+    float remotePerSec = 0.0f;
+};
+
+// Resident pages of one process per NUMA node. homeNode is the node of the
+// CPU the process last ran on, or -1 where the platform does not report it.
+struct ProcessNumaInfo {
+    unsigned long pid = 0;
+    std::vector<uint64_t> nodeBytes;   // indexed by node id
+    int lastCpu = -1;
+    int homeNode = -1;
+    float remotePercent = 0.0f;        // resident bytes off homeNode
+    std::chrono::steady_clock::time_point sampledAt;
+};
+
+// Raw cumulative scheduler counters of one thread. Backends that cannot see
+// run-queue wait, switches or migrations leave those counters at zero.
+struct ThreadSample {
+    unsigned long tid = 0;
+    std::string name;
+    uint64_t runTimeNs = 0;           // on a CPU
+    uint64_t waitTimeNs = 0;          // runnable, waiting in a run queue
+    uint64_t timeslices = 0;
+    uint64_t voluntarySwitches = 0;
+    uint64_t involuntarySwitches = 0;
+    uint64_t migrations = 0;
+    int lastCpu = -1;
+};
+
+// Scheduling of one thread of the watched process over the last tick.
+struct ThreadSchedInfo {
+    unsigned long tid = 0;
+    std::string name;
+    float cpuUsage = 0.0f;            // % of one CPU
+    float runDelayPercent = 0.0f;     // % of the tick spent waiting for a CPU
+    float avgRunDelayUs = 0.0f;       // wait per timeslice
+    float voluntarySwitchesPerSec = 0.0f;
+    float involuntarySwitchesPerSec = 0.0f;
+    float migrationsPerSec = 0.0f;
+    int lastCpu = -1;
+};
+
+// Timer wakeup overshoot on one CPU, from the latency probe. Percentiles
+// cover the wakeups since the previous collector tick; peakUs the whole run.
+struct LatencyStats {
+    int cpu = -1;
+    uint64_t samples = 0;
+    uint64_t missedDeadlines = 0;     // periods skipped because a wakeup overran
+    float p50Us = 0.0f;
+    float p99Us = 0.0f;
+    float p999Us = 0.0f;
+    float maxUs = 0.0f;
+    float peakUs = 0.0f;
+};
+
+// Everything one monitoring tick produced. Published snapshots are immutable;
+// readers hold them through a SnapshotPublisher::Handle.
+struct SystemSnapshot {
+    uint64_t version = 0;
+    std::chrono::steady_clock::time_point timestamp;
+    
+    std::vector<CPUCoreInfo> cpu;
+    GPUInfo gpu{};
+    RAMInfo ram{};
+    std::vector<DiskInfo> disks;
+    NetworkInfo network{};
+    std::vector<ProcessInfo> processes;
+    ThermalInfo thermal;
+    std::vector<PressureInfo> pressure;   // whole system first, then cgroups
+    std::vector<NumaNodeInfo> numa;       // by node id
+    std::vector<CgroupInfo> cgroups;      // in hierarchy order, parents first
+    unsigned long threadsPid = 0;         // process behind `threads`, 0 if none
+    std::vector<ThreadSchedInfo> threads; // by run delay, worst first
+    std::vector<LatencyStats> latency;    // per probed CPU, empty when idle
+};
+
+}
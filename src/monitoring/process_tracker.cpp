@@ -0,0 +1,144 @@
+#include "process_tracker.h"
+#include <algorithm>
+#include <thread>
+
+namespace Monitor {
+
+namespace {
+
+constexpr double kBytesPerMB = 1024.0 * 1024.0;
+
+// A counter that went backwards belongs to a new thread that reused the TID.
+uint64_t Delta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : 0;
+}
+
+}
+
+ProcessTracker::ProcessTracker()
+    : m_cpuCount(std::max(1u, std::thread::hardware_concurrency())) {}
+
+void ProcessTracker::Reset() {
+    m_states.clear();
+    m_heap.clear();
+    m_hasSample = false;
+}
+
+void ProcessTracker::Update(std::span<const ProcessSample> samples, Clock::time_point now,
+                            size_t topCount, std::vector<ProcessInfo>& top) {
+    m_generation++;
+    
+    double elapsedNs = m_hasSample ? std::chrono::duration<double, std::nano>(now - m_prevSample).count() : 0.0;
+    double capacityNs = elapsedNs * m_cpuCount;
+    m_prevSample = now;
+    m_hasSample = true;
+    
+    // Heap of the busiest topCount processes seen so far, ordered so its
+    // front is the least busy one: the only entry a new process must beat.
+    auto busier = [](const Candidate& a, const Candidate& b) {
+        if (a.cpuUsage != b.cpuUsage) return a.cpuUsage > b.cpuUsage;
+        return a.residentBytes > b.residentBytes;
+    };
+    m_heap.clear();
+    
+    for (size_t i = 0; i < samples.size(); i++) {
+        const ProcessSample& sample = samples[i];
+        
+        auto [it, inserted] = m_states.try_emplace(Key{sample.pid, sample.startTime});
+        State& state = it->second;
+        
+        float cpuUsage = 0.0f;
+        if (!inserted && capacityNs > 0.0 && sample.cpuTimeNs >= state.cpuTimeNs) {
+            cpuUsage = static_cast<float>(std::min(100.0, 100.0 * (sample.cpuTimeNs - state.cpuTimeNs) / capacityNs));
+        }
+        state.cpuTimeNs = sample.cpuTimeNs;
+        state.generation = m_generation;
+        
+        if (topCount == 0) continue;
+        
+        Candidate candidate{cpuUsage, sample.residentBytes, i};
+        if (m_heap.size() < topCount) {
+            m_heap.push_back(candidate);
+            std::push_heap(m_heap.begin(), m_heap.end(), busier);
+        } else if (busier(candidate, m_heap.front())) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), busier);
+            m_heap.back() = candidate;
+            std::push_heap(m_heap.begin(), m_heap.end(), busier);
+        }
+    }
+    
+    // Every live process was touched above, so anything older has exited.
+    if (m_states.size() > samples.size()) {
+        std::erase_if(m_states, [this](const auto& entry) { return entry.second.generation != m_generation; });
+    }
+    
+    std::sort(m_heap.begin(), m_heap.end(), busier);
+    
+    top.resize(m_heap.size());
+    for (size_t i = 0; i < m_heap.size(); i++) {
+        const ProcessSample& sample = samples[m_heap[i].index];
+        ProcessInfo& info = top[i];
+        info.name = sample.name;
+        info.pid = sample.pid;
+        info.cpuUsage = m_heap[i].cpuUsage;
+        info.gpuUsage = 0.0f;
+        info.memoryMB = static_cast<float>(sample.residentBytes / kBytesPerMB);
+        info.threads = sample.threads;
+        info.handles = sample.handles;
+    }
+}
+
+void ThreadTracker::Reset() {
+    m_states.clear();
+    m_hasSample = false;
+}
+
+void ThreadTracker::Update(std::span<const ThreadSample> samples, Clock::time_point now,
+                           std::vector<ThreadSchedInfo>& threads) {
+    m_generation++;
+    
+    double elapsedNs = m_hasSample ? std::chrono::duration<double, std::nano>(now - m_prevSample).count() : 0.0;
+    m_prevSample = now;
+    m_hasSample = true;
+    
+    threads.resize(samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        const ThreadSample& sample = samples[i];
+        ThreadSchedInfo& info = threads[i];
+        info = ThreadSchedInfo{};
+        info.tid = sample.tid;
+        info.name = sample.name;
+        info.lastCpu = sample.lastCpu;
+        
+        auto [it, inserted] = m_states.try_emplace(sample.tid);
+        State& state = it->second;
+        
+        if (!inserted && elapsedNs > 0.0) {
+            const ThreadSample& prev = state.counters;
+            double perSecond = 1e9 / elapsedNs;
+            uint64_t waitNs = Delta(sample.waitTimeNs, prev.waitTimeNs);
+            uint64_t slices = Delta(sample.timeslices, prev.timeslices);
+            
+            info.cpuUsage = static_cast<float>(std::min(100.0, 100.0 * Delta(sample.runTimeNs, prev.runTimeNs) / elapsedNs));
+            info.runDelayPercent = static_cast<float>(std::min(100.0, 100.0 * waitNs / elapsedNs));
+            info.avgRunDelayUs = slices > 0 ? static_cast<float>(waitNs / 1000.0 / slices) : 0.0f;
+            info.voluntarySwitchesPerSec = static_cast<float>(Delta(sample.voluntarySwitches, prev.voluntarySwitches) * perSecond);
+            info.involuntarySwitchesPerSec = static_cast<float>(Delta(sample.involuntarySwitches, prev.involuntarySwitches) * perSecond);
+            info.migrationsPerSec = static_cast<float>(Delta(sample.migrations, prev.migrations) * perSecond);
+        }
+        
+        state.counters = sample;
+        state.generation = m_generation;
+    }
+    
+    if (m_states.size() > samples.size()) {
+        std::erase_if(m_states, [this](const auto& entry) { return entry.second.generation != m_generation; });
+    }
+    
+    std::sort(threads.begin(), threads.end(), [](const ThreadSchedInfo& a, const ThreadSchedInfo& b) {
+        if (a.runDelayPercent != b.runDelayPercent) return a.runDelayPercent > b.runDelayPercent;
+        return a.cpuUsage > b.cpuUsage;
+    });
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "monitoring_types.h"
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace Monitor {
+
+// Per-process state kept between process collector ticks. Turns the
+// backend's cumulative counters into CPU usage and selects the busiest
+// processes without sorting the whole list. State is keyed by PID plus
+// start time, so a reused PID starts from a fresh baseline instead of
+// inheriting the previous owner's counters.
+class ProcessTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    ProcessTracker();
+    
+    // Fills `top` with up to topCount processes ordered by CPU usage, then
+    // resident memory. CPU usage is a share of the whole machine (0-100);
+    // processes seen for the first time report 0 until their next tick.
+    void Update(std::span<const ProcessSample> samples, Clock::time_point now,
+                size_t topCount, std::vector<ProcessInfo>& top);
+    
+    size_t GetTrackedCount() const { return m_states.size(); }
+    void Reset();
+    
+private:
+    struct Key {
+        unsigned long pid;
+        uint64_t startTime;
+        
+        bool operator==(const Key& other) const = default;
+    };
+    
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>()((static_cast<uint64_t>(key.pid) << 32) ^ key.startTime);
+        }
+    };
+    
+    struct State {
+        uint64_t cpuTimeNs = 0;
+        uint64_t generation = 0;
+    };
+    
+    struct Candidate {
+        float cpuUsage;
+        uint64_t residentBytes;
+        size_t index;
+    };
+    
+    std::unordered_map<Key, State, KeyHash> m_states;
+    std::vector<Candidate> m_heap;
+    uint64_t m_generation = 0;
+    unsigned int m_cpuCount;
+    
+    Clock::time_point m_prevSample;
+    bool m_hasSample = false;
+};
+
+// Per-thread scheduler state of one watched process. Turns the backend's
+// cumulative counters into per-tick run-queue delay, CPU usage and switch
+// rates. Threads seen for the first time report zeros until their next tick.
+class ThreadTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    // Fills `threads` ordered by run delay, worst first.
+    void Update(std::span<const ThreadSample> samples, Clock::time_point now,
+                std::vector<ThreadSchedInfo>& threads);
+    
+    void Reset();
+    
+private:
+    struct State {
+        ThreadSample counters;
+        uint64_t generation = 0;
+    };
+    
+    std::unordered_map<unsigned long, State> m_states;
+    uint64_t m_generation = 0;
+    
+    Clock::time_point m_prevSample;
+    bool m_hasSample = false;
+};
+
+}
@@ -0,0 +1,180 @@
+#include "replay_backend.h"
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+std::unique_ptr<ReplayBackend> ReplayBackend::Create(const ReplayConfig& config) {
+    if (config.speed < 0.0) {
+        spdlog::error("Replay speed {} is negative", config.speed);
+        return nullptr;
+    }
+    
+    std::unique_ptr<ReplayBackend> backend(new ReplayBackend(config));
+    if (!backend->m_reader.Open(config.directory)) return nullptr;
+    
+    int64_t fromUs = config.fromUs ? config.fromUs : backend->m_reader.GetFirstTimestampUs();
+    backend->m_lastUs = config.toUs ? config.toUs : backend->m_reader.GetLastTimestampUs();
+    
+    bool found = false;
+    backend->m_reader.ReadRange(fromUs, backend->m_lastUs,
+                                [&](int64_t timestampUs, CollectorMask, const SystemSnapshot& snapshot) {
+        backend->m_state = snapshot;
+        backend->m_firstUs = timestampUs;
+        found = true;
+        return false;
+    });
+    if (!found) {
+        spdlog::error("No telemetry records in {} between {} and {}", config.directory, fromUs, backend->m_lastUs);
+        return nullptr;
+    }
+    
+    spdlog::info("Replaying {:.1f} s of telemetry from {} at {}", (backend->m_lastUs - backend->m_firstUs) / 1e6,
+                 config.directory, config.speed > 0.0 ? fmt::format("{}x", config.speed) : "full speed");
+    return backend;
+}
+
+ReplayBackend::~ReplayBackend() {
+    StopFeed();
+}
+
+bool ReplayBackend::StartFeed(SnapshotFeed feed) {
+    StopFeed();
+    
+    m_records = 0;
+    m_loops = 0;
+    m_finished = false;
+    m_feeding = true;
+    m_thread = std::thread(&ReplayBackend::FeedThread, this, std::move(feed));
+    return true;
+}
+
+void ReplayBackend::StopFeed() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_feeding = false;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+ReplayProgress ReplayBackend::GetProgress() const {
+    ReplayProgress progress;
+    progress.records = m_records;
+    progress.loops = m_loops;
+    progress.positionUs = m_positionUs;
+    progress.firstUs = m_firstUs;
+    progress.lastUs = m_lastUs;
+    progress.finished = m_finished;
+    return progress;
+}
+
+void ReplayBackend::FeedThread(SnapshotFeed feed) {
+    while (m_feeding) {
+        // Each pass is paced against its own start, so a slow consumer
+        // delays the records after it but the replay never drifts.
+        auto origin = std::chrono::steady_clock::now();
+        bool first = true;
+        
+        bool intact = m_reader.ReadRange(m_firstUs, m_lastUs,
+                                         [&](int64_t timestampUs, CollectorMask changed, const SystemSnapshot& snapshot) {
+            if (m_config.speed > 0.0) {
+                auto due = origin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::micro>((timestampUs - m_firstUs) / m_config.speed));
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_until(lock, due, [this] { return !m_feeding; });
+            }
+            if (!m_feeding) return false;
+            
+            // The engine starts out empty, and a loop starts over.
+            if (first) changed = kAllCollectors;
+            first = false;
+            feed(snapshot, changed);
+            
+            {
+                std::lock_guard<std::mutex> lock(m_stateMutex);
+                for (size_t i = 0; i < static_cast<size_t>(CollectorId::Count); i++) {
+                    auto id = static_cast<CollectorId>(i);
+                    if (changed & CollectorBit(id)) CopyCollectorPart(id, snapshot, m_state);
+                }
+            }
+            m_positionUs = timestampUs;
+            m_records++;
+            return true;
+        });
+        
+        if (!intact) spdlog::warn("Replay of {} skipped damaged telemetry records", m_config.directory);
+        if (!m_config.loop || !m_feeding) break;
+        m_loops++;
+    }
+    
+    if (m_feeding) spdlog::info("Replay of {} finished after {} records", m_config.directory, m_records.load());
+    m_finished = true;
+}
+
+template <typename T>
+bool ReplayBackend::CopyState(T SystemSnapshot::*member, T& out) const {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    out = m_state.*member;
+    return true;
+}
+
+std::vector<std::string> ReplayBackend::GetCpuIdleStates() const {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::vector<std::string> states;
+    if (m_state.cpu.empty()) return states;
+    
+    // Only the residencies were recorded, not what the states are called.
+    for (size_t i = 0; i < m_state.cpu.front().idleResidency.size(); i++) {
+        states.push_back("state" + std::to_string(i));
+    }
+    return states;
+}
+
+bool ReplayBackend::DiscoverTopology(TopologySource& source) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    for (const auto& core : m_state.cpu) {
+        LogicalCpu cpu;
+        cpu.id = core.coreID;
+        cpu.core = core.coreID;
+        source.cpus.push_back(cpu);
+    }
+    return !source.cpus.empty();
+}
+
+bool ReplayBackend::CollectCPU(std::vector<CPUCoreInfo>& cores) {
+    return CopyState(&SystemSnapshot::cpu, cores);
+}
+
+bool ReplayBackend::CollectGPU(GPUInfo& gpu) {
+    return CopyState(&SystemSnapshot::gpu, gpu);
+}
+
+bool ReplayBackend::CollectRAM(RAMInfo& ram) {
+    return CopyState(&SystemSnapshot::ram, ram);
+}
+
+bool ReplayBackend::CollectDisks(std::vector<DiskInfo>& disks) {
+    return CopyState(&SystemSnapshot::disks, disks);
+}
+
+bool ReplayBackend::CollectNetwork(NetworkInfo& network) {
+    return CopyState(&SystemSnapshot::network, network);
+}
+
+bool ReplayBackend::CollectThermal(ThermalInfo& thermal) {
+    return CopyState(&SystemSnapshot::thermal, thermal);
+}
+
+bool ReplayBackend::CollectNuma(std::vector<NumaNodeInfo>& nodes) {
+    return CopyState(&SystemSnapshot::numa, nodes);
+}
+
+bool ReplayBackend::CollectCgroups(std::vector<CgroupInfo>& groups) {
+    return CopyState(&SystemSnapshot::cgroups, groups);
+}
+
+bool ReplayBackend::CollectPressure(std::vector<PressureInfo>& pressure) {
+    return CopyState(&SystemSnapshot::pressure, pressure);
+}
+
+}
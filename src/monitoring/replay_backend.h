@@ -0,0 +1,101 @@
+#pragma once
+#include "collector_backend.h"
+#include "telemetry_reader.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Monitor {
+
+struct ReplayConfig {
+    std::string directory = "telemetry";
+    double speed = 1.0;             // multiple of recorded time; 0 replays unthrottled
+    int64_t fromUs = 0;             // recorded wall-clock µs; 0 for the start
+    int64_t toUs = 0;               // 0 for the end
+    bool loop = false;
+};
+
+struct ReplayProgress {
+    uint64_t records = 0;           // fed so far, across loops
+    uint64_t loops = 0;
+    int64_t positionUs = 0;         // recorded time of the last record fed
+    int64_t firstUs = 0;
+    int64_t lastUs = 0;
+    bool finished = false;
+};
+
+// Plays a TelemetryRecorder session back into MonitoringEngine in place of
+// the machine. Records are fed from a thread of the backend's own, one
+// engine publish each, carrying every part exactly as it was recorded and
+// naming the same changed collectors, so subscribers see the sequence they
+// saw live; only the snapshot timestamps follow the replay clock. With a
+// speed of 0 each record is fed as soon as the previous publish returns.
+// The Collect* methods answer from the last record fed, for callers that
+// poll the backend directly; processes and threads were recorded as rates
+// rather than counters, so those two are unavailable there.
+class ReplayBackend : public CollectorBackend {
+public:
+    // nullptr when the directory holds no readable recording.
+    static std::unique_ptr<ReplayBackend> Create(const ReplayConfig& config);
+    ~ReplayBackend() override;
+    
+    const char* GetName() const override { return "Replay"; }
+    std::vector<std::string> GetCpuIdleStates() const override;
+    
+    // The layout is not recorded: one core per recorded CPU, on one node.
+    bool DiscoverTopology(TopologySource& source) override;
+    
+    bool CollectCPU(std::vector<CPUCoreInfo>& cores) override;
+    bool CollectGPU(GPUInfo& gpu) override;
+    bool CollectRAM(RAMInfo& ram) override;
+    bool CollectDisks(std::vector<DiskInfo>& disks) override;
+    bool CollectNetwork(NetworkInfo& network) override;
+    bool CollectProcesses(std::vector<ProcessSample>&) override { return false; }
+    bool CollectThermal(ThermalInfo& thermal) override;
+    bool CollectThreads(unsigned long, std::vector<ThreadSample>&) override { return false; }
+    bool QueryProcessMemory(unsigned long, ProcessMemoryInfo&) override { return false; }
+    bool CollectNuma(std::vector<NumaNodeInfo>& nodes) override;
+    bool CollectCgroups(std::vector<CgroupInfo>& groups) override;
+    bool QueryProcessNuma(unsigned long, ProcessNumaInfo&) override { return false; }
+    bool CollectPressure(std::vector<PressureInfo>& pressure) override;
+    
+    bool StartFeed(SnapshotFeed feed) override;
+    void StopFeed() override;
+    
+    ReplayProgress GetProgress() const;
+    
+private:
+    explicit ReplayBackend(const ReplayConfig& config) : m_config(config) {}
+    
+    void FeedThread(SnapshotFeed feed);
+    
+    template <typename T>
+    bool CopyState(T SystemSnapshot::*member, T& out) const;
+    
+    ReplayConfig m_config;
+    TelemetryReader m_reader;
+    int64_t m_firstUs = 0;
+    int64_t m_lastUs = 0;
+    
+    // Last record fed; seeded with the first one so that the topology and
+    // polled collectors have data before the feed starts.
+    mutable std::mutex m_stateMutex;
+    SystemSnapshot m_state;
+    
+    std::thread m_thread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_feeding{false};
+    
+    std::atomic<uint64_t> m_records{0};
+    std::atomic<uint64_t> m_loops{0};
+    std::atomic<int64_t> m_positionUs{0};
+    std::atomic<bool> m_finished{false};
+};
+
+}
@@ -0,0 +1,76 @@
+#include "snapshot_publisher.h"
+#include <utility>
+
+namespace Monitor {
+
+SnapshotPublisher::Handle::Handle(Handle&& other) noexcept
+    : m_readers(std::exchange(other.m_readers, nullptr)),
+      m_snapshot(std::exchange(other.m_snapshot, nullptr)) {}
+
+SnapshotPublisher::Handle& SnapshotPublisher::Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        Release();
+        m_readers = std::exchange(other.m_readers, nullptr);
+        m_snapshot = std::exchange(other.m_snapshot, nullptr);
+    }
+    return *this;
+}
+
+SnapshotPublisher::Handle::~Handle() {
+    Release();
+}
+
+void SnapshotPublisher::Handle::Release() {
+    if (m_readers) {
+        m_readers->fetch_sub(1, std::memory_order_release);
+        m_readers = nullptr;
+        m_snapshot = nullptr;
+    }
+}
+
+SnapshotPublisher::Handle SnapshotPublisher::Acquire() const {
+    for (;;) {
+        int index = m_current.load(std::memory_order_seq_cst);
+        Slot& slot = m_slots[index];
+        
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        
+        // The pin only counts if the slot is still current; otherwise the
+        // writer may already be refilling it. Retrying is bounded by the
+        // publish rate, so in practice this loop runs once.
+        if (m_current.load(std::memory_order_seq_cst) == index) {
+            return Handle(&slot.readers, &slot.snapshot);
+        }
+        
+        slot.readers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+SystemSnapshot* SnapshotPublisher::BeginWrite() {
+    int current = m_current.load(std::memory_order_relaxed);
+    
+    for (int i = 1; i < kSlotCount; i++) {
+        int index = (current + i) % kSlotCount;
+        if (m_slots[index].readers.load(std::memory_order_seq_cst) == 0) {
+            m_writing = index;
+            return &m_slots[index].snapshot;
+        }
+    }
+    
+    m_writing = -1;
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void SnapshotPublisher::Publish() {
+    if (m_writing < 0) return;
+    
+    uint64_t version = m_version.load(std::memory_order_relaxed) + 1;
+    m_slots[m_writing].snapshot.version = version;
+    
+    m_current.store(m_writing, std::memory_order_seq_cst);
+    m_version.store(version, std::memory_order_release);
+    m_writing = -1;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "monitoring_types.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Monitor {
+
+// Single-writer, many-reader publication of SystemSnapshot. The writer fills a
+// slot no reader has pinned and swaps the current index; readers pin the
+// current slot with one atomic increment, so they never take a lock, never
+// allocate and never see a half-written snapshot.
+class SnapshotPublisher {
+public:
+    static constexpr int kSlotCount = 4;
+    
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) noexcept;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle();
+        
+        const SystemSnapshot& operator*() const { return *m_snapshot; }
+        const SystemSnapshot* operator->() const { return m_snapshot; }
+        explicit operator bool() const { return m_snapshot != nullptr; }
+        
+    private:
+        friend class SnapshotPublisher;
+        Handle(std::atomic<int>* readers, const SystemSnapshot* snapshot)
+            : m_readers(readers), m_snapshot(snapshot) {}
+        
+        void Release();
+        
+        std::atomic<int>* m_readers = nullptr;
+        const SystemSnapshot* m_snapshot = nullptr;
+    };
+    
+    SnapshotPublisher() = default;
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+    
+    Handle Acquire() const;
+    
+    // Writer side. BeginWrite returns a free slot, or nullptr when every other
+    // slot is still pinned by readers; the tick is then dropped.
+    SystemSnapshot* BeginWrite();
+    void Publish();
+    
+    uint64_t GetVersion() const { return m_version.load(std::memory_order_acquire); }
+    uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    
+private:
+    struct alignas(64) Slot {
+        std::atomic<int> readers{0};
+        SystemSnapshot snapshot;
+    };
+    
+    mutable std::array<Slot, kSlotCount> m_slots;
+    std::atomic<int> m_current{0};
+    std::atomic<uint64_t> m_version{0};
+    std::atomic<uint64_t> m_dropped{0};
+    int m_writing = -1;
+};
+
+}
@@ -0,0 +1,167 @@
+#include "subscription_hub.h"
+#include <algorithm>
+#include <utility>
+
+namespace Monitor {
+
+SubscriptionHub::~SubscriptionHub() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_changed.notify_all();
+    
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+int SubscriptionHub::Subscribe(CollectorMask groups, Callback callback, std::chrono::milliseconds interval) {
+    return Add(groups, interval, std::make_shared<const Callback>(std::move(callback)));
+}
+
+int SubscriptionHub::Subscribe(CollectorMask groups, std::chrono::milliseconds interval) {
+    return Add(groups, interval, nullptr);
+}
+
+int SubscriptionHub::Add(CollectorMask groups, std::chrono::milliseconds interval, std::shared_ptr<const Callback> callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    bool needsThread = callback && !m_thread.joinable();
+    
+    int id = m_nextId++;
+    Subscriber& subscriber = m_subscribers[id];
+    subscriber.groups = groups & kAllCollectors;
+    subscriber.interval = std::max(interval, std::chrono::milliseconds(0));
+    subscriber.callback = std::move(callback);
+    
+    // Callback subscribers get the current snapshot right away rather than
+    // waiting for the next publish of their slowest group.
+    if (subscriber.callback && m_publisher.GetVersion() > 0) {
+        subscriber.pending = subscriber.groups;
+        m_changed.notify_all();
+    }
+    
+    if (needsThread) {
+        m_thread = std::thread(&SubscriptionHub::DeliveryThread, this);
+    }
+    return id;
+}
+
+void SubscriptionHub::Unsubscribe(int id) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_subscribers.erase(id);
+    m_changed.notify_all();
+    
+    if (std::this_thread::get_id() != m_thread.get_id()) {
+        m_delivered.wait(lock, [&] { return m_delivering != id; });
+    }
+}
+
+void SubscriptionHub::SetGroups(int id, CollectorMask groups) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_subscribers.find(id);
+    if (it == m_subscribers.end()) return;
+    
+    it->second.groups = groups & kAllCollectors;
+    it->second.pending &= it->second.groups;
+}
+
+void SubscriptionHub::SetInterval(int id, std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_subscribers.find(id);
+    if (it != m_subscribers.end()) it->second.interval = std::max(interval, std::chrono::milliseconds(0));
+}
+
+CollectorMask SubscriptionHub::Poll(int id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_subscribers.find(id);
+    if (it == m_subscribers.end()) return 0;
+    return std::exchange(it->second.pending, 0);
+}
+
+CollectorMask SubscriptionHub::Wait(int id, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    CollectorMask changed = 0;
+    
+    m_changed.wait_for(lock, timeout, [&] {
+        auto it = m_subscribers.find(id);
+        if (it == m_subscribers.end() || m_stopping) return true;
+        changed = std::exchange(it->second.pending, 0);
+        return changed != 0;
+    });
+    return changed;
+}
+
+void SubscriptionHub::Notify(CollectorMask sources) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_notifiedVersion.store(m_publisher.GetVersion(), std::memory_order_release);
+        for (auto& [id, subscriber] : m_subscribers) {
+            if (subscriber.groups & sources) {
+                subscriber.pending |= subscriber.groups & sources;
+                wake = true;
+            }
+        }
+    }
+    if (wake) m_changed.notify_all();
+}
+
+CollectorMask SubscriptionHub::GetDemand() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CollectorMask demand = 0;
+    for (const auto& [id, subscriber] : m_subscribers) {
+        demand |= subscriber.groups;
+    }
+    return demand;
+}
+
+std::chrono::milliseconds SubscriptionHub::GetDemandInterval(CollectorId id, std::chrono::milliseconds fallback) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::chrono::milliseconds shortest{0};
+    for (const auto& [subscriberId, subscriber] : m_subscribers) {
+        if (!(subscriber.groups & CollectorBit(id))) continue;
+        auto interval = subscriber.interval.count() > 0 ? subscriber.interval : fallback;
+        if (shortest.count() == 0 || interval < shortest) shortest = interval;
+    }
+    return shortest;
+}
+
+void SubscriptionHub::DeliveryThread() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    auto nextPending = [&](int after) {
+        for (auto it = m_subscribers.upper_bound(after); it != m_subscribers.end(); ++it) {
+            if (it->second.callback && it->second.pending) return it;
+        }
+        return m_subscribers.end();
+    };
+    
+    while (!m_stopping) {
+        m_changed.wait(lock, [&] { return m_stopping || nextPending(0) != m_subscribers.end(); });
+        
+        // One pass in id order. Marks that arrive while a callback runs
+        // merge into its next delivery, which then carries only the newest
+        // snapshot.
+        for (auto it = nextPending(0); it != m_subscribers.end() && !m_stopping; ) {
+            int id = it->first;
+            CollectorMask changed = std::exchange(it->second.pending, 0);
+            auto callback = it->second.callback;
+            m_delivering = id;
+            
+            lock.unlock();
+            {
+                auto snapshot = m_publisher.Acquire();
+                (*callback)(snapshot, changed);
+            }
+            lock.lock();
+            
+            m_delivering = 0;
+            m_delivered.notify_all();
+            it = nextPending(id);
+        }
+    }
+}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "collector_scheduler.h"
+#include "snapshot_publisher.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Monitor {
+
+// Push delivery of published snapshots. A subscriber names the collectors
+// it reads; each publish marks the subscribers of the collector behind it
+// as pending, and marks merge until they are delivered, so a consumer that
+// falls behind skips straight to the newest snapshot instead of working
+// through a backlog of stale ones.
+class SubscriptionHub {
+public:
+    using Callback = std::function<void(const SnapshotPublisher::Handle& snapshot, CollectorMask changed)>;
+    
+    explicit SubscriptionHub(const SnapshotPublisher& publisher) : m_publisher(publisher) {}
+    ~SubscriptionHub();
+    
+    SubscriptionHub(const SubscriptionHub&) = delete;
+    SubscriptionHub& operator=(const SubscriptionHub&) = delete;
+    
+    // Callbacks run one at a time on the hub's delivery thread, never on a
+    // collector lane, so a slow one delays other subscribers but never a
+    // sample. `interval` is how often the subscriber wants its groups
+    // sampled; zero takes each collector's configured period.
+    int Subscribe(CollectorMask groups, Callback callback, std::chrono::milliseconds interval = {});
+    
+    // Signal-only subscription for consumers with their own loop; changes
+    // are collected with Poll or Wait.
+    int Subscribe(CollectorMask groups, std::chrono::milliseconds interval = {});
+    
+    // Waits for a callback in flight to return, unless called from it, and
+    // wakes a Wait on `id`.
+    void Unsubscribe(int id);
+    void SetGroups(int id, CollectorMask groups);
+    void SetInterval(int id, std::chrono::milliseconds interval);
+    
+    // Collectors that published since the last call, and clears them; 0
+    // when nothing changed. Wait blocks up to `timeout` for a change.
+    CollectorMask Poll(int id);
+    CollectorMask Wait(int id, std::chrono::milliseconds timeout);
+    
+    // Called by the writer after each publish, with the collectors whose
+    // parts it changed.
+    void Notify(CollectorMask sources);
+    
+    // Version of the newest snapshot whose publish has been notified. A
+    // snapshot acquired ahead of it may hold changes no mark names yet.
+    uint64_t GetNotifiedVersion() const { return m_notifiedVersion.load(std::memory_order_acquire); }
+    
+    // Union of every subscriber's groups.
+    CollectorMask GetDemand() const;
+    
+    // Shortest interval any subscriber of `id` asks for, with `fallback`
+    // standing in for those that leave it at zero; zero when nobody
+    // subscribes to `id`.
+    std::chrono::milliseconds GetDemandInterval(CollectorId id, std::chrono::milliseconds fallback) const;
+    
+private:
+    struct Subscriber {
+        CollectorMask groups = 0;
+        CollectorMask pending = 0;
+        std::chrono::milliseconds interval{0};
+        std::shared_ptr<const Callback> callback;
+    };
+    
+    int Add(CollectorMask groups, std::chrono::milliseconds interval, std::shared_ptr<const Callback> callback);
+    void DeliveryThread();
+    
+    const SnapshotPublisher& m_publisher;
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;      // pending marks set, or stopping
+    std::condition_variable m_delivered;    // a callback returned
+    std::map<int, Subscriber> m_subscribers;
+    int m_nextId = 1;
+    int m_delivering = 0;                   // subscriber whose callback runs
+    bool m_stopping = false;
+    std::thread m_thread;
+    std::atomic<uint64_t> m_notifiedVersion{0};
+};
+
+}
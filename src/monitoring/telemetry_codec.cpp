@@ -0,0 +1,515 @@
+#include "telemetry_codec.h"
+#include <array>
+#include <bit>
+
+namespace Monitor {
+
+namespace {
+
+constexpr std::array<uint32_t, 256> MakeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kCrcTable = MakeCrcTable();
+
+template <typename T, typename Write>
+void PutList(ByteWriter& out, const std::vector<T>& items, Write write) {
+    out.PutVarint(items.size());
+    for (const auto& item : items) write(out, item);
+}
+
+// Resizing reuses the elements, and their strings and vectors, left over
+// from the previous record.
+template <typename T, typename Read>
+void GetList(ByteReader& in, std::vector<T>& items, Read read) {
+    items.resize(in.GetCount());
+    for (auto& item : items) read(in, item);
+}
+
+void Write(ByteWriter& out, const CPUCoreInfo& core) {
+    out.PutSigned(core.coreID);
+    out.PutFloat(core.frequency);
+    out.PutFloat(core.temperature);
+    out.PutFloat(core.usage);
+    out.PutFloat(core.cState);
+    PutList(out, core.idleResidency, [](ByteWriter& w, float value) { w.PutFloat(value); });
+}
+
+void Read(ByteReader& in, CPUCoreInfo& core) {
+    core.coreID = static_cast<int>(in.GetSigned());
+    core.frequency = in.GetFloat();
+    core.temperature = in.GetFloat();
+    core.usage = in.GetFloat();
+    core.cState = in.GetFloat();
+    GetList(in, core.idleResidency, [](ByteReader& r, float& value) { value = r.GetFloat(); });
+}
+
+void Write(ByteWriter& out, const GPUInfo& gpu) {
+    out.PutString(gpu.name);
+    out.PutFloat(gpu.coreClock);
+    out.PutFloat(gpu.memoryClock);
+    out.PutFloat(gpu.temperature);
+    out.PutFloat(gpu.usage);
+    out.PutFloat(gpu.memoryUsage);
+    out.PutFloat(gpu.memoryTotal);
+    out.PutFloat(gpu.powerUsage);
+    out.PutSigned(gpu.fanSpeed);
+}
+
+void Read(ByteReader& in, GPUInfo& gpu) {
+    in.GetString(gpu.name);
+    gpu.coreClock = in.GetFloat();
+    gpu.memoryClock = in.GetFloat();
+    gpu.temperature = in.GetFloat();
+    gpu.usage = in.GetFloat();
+    gpu.memoryUsage = in.GetFloat();
+    gpu.memoryTotal = in.GetFloat();
+    gpu.powerUsage = in.GetFloat();
+    gpu.fanSpeed = static_cast<int>(in.GetSigned());
+}
+
+// RAMInfo is all floats but for speedMHz; they go in declaration order.
+constexpr float RAMInfo::* kRamFloats[] = {
+    &RAMInfo::totalGB, &RAMInfo::usedGB, &RAMInfo::availableGB, &RAMInfo::usagePercent, &RAMInfo::latencyNs,
+    &RAMInfo::cachedGB, &RAMInfo::buffersGB, &RAMInfo::dirtyMB, &RAMInfo::writebackMB, &RAMInfo::slabGB,
+    &RAMInfo::slabReclaimableGB, &RAMInfo::swapTotalGB, &RAMInfo::swapUsedGB, &RAMInfo::swapInMBps,
+    &RAMInfo::swapOutMBps, &RAMInfo::hugePagesTotalGB, &RAMInfo::hugePagesUsedGB, &RAMInfo::transparentHugeGB,
+    &RAMInfo::committedGB, &RAMInfo::commitLimitGB
+};
+
+void Write(ByteWriter& out, const RAMInfo& ram) {
+    out.PutSigned(ram.speedMHz);
+    for (auto field : kRamFloats) out.PutFloat(ram.*field);
+}
+
+void Read(ByteReader& in, RAMInfo& ram) {
+    ram.speedMHz = static_cast<int>(in.GetSigned());
+    for (auto field : kRamFloats) ram.*field = in.GetFloat();
+}
+
+void Write(ByteWriter& out, const DiskInfo& disk) {
+    out.PutString(disk.name);
+    out.PutFloat(disk.readMBps);
+    out.PutFloat(disk.writeMBps);
+    out.PutSigned(disk.readIOPS);
+    out.PutSigned(disk.writeIOPS);
+    out.PutFloat(disk.latencyMs);
+    out.PutFloat(disk.temperature);
+    out.PutFloat(disk.usagePercent);
+    out.PutFloat(disk.queueDepth);
+    out.PutFloat(disk.busyPercent);
+    PutList(out, disk.mountPoints, [](ByteWriter& w, const std::string& value) { w.PutString(value); });
+}
+
+void Read(ByteReader& in, DiskInfo& disk) {
+    in.GetString(disk.name);
+    disk.readMBps = in.GetFloat();
+    disk.writeMBps = in.GetFloat();
+    disk.readIOPS = static_cast<int>(in.GetSigned());
+    disk.writeIOPS = static_cast<int>(in.GetSigned());
+    disk.latencyMs = in.GetFloat();
+    disk.temperature = in.GetFloat();
+    disk.usagePercent = in.GetFloat();
+    disk.queueDepth = in.GetFloat();
+    disk.busyPercent = in.GetFloat();
+    GetList(in, disk.mountPoints, [](ByteReader& r, std::string& value) { r.GetString(value); });
+}
+
+constexpr float NetworkInterfaceInfo::* kInterfaceFloats[] = {
+    &NetworkInterfaceInfo::uploadMbps, &NetworkInterfaceInfo::downloadMbps,
+    &NetworkInterfaceInfo::rxPacketsPerSec, &NetworkInterfaceInfo::txPacketsPerSec,
+    &NetworkInterfaceInfo::rxDropsPerSec, &NetworkInterfaceInfo::txDropsPerSec,
+    &NetworkInterfaceInfo::rxErrorsPerSec, &NetworkInterfaceInfo::txErrorsPerSec
+};
+
+constexpr float NetworkInfo::* kNetworkFloats[] = {
+    &NetworkInfo::uploadMbps, &NetworkInfo::downloadMbps, &NetworkInfo::latencyMs, &NetworkInfo::packetLoss,
+    &NetworkInfo::packetsPerSec, &NetworkInfo::dropsPerSec, &NetworkInfo::errorsPerSec
+};
+
+void Write(ByteWriter& out, const NetworkInfo& network) {
+    out.PutString(network.adapterName);
+    for (auto field : kNetworkFloats) out.PutFloat(network.*field);
+    PutList(out, network.interfaces, [](ByteWriter& w, const NetworkInterfaceInfo& iface) {
+        w.PutString(iface.name);
+        for (auto field : kInterfaceFloats) w.PutFloat(iface.*field);
+    });
+}
+
+void Read(ByteReader& in, NetworkInfo& network) {
+    in.GetString(network.adapterName);
+    for (auto field : kNetworkFloats) network.*field = in.GetFloat();
+    GetList(in, network.interfaces, [](ByteReader& r, NetworkInterfaceInfo& iface) {
+        r.GetString(iface.name);
+        for (auto field : kInterfaceFloats) iface.*field = r.GetFloat();
+    });
+}
+
+void Write(ByteWriter& out, const ProcessInfo& process) {
+    out.PutString(process.name);
+    out.PutVarint(process.pid);
+    out.PutFloat(process.cpuUsage);
+    out.PutFloat(process.gpuUsage);
+    out.PutFloat(process.memoryMB);
+    out.PutSigned(process.threads);
+    out.PutSigned(process.handles);
+}
+
+void Read(ByteReader& in, ProcessInfo& process) {
+    in.GetString(process.name);
+    process.pid = static_cast<unsigned long>(in.GetVarint());
+    process.cpuUsage = in.GetFloat();
+    process.gpuUsage = in.GetFloat();
+    process.memoryMB = in.GetFloat();
+    process.threads = static_cast<int>(in.GetSigned());
+    process.handles = static_cast<int>(in.GetSigned());
+}
+
+void Write(ByteWriter& out, const ThermalInfo& thermal) {
+    PutList(out, thermal.sensors, [](ByteWriter& w, const ThermalSensor& sensor) {
+        w.PutU8(static_cast<uint8_t>(sensor.kind));
+        w.PutString(sensor.label);
+        w.PutString(sensor.device);
+        PutList(w, sensor.cpus, [](ByteWriter& cw, int cpu) { cw.PutSigned(cpu); });
+        w.PutFloat(sensor.temperature);
+        w.PutFloat(sensor.criticalTemperature);
+    });
+    out.PutFloat(thermal.packageTemperature);
+    out.PutVarint(thermal.throttleEvents);
+    out.PutVarint(thermal.newThrottleEvents);
+    out.PutU8(static_cast<uint8_t>((thermal.frequencyCapped ? 1 : 0) | (thermal.throttling ? 2 : 0)));
+}
+
+void Read(ByteReader& in, ThermalInfo& thermal) {
+    GetList(in, thermal.sensors, [](ByteReader& r, ThermalSensor& sensor) {
+        sensor.kind = static_cast<ThermalSensorKind>(r.GetU8());
+        r.GetString(sensor.label);
+        r.GetString(sensor.device);
+        GetList(r, sensor.cpus, [](ByteReader& cr, int& cpu) { cpu = static_cast<int>(cr.GetSigned()); });
+        sensor.temperature = r.GetFloat();
+        sensor.criticalTemperature = r.GetFloat();
+    });
+    thermal.packageTemperature = in.GetFloat();
+    thermal.throttleEvents = in.GetVarint();
+    thermal.newThrottleEvents = static_cast<uint32_t>(in.GetVarint());
+    uint8_t flags = in.GetU8();
+    thermal.frequencyCapped = (flags & 1) != 0;
+    thermal.throttling = (flags & 2) != 0;
+}
+
+void Write(ByteWriter& out, const PressureInfo& pressure) {
+    out.PutString(pressure.group);
+    for (const auto& stall : pressure.resources) {
+        out.PutFloat(stall.someAvg10);
+        out.PutFloat(stall.fullAvg10);
+        out.PutVarint(stall.someTotalUs);
+        out.PutVarint(stall.fullTotalUs);
+        out.PutVarint(stall.someStallUs);
+        out.PutVarint(stall.fullStallUs);
+        out.PutFloat(stall.somePercent);
+        out.PutFloat(stall.fullPercent);
+    }
+}
+
+void Read(ByteReader& in, PressureInfo& pressure) {
+    in.GetString(pressure.group);
+    for (auto& stall : pressure.resources) {
+        stall.someAvg10 = in.GetFloat();
+        stall.fullAvg10 = in.GetFloat();
+        stall.someTotalUs = in.GetVarint();
+        stall.fullTotalUs = in.GetVarint();
+        stall.someStallUs = in.GetVarint();
+        stall.fullStallUs = in.GetVarint();
+        stall.somePercent = in.GetFloat();
+        stall.fullPercent = in.GetFloat();
+    }
+}
+
+constexpr float ThreadSchedInfo::* kThreadFloats[] = {
+    &ThreadSchedInfo::cpuUsage, &ThreadSchedInfo::runDelayPercent, &ThreadSchedInfo::avgRunDelayUs,
+    &ThreadSchedInfo::voluntarySwitchesPerSec, &ThreadSchedInfo::involuntarySwitchesPerSec,
+    &ThreadSchedInfo::migrationsPerSec
+};
+
+void Write(ByteWriter& out, const ThreadSchedInfo& thread) {
+    out.PutVarint(thread.tid);
+    out.PutString(thread.name);
+    for (auto field : kThreadFloats) out.PutFloat(thread.*field);
+    out.PutSigned(thread.lastCpu);
+}
+
+void Read(ByteReader& in, ThreadSchedInfo& thread) {
+    thread.tid = static_cast<unsigned long>(in.GetVarint());
+    in.GetString(thread.name);
+    for (auto field : kThreadFloats) thread.*field = in.GetFloat();
+    thread.lastCpu = static_cast<int>(in.GetSigned());
+}
+
+void Write(ByteWriter& out, const LatencyStats& stats) {
+    out.PutSigned(stats.cpu);
+    out.PutVarint(stats.samples);
+    out.PutVarint(stats.missedDeadlines);
+    out.PutFloat(stats.p50Us);
+    out.PutFloat(stats.p99Us);
+    out.PutFloat(stats.p999Us);
+    out.PutFloat(stats.maxUs);
+    out.PutFloat(stats.peakUs);
+}
+
+void Read(ByteReader& in, LatencyStats& stats) {
+    stats.cpu = static_cast<int>(in.GetSigned());
+    stats.samples = in.GetVarint();
+    stats.missedDeadlines = in.GetVarint();
+    stats.p50Us = in.GetFloat();
+    stats.p99Us = in.GetFloat();
+    stats.p999Us = in.GetFloat();
+    stats.maxUs = in.GetFloat();
+    stats.peakUs = in.GetFloat();
+}
+
+constexpr float NumaNodeInfo::* kNumaFloats[] = {
+    &NumaNodeInfo::totalGB, &NumaNodeInfo::freeGB, &NumaNodeInfo::usedGB, &NumaNodeInfo::hitsPerSec,
+    &NumaNodeInfo::missesPerSec, &NumaNodeInfo::foreignPerSec, &NumaNodeInfo::remotePerSec
+};
+
+void Write(ByteWriter& out, const NumaNodeInfo& node) {
+    out.PutSigned(node.node);
+    for (auto field : kNumaFloats) out.PutFloat(node.*field);
+}
+
+void Read(ByteReader& in, NumaNodeInfo& node) {
+    node.node = static_cast<int>(in.GetSigned());
+    for (auto field : kNumaFloats) node.*field = in.GetFloat();
+}
+
+void Write(ByteWriter& out, const CgroupInfo& group) {
+    out.PutString(group.path);
+    out.PutSigned(group.depth);
+    out.PutFloat(group.cpuPercent);
+    out.PutFloat(group.throttledPercent);
+    out.PutVarint(group.throttledPeriods);
+    out.PutVarint(group.memoryBytes);
+    out.PutVarint(group.memoryHighEvents);
+    out.PutVarint(group.memoryMaxEvents);
+    out.PutVarint(group.oomKills);
+    out.PutFloat(group.ioReadMBps);
+    out.PutFloat(group.ioWriteMBps);
+    PutList(out, group.pids, [](ByteWriter& w, unsigned long pid) { w.PutVarint(pid); });
+}
+
+void Read(ByteReader& in, CgroupInfo& group) {
+    in.GetString(group.path);
+    group.depth = static_cast<int>(in.GetSigned());
+    group.cpuPercent = in.GetFloat();
+    group.throttledPercent = in.GetFloat();
+    group.throttledPeriods = in.GetVarint();
+    group.memoryBytes = in.GetVarint();
+    group.memoryHighEvents = in.GetVarint();
+    group.memoryMaxEvents = in.GetVarint();
+    group.oomKills = in.GetVarint();
+    group.ioReadMBps = in.GetFloat();
+    group.ioWriteMBps = in.GetFloat();
+    GetList(in, group.pids, [](ByteReader& r, unsigned long& pid) { pid = static_cast<unsigned long>(r.GetVarint()); });
+}
+
+template <typename T>
+void WriteList(ByteWriter& out, const std::vector<T>& items) {
+    PutList(out, items, [](ByteWriter& w, const T& item) { Write(w, item); });
+}
+
+template <typename T>
+void ReadList(ByteReader& in, std::vector<T>& items) {
+    GetList(in, items, [](ByteReader& r, T& item) { Read(r, item); });
+}
+
+void WriteSection(ByteWriter& out, const SystemSnapshot& snapshot, CollectorId id) {
+    switch (id) {
+        case CollectorId::CPU: WriteList(out, snapshot.cpu); break;
+        case CollectorId::GPU: Write(out, snapshot.gpu); break;
+        case CollectorId::RAM: Write(out, snapshot.ram); break;
+        case CollectorId::Disk: WriteList(out, snapshot.disks); break;
+        case CollectorId::Network: Write(out, snapshot.network); break;
+        case CollectorId::Process: WriteList(out, snapshot.processes); break;
+        case CollectorId::Thermal: Write(out, snapshot.thermal); break;
+        case CollectorId::Pressure: WriteList(out, snapshot.pressure); break;
+        case CollectorId::Threads:
+            out.PutVarint(snapshot.threadsPid);
+            WriteList(out, snapshot.threads);
+            break;
+        case CollectorId::Latency: WriteList(out, snapshot.latency); break;
+        case CollectorId::Numa: WriteList(out, snapshot.numa); break;
+        case CollectorId::Cgroups: WriteList(out, snapshot.cgroups); break;
+        default: break;
+    }
+}
+
+void ReadSection(ByteReader& in, SystemSnapshot& snapshot, CollectorId id) {
+    switch (id) {
+        case CollectorId::CPU: ReadList(in, snapshot.cpu); break;
+        case CollectorId::GPU: Read(in, snapshot.gpu); break;
+        case CollectorId::RAM: Read(in, snapshot.ram); break;
+        case CollectorId::Disk: ReadList(in, snapshot.disks); break;
+        case CollectorId::Network: Read(in, snapshot.network); break;
+        case CollectorId::Process: ReadList(in, snapshot.processes); break;
+        case CollectorId::Thermal: Read(in, snapshot.thermal); break;
+        case CollectorId::Pressure: ReadList(in, snapshot.pressure); break;
+        case CollectorId::Threads:
+            snapshot.threadsPid = static_cast<unsigned long>(in.GetVarint());
+            ReadList(in, snapshot.threads);
+            break;
+        case CollectorId::Latency: ReadList(in, snapshot.latency); break;
+        case CollectorId::Numa: ReadList(in, snapshot.numa); break;
+        case CollectorId::Cgroups: ReadList(in, snapshot.cgroups); break;
+        default: break;
+    }
+}
+
+}
+
+void ByteWriter::PutU32(uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        m_out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void ByteWriter::PutVarint(uint64_t value) {
+    while (value >= 0x80) {
+        m_out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    m_out.push_back(static_cast<uint8_t>(value));
+}
+
+void ByteWriter::PutFloat(float value) {
+    PutU32(std::bit_cast<uint32_t>(value));
+}
+
+void ByteWriter::PutString(const std::string& value) {
+    PutVarint(value.size());
+    m_out.insert(m_out.end(), value.begin(), value.end());
+}
+
+void ByteWriter::PatchU32(size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        m_out[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+bool ByteReader::Take(size_t bytes) {
+    if (!m_valid || bytes > GetRemaining()) {
+        m_valid = false;
+        return false;
+    }
+    return true;
+}
+
+uint8_t ByteReader::GetU8() {
+    if (!Take(1)) return 0;
+    return m_data[m_position++];
+}
+
+uint32_t ByteReader::GetU32() {
+    if (!Take(4)) return 0;
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(m_data[m_position++]) << (8 * i);
+    }
+    return value;
+}
+
+uint64_t ByteReader::GetVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!Take(1)) return 0;
+        uint8_t byte = m_data[m_position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    m_valid = false;
+    return 0;
+}
+
+int64_t ByteReader::GetSigned() {
+    uint64_t value = GetVarint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+float ByteReader::GetFloat() {
+    return std::bit_cast<float>(GetU32());
+}
+
+void ByteReader::GetString(std::string& value) {
+    size_t length = GetCount();
+    if (!Take(length)) {
+        value.clear();
+        return;
+    }
+    value.assign(reinterpret_cast<const char*>(m_data.data() + m_position), length);
+    m_position += length;
+}
+
+size_t ByteReader::GetCount() {
+    uint64_t count = GetVarint();
+    if (count > GetRemaining()) {
+        m_valid = false;
+        return 0;
+    }
+    return static_cast<size_t>(count);
+}
+
+void ByteReader::Skip(size_t bytes) {
+    if (Take(bytes)) m_position += bytes;
+}
+
+void EncodeSnapshot(const SystemSnapshot& snapshot, CollectorMask sections, std::vector<uint8_t>& out) {
+    ByteWriter writer(out);
+    for (size_t i = 0; i < static_cast<size_t>(CollectorId::Count); i++) {
+        auto id = static_cast<CollectorId>(i);
+        if (!(sections & CollectorBit(id))) continue;
+        
+        writer.PutU8(static_cast<uint8_t>(id));
+        size_t lengthOffset = writer.GetSize();
+        writer.PutU32(0);
+        WriteSection(writer, snapshot, id);
+        writer.PatchU32(lengthOffset, static_cast<uint32_t>(writer.GetSize() - lengthOffset - 4));
+    }
+}
+
+bool DecodeSnapshot(std::span<const uint8_t> payload, SystemSnapshot& snapshot) {
+    ByteReader reader(payload);
+    while (reader.GetRemaining() > 0 && reader.IsValid()) {
+        uint8_t id = reader.GetU8();
+        uint32_t length = reader.GetU32();
+        if (!reader.IsValid() || length > reader.GetRemaining()) return false;
+        
+        size_t consumed = payload.size() - reader.GetRemaining();
+        if (id >= static_cast<uint8_t>(CollectorId::Count)) {
+            reader.Skip(length);
+            continue;
+        }
+        
+        ByteReader section(payload.subspan(consumed, length));
+        ReadSection(section, snapshot, static_cast<CollectorId>(id));
+        if (!section.IsValid()) return false;
+        reader.Skip(length);
+    }
+    return reader.IsValid();
+}
+
+uint32_t Crc32(std::span<const uint8_t> data, uint32_t crc) {
+    crc = ~crc;
+    for (uint8_t byte : data) {
+        crc = kCrcTable[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+}
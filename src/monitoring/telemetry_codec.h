@@ -0,0 +1,75 @@
+#pragma once
+#include "monitoring_types.h"
+#include "subscription_hub.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Monitor {
+
+// Binary schema of recorded snapshots. A payload is a run of sections, one
+// per collector: the CollectorId byte, the section length as 32 bits, then
+// that collector's part of SystemSnapshot. Integers are LEB128 varints
+// (zigzag for signed ones), floats raw 32-bit, strings and lists prefixed
+// with their length. Sections with ids a reader does not know are skipped,
+// so collectors can be added without breaking older recordings. Everything
+// is little-endian.
+void EncodeSnapshot(const SystemSnapshot& snapshot, CollectorMask sections, std::vector<uint8_t>& out);
+
+// Overwrites the parts of `snapshot` present in `payload` and leaves the
+// others alone, so applying a keyframe and then the records after it
+// rebuilds the snapshot as it was. Returns false on malformed input, after
+// which `snapshot` may be partly updated.
+bool DecodeSnapshot(std::span<const uint8_t> payload, SystemSnapshot& snapshot);
+
+uint32_t Crc32(std::span<const uint8_t> data, uint32_t crc = 0);
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) : m_out(out) {}
+    
+    void PutU8(uint8_t value) { m_out.push_back(value); }
+    void PutU32(uint32_t value);
+    void PutVarint(uint64_t value);
+    void PutSigned(int64_t value) { PutVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+    void PutFloat(float value);
+    void PutString(const std::string& value);
+    
+    size_t GetSize() const { return m_out.size(); }
+    void PatchU32(size_t offset, uint32_t value);
+    
+private:
+    std::vector<uint8_t>& m_out;
+};
+
+// Bounds-checked reads; past the end, or on a count that cannot fit in what
+// is left, every read returns zero and IsValid turns false.
+class ByteReader {
+public:
+    explicit ByteReader(std::span<const uint8_t> data) : m_data(data) {}
+    
+    uint8_t GetU8();
+    uint32_t GetU32();
+    uint64_t GetVarint();
+    int64_t GetSigned();
+    float GetFloat();
+    void GetString(std::string& value);
+    
+    // Element count of a list whose entries take at least one byte each.
+    size_t GetCount();
+    
+    void Skip(size_t bytes);
+    size_t GetRemaining() const { return m_data.size() - m_position; }
+    bool IsValid() const { return m_valid; }
+    
+private:
+    bool Take(size_t bytes);
+    
+    std::span<const uint8_t> m_data;
+    size_t m_position = 0;
+    bool m_valid = true;
+};
+
+}
@@ -0,0 +1,117 @@
+#include "telemetry_reader.h"
+#include "telemetry_codec.h"
+#include "telemetry_segment.h"
+#include <algorithm>
+#include <limits>
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+bool TelemetryReader::Open(const std::string& directory) {
+    Close();
+    
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error)) {
+        spdlog::error("No telemetry recording in {}", directory);
+        return false;
+    }
+    
+    for (auto& [sequence, path] : ListSegments(directory)) {
+        Segment segment;
+        segment.sequence = sequence;
+        segment.path = path.string();
+        if (!segment.file.Open(segment.path, false)) continue;
+        
+        const SegmentHeader* header = GetSegmentHeader(segment.file);
+        if (!header) {
+            spdlog::warn("Skipping {}: not a telemetry segment", segment.path);
+            continue;
+        }
+        
+        segment.sealed = header->sealed != 0;
+        segment.firstTimestampUs = header->firstTimestampUs;
+        segment.lastTimestampUs = header->lastTimestampUs;
+        uint32_t records = header->recordCount;
+        if (!segment.sealed) {
+            SegmentTail tail = FindSegmentTail(segment.file.GetData(), segment.file.GetSize());
+            segment.lastTimestampUs = tail.lastTimestampUs;
+            records = tail.recordCount;
+        }
+        if (records == 0) continue;
+        
+        m_segments.push_back(std::move(segment));
+    }
+    
+    if (m_segments.empty()) {
+        spdlog::error("No telemetry recording in {}", directory);
+        return false;
+    }
+    return true;
+}
+
+int64_t TelemetryReader::GetFirstTimestampUs() const {
+    return m_segments.empty() ? 0 : m_segments.front().firstTimestampUs;
+}
+
+int64_t TelemetryReader::GetLastTimestampUs() const {
+    return m_segments.empty() ? 0 : m_segments.back().lastTimestampUs;
+}
+
+bool TelemetryReader::ReadRange(int64_t fromUs, int64_t toUs, const Visitor& visit) const {
+    SystemSnapshot state;
+    bool intact = true;
+    
+    for (const auto& segment : m_segments) {
+        // A segment still being written may have grown past what Open saw.
+        int64_t lastUs = segment.sealed ? segment.lastTimestampUs : std::numeric_limits<int64_t>::max();
+        if (lastUs < fromUs) continue;
+        if (segment.firstTimestampUs > toUs) break;
+        
+        ReadResult result = ReadSegment(segment, fromUs, toUs, visit, state);
+        if (result == ReadResult::Stopped) break;
+        if (result == ReadResult::Damaged) intact = false;
+    }
+    return intact;
+}
+
+TelemetryReader::ReadResult TelemetryReader::ReadSegment(const Segment& segment, int64_t fromUs, int64_t toUs,
+                                                         const Visitor& visit, SystemSnapshot& state) const {
+    const uint8_t* data = segment.file.GetData();
+    auto header = reinterpret_cast<const SegmentHeader*>(data);
+    size_t end = segment.sealed ? std::min<size_t>(header->endOffset, segment.file.GetSize()) : segment.file.GetSize();
+    
+    // Last keyframe at or before fromUs; the first one starts the segment.
+    const SegmentIndexEntry* index = header->index;
+    const SegmentIndexEntry* indexEnd = index + std::min<size_t>(header->indexCount, kSegmentIndexCapacity);
+    auto next = std::upper_bound(index, indexEnd, fromUs, [](int64_t time, const SegmentIndexEntry& entry) {
+        return time < entry.timestampUs;
+    });
+    size_t offset = next == index ? kSegmentDataOffset : (next - 1)->offset;
+    
+    while (offset < end) {
+        const RecordHeader* record = ValidateRecord(data, end, offset);
+        if (!record) break;
+        if (record->timestampUs > toUs) return ReadResult::Stopped;
+        
+        auto payload = std::span<const uint8_t>(data + offset + sizeof(RecordHeader), record->length);
+        if (!DecodeSnapshot(payload, state)) {
+            spdlog::warn("Damaged telemetry record in {} at offset {}", segment.path, offset);
+            return ReadResult::Damaged;
+        }
+        
+        if (record->timestampUs >= fromUs && !visit(record->timestampUs, record->changed, state)) {
+            return ReadResult::Stopped;
+        }
+        offset += RecordSize(record->length);
+    }
+    
+    // The end of a sealed segment is known, so falling short of it means a
+    // record went bad after it was written.
+    if (segment.sealed && offset < end) {
+        spdlog::warn("Damaged telemetry record in {} at offset {}", segment.path, offset);
+        return ReadResult::Damaged;
+    }
+    return ReadResult::Done;
+}
+
+}
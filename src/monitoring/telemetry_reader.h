@@ -0,0 +1,61 @@
+#pragma once
+#include "mapped_file.h"
+#include "monitoring_types.h"
+#include "subscription_hub.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Monitor {
+
+// Read side of TelemetryRecorder's segment files. Segments are mapped
+// read-only and only those overlapping a requested range are touched;
+// within one, the time index leads to the last keyframe before the range,
+// so reading a minute out of a day-long recording decodes about a minute
+// of records. A segment still being recorded can be read too: its end is
+// found the same way the recorder finds it after a crash.
+class TelemetryReader {
+public:
+    // Called per record with the snapshot as it stood when the record was
+    // written; returning false stops the read.
+    using Visitor = std::function<bool(int64_t timestampUs, CollectorMask changed, const SystemSnapshot& snapshot)>;
+    
+    bool Open(const std::string& directory);
+    void Close() { m_segments.clear(); }
+    
+    size_t GetSegmentCount() const { return m_segments.size(); }
+    
+    // Wall-clock microseconds of the first and last record as of Open; 0
+    // when nothing was recorded.
+    int64_t GetFirstTimestampUs() const;
+    int64_t GetLastTimestampUs() const;
+    
+    // Visits every record in [fromUs, toUs] in order. Returns false when a
+    // damaged record cut a segment short; the records before it are still
+    // visited, and the read resumes at the next segment's first keyframe.
+    bool ReadRange(int64_t fromUs, int64_t toUs, const Visitor& visit) const;
+    
+private:
+    struct Segment {
+        uint64_t sequence = 0;
+        std::string path;
+        MappedFile file;
+        int64_t firstTimestampUs = 0;
+        int64_t lastTimestampUs = 0;
+        bool sealed = false;
+    };
+    
+    enum class ReadResult {
+        Done,
+        Stopped,
+        Damaged
+    };
+    
+    ReadResult ReadSegment(const Segment& segment, int64_t fromUs, int64_t toUs, const Visitor& visit,
+                           SystemSnapshot& state) const;
+    
+    std::vector<Segment> m_segments;
+};
+
+}
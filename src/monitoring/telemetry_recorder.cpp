@@ -0,0 +1,293 @@
+#include "telemetry_recorder.h"
+#include "telemetry_codec.h"
+#include "telemetry_segment.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <spdlog/spdlog.h>
+
+namespace Monitor {
+
+namespace {
+
+constexpr std::chrono::milliseconds kWaitTimeout{500};
+constexpr std::chrono::milliseconds kNotifyGrace{10};
+constexpr size_t kMinSegmentBytes = kSegmentDataOffset + (size_t(1) << 20);
+
+// Closes out a segment an earlier run did not seal, after a crash or power
+// loss: the tail fields are rewritten from what the records say and the
+// first torn record, if any, is cleared so nothing reads past it again.
+void RepairSegment(const std::filesystem::path& path) {
+    MappedFile file;
+    if (!file.Open(path.string(), true)) return;
+    
+    auto header = const_cast<SegmentHeader*>(GetSegmentHeader(file));
+    if (!header) {
+        spdlog::warn("Skipping {}: not a telemetry segment", path.string());
+        return;
+    }
+    if (header->sealed) return;
+    
+    SegmentTail tail = FindSegmentTail(file.GetData(), file.GetSize());
+    size_t clear = std::min(sizeof(RecordHeader), file.GetSize() - tail.endOffset);
+    std::memset(file.GetData() + tail.endOffset, 0, clear);
+    
+    header->endOffset = tail.endOffset;
+    header->lastTimestampUs = tail.lastTimestampUs;
+    header->recordCount = tail.recordCount;
+    header->indexCount = tail.indexCount;
+    header->sealed = 1;
+    file.Flush(0, file.GetSize());
+    
+    spdlog::warn("Recovered unsealed telemetry segment {}: kept {} records", path.string(), tail.recordCount);
+}
+
+void StoreRelease(uint32_t& target, uint32_t value) {
+    std::atomic_ref<uint32_t>(target).store(value, std::memory_order_release);
+}
+
+}
+
+TelemetryRecorder::~TelemetryRecorder() {
+    Stop();
+}
+
+bool TelemetryRecorder::Start(const RecorderConfig& config) {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (m_running) {
+        spdlog::error("Telemetry recorder is already running");
+        return false;
+    }
+    
+    // Record offsets in the index are 32 bits.
+    if (config.segmentBytes < kMinSegmentBytes || config.segmentBytes > std::numeric_limits<uint32_t>::max()) {
+        spdlog::error("Telemetry segment size {} is outside {}..{} bytes", config.segmentBytes, kMinSegmentBytes,
+                      std::numeric_limits<uint32_t>::max());
+        return false;
+    }
+    
+    std::error_code error;
+    std::filesystem::create_directories(config.directory, error);
+    if (error) {
+        spdlog::error("Cannot create telemetry directory {}: {}", config.directory, error.message());
+        return false;
+    }
+    
+    m_config = config;
+    auto segments = ListSegments(config.directory);
+    if (!segments.empty()) {
+        RepairSegment(segments.back().second);
+        m_nextSequence = segments.back().first + 1;
+    }
+    
+    {
+        std::lock_guard<std::mutex> statsLock(m_statsMutex);
+        m_stats = {};
+    }
+    
+    // Record times are wall clock, but advance with the steady clock the
+    // snapshots are stamped with, so a clock step cannot reorder a segment.
+    m_steadyOrigin = std::chrono::steady_clock::now();
+    m_wallOriginUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    m_lastVersion = m_publisher.GetVersion();
+    m_carry = 0;
+    m_lastTimestampUs = std::numeric_limits<int64_t>::min();
+    
+    if (!OpenSegment()) return false;
+    
+    m_subscription = m_hub.Subscribe(kAllCollectors);
+    m_running = true;
+    m_thread = std::thread(&TelemetryRecorder::WriterThread, this);
+    
+    spdlog::info("Recording telemetry to {}", m_segmentPath.string());
+    return true;
+}
+
+void TelemetryRecorder::Stop() {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (!m_running) return;
+    
+    m_running = false;
+    m_hub.Unsubscribe(m_subscription);
+    m_thread.join();
+    
+    RecorderStats stats = GetStats();
+    spdlog::info("Telemetry recording stopped: {} records, {} bytes in {} segments", stats.records, stats.bytes,
+                 stats.segments);
+}
+
+RecorderStats TelemetryRecorder::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+void TelemetryRecorder::WriterThread() {
+    while (m_running) {
+        CollectorMask changed = m_hub.Wait(m_subscription, kWaitTimeout);
+        if (!changed || !m_running) continue;
+        
+        // A segment that failed to open is retried once per keyframe
+        // interval rather than on every publish.
+        auto now = std::chrono::steady_clock::now();
+        if (!m_segment.IsOpen()) {
+            if (now - m_lastOpenAttempt < m_config.keyframeInterval || !OpenSegment()) continue;
+        }
+        
+        if (Record(changed, false) == AppendResult::Full) {
+            SealSegment();
+            if (OpenSegment()) Record(changed, true);
+        }
+    }
+    
+    SealSegment();
+}
+
+TelemetryRecorder::AppendResult TelemetryRecorder::Record(CollectorMask& changed, bool keyframe) {
+    auto header = reinterpret_cast<SegmentHeader*>(m_segment.GetData());
+    int64_t timestampUs = 0;
+    uint64_t version = 0;
+    
+    // The handle pins a publisher slot, so it is let go before the copy into
+    // the mapping, which may fault pages in.
+    CollectorMask carry = 0;
+    changed |= m_carry;
+    {
+        auto snapshot = m_publisher.Acquire();
+        if (!snapshot || snapshot->version <= m_lastVersion) {
+            m_carry = changed;
+            return AppendResult::Written;
+        }
+        
+        // The record must name every section that differs from the previous
+        // one. The snapshot may be a publish ahead of the marks seen so far,
+        // whose notification follows within microseconds; marks polled now
+        // may in turn belong to publishes after it, and are carried into the
+        // next record as well.
+        auto deadline = std::chrono::steady_clock::now() + kNotifyGrace;
+        while (m_hub.GetNotifiedVersion() < snapshot->version && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        CollectorMask polled = m_hub.Poll(m_subscription);
+        changed |= polled;
+        if (m_publisher.GetVersion() > snapshot->version) carry = polled;
+        
+        timestampUs = m_wallOriginUs +
+            std::chrono::duration_cast<std::chrono::microseconds>(snapshot->timestamp - m_steadyOrigin).count();
+        timestampUs = std::max(timestampUs, m_lastTimestampUs);
+        keyframe |= header->indexCount == 0 ||
+            timestampUs - m_lastKeyframeUs >= std::chrono::duration_cast<std::chrono::microseconds>(m_config.keyframeInterval).count();
+        
+        m_payload.clear();
+        EncodeSnapshot(*snapshot, keyframe ? kAllCollectors : changed, m_payload);
+        version = snapshot->version;
+    }
+    
+    size_t offset = header->endOffset;
+    size_t size = RecordSize(m_payload.size());
+    if (offset + size > m_segment.GetSize() || (keyframe && header->indexCount >= kSegmentIndexCapacity)) {
+        // Even a fresh segment cannot take it.
+        if (header->recordCount == 0) {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.failures++;
+            return AppendResult::Failed;
+        }
+        return AppendResult::Full;
+    }
+    
+    uint8_t* data = m_segment.GetData();
+    auto record = reinterpret_cast<RecordHeader*>(data + offset);
+    record->timestampUs = timestampUs;
+    record->changed = changed;
+    record->flags = keyframe ? kRecordKeyframe : 0;
+    std::memcpy(data + offset + sizeof(RecordHeader), m_payload.data(), m_payload.size());
+    record->crc = RecordCrc(*record, m_payload.data(), static_cast<uint32_t>(m_payload.size()));
+    StoreRelease(record->length, static_cast<uint32_t>(m_payload.size()));
+    
+    if (keyframe) {
+        header->index[header->indexCount] = {timestampUs, static_cast<uint32_t>(offset), header->recordCount};
+        StoreRelease(header->indexCount, header->indexCount + 1);
+        m_lastKeyframeUs = timestampUs;
+    }
+    
+    if (header->recordCount == 0) header->firstTimestampUs = timestampUs;
+    header->lastTimestampUs = timestampUs;
+    header->endOffset = offset + size;
+    header->recordCount++;
+    m_lastTimestampUs = timestampUs;
+    m_carry = carry;
+    
+    // Writeback is started at each keyframe so that a power loss costs at
+    // most one keyframe interval; a crash of this process costs nothing.
+    if (keyframe) {
+        m_segment.Flush(m_flushedOffset, header->endOffset - m_flushedOffset);
+        m_segment.Flush(0, kSegmentDataOffset);
+        m_flushedOffset = header->endOffset;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.coalesced += version - m_lastVersion - 1;
+    m_lastVersion = version;
+    m_stats.records++;
+    m_stats.keyframes += keyframe ? 1 : 0;
+    m_stats.bytes += size;
+    return AppendResult::Written;
+}
+
+bool TelemetryRecorder::OpenSegment() {
+    m_lastOpenAttempt = std::chrono::steady_clock::now();
+    
+    auto path = std::filesystem::path(m_config.directory) / GetSegmentFileName(m_nextSequence);
+    if (!m_segment.Create(path.string(), m_config.segmentBytes)) {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.failures++;
+        return false;
+    }
+    
+    // The file starts out zeroed; only the identity and the first record
+    // offset need setting.
+    auto header = reinterpret_cast<SegmentHeader*>(m_segment.GetData());
+    header->magic = kSegmentMagic;
+    header->version = kSegmentVersion;
+    header->sequence = m_nextSequence++;
+    header->segmentBytes = m_config.segmentBytes;
+    header->endOffset = kSegmentDataOffset;
+    m_flushedOffset = kSegmentDataOffset;
+    m_segmentPath = path;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.segments++;
+        m_stats.segmentPath = path.string();
+    }
+    
+    RemoveOldSegments();
+    return true;
+}
+
+void TelemetryRecorder::SealSegment() {
+    if (!m_segment.IsOpen()) return;
+    
+    auto header = reinterpret_cast<SegmentHeader*>(m_segment.GetData());
+    header->sealed = 1;
+    m_segment.Flush(0, header->endOffset);
+    m_segment.Close();
+    
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.segmentPath.clear();
+}
+
+void TelemetryRecorder::RemoveOldSegments() {
+    if (m_config.maxSegments == 0) return;
+    
+    auto segments = ListSegments(m_config.directory);
+    for (size_t i = 0; i + m_config.maxSegments < segments.size(); i++) {
+        std::error_code error;
+        std::filesystem::remove(segments[i].second, error);
+        if (error) {
+            spdlog::warn("Cannot remove old telemetry segment {}: {}", segments[i].second.string(), error.message());
+        }
+    }
+}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "mapped_file.h"
+#include "snapshot_publisher.h"
+#include "subscription_hub.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Monitor {
+
+struct RecorderConfig {
+    std::string directory = "telemetry";
+    size_t segmentBytes = size_t(16) << 20;
+    size_t maxSegments = 64;                      // oldest are deleted past this; 0 keeps all
+    std::chrono::seconds keyframeInterval{10};
+};
+
+struct RecorderStats {
+    uint64_t records = 0;
+    uint64_t keyframes = 0;
+    uint64_t bytes = 0;
+    uint64_t segments = 0;
+    uint64_t coalesced = 0;         // publishes folded into a later record
+    uint64_t failures = 0;          // records that could not be written
+    std::string segmentPath;        // being written, empty when stopped
+};
+
+// Appends published snapshots to fixed-size memory-mapped segment files
+// (see telemetry_segment.h). A writer thread of its own waits on a signal
+// subscription, so collectors only ever pay for the notification; when the
+// writer falls behind, publishes merge and the next record carries every
+// section that changed in between. Records hold only those sections, with a
+// full keyframe at the start of each segment and every keyframeInterval.
+// Start first repairs the tail of a segment an earlier run left unsealed.
+class TelemetryRecorder {
+public:
+    TelemetryRecorder(SubscriptionHub& hub, const SnapshotPublisher& publisher)
+        : m_hub(hub), m_publisher(publisher) {}
+    ~TelemetryRecorder();
+    
+    TelemetryRecorder(const TelemetryRecorder&) = delete;
+    TelemetryRecorder& operator=(const TelemetryRecorder&) = delete;
+    
+    bool Start(const RecorderConfig& config);
+    void Stop();
+    bool IsRunning() const { return m_running; }
+    
+    RecorderStats GetStats() const;
+    
+private:
+    enum class AppendResult {
+        Written,
+        Full,       // the segment has no room left for it
+        Failed
+    };
+    
+    void WriterThread();
+    
+    // Adds the marks that arrived meanwhile to `changed`.
+    AppendResult Record(CollectorMask& changed, bool keyframe);
+    bool OpenSegment();
+    void SealSegment();
+    void RemoveOldSegments();
+    
+    SubscriptionHub& m_hub;
+    const SnapshotPublisher& m_publisher;
+    
+    std::mutex m_controlMutex;          // serializes Start and Stop
+    std::atomic<bool> m_running{false};
+    RecorderConfig m_config;
+    int m_subscription = 0;
+    std::thread m_thread;
+    
+    // Writer thread only.
+    MappedFile m_segment;
+    uint64_t m_nextSequence = 1;
+    std::filesystem::path m_segmentPath;
+    size_t m_flushedOffset = 0;
+    std::chrono::steady_clock::time_point m_lastOpenAttempt;
+    std::vector<uint8_t> m_payload;
+    uint64_t m_lastVersion = 0;
+    CollectorMask m_carry = 0;
+    int64_t m_lastKeyframeUs = 0;
+    int64_t m_lastTimestampUs = 0;
+    int64_t m_wallOriginUs = 0;
+    std::chrono::steady_clock::time_point m_steadyOrigin;
+    
+    mutable std::mutex m_statsMutex;
+    RecorderStats m_stats;
+};
+
+}
@@ -0,0 +1,110 @@
+#include "telemetry_segment.h"
+#include "telemetry_codec.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <limits>
+#include <string_view>
+
+namespace Monitor {
+
+namespace {
+
+constexpr std::string_view kSegmentPrefix = "segment-";
+constexpr std::string_view kSegmentSuffix = ".tseg";
+constexpr size_t kSequenceDigits = 10;
+
+// The recorder may be storing these fields through its own mapping of the
+// same pages while we read.
+uint32_t LoadAcquire(const uint32_t& value) {
+    return std::atomic_ref<uint32_t>(const_cast<uint32_t&>(value)).load(std::memory_order_acquire);
+}
+
+}
+
+uint32_t RecordCrc(const RecordHeader& header, const uint8_t* payload, uint32_t length) {
+    auto fields = reinterpret_cast<const uint8_t*>(&header.timestampUs);
+    uint32_t crc = Crc32({fields, sizeof(RecordHeader) - offsetof(RecordHeader, timestampUs)});
+    return Crc32({payload, length}, crc);
+}
+
+const RecordHeader* ValidateRecord(const uint8_t* data, size_t size, size_t offset) {
+    if (offset < kSegmentDataOffset || offset % kRecordAlignment != 0) return nullptr;
+    if (offset + sizeof(RecordHeader) > size) return nullptr;
+    
+    auto record = reinterpret_cast<const RecordHeader*>(data + offset);
+    uint32_t length = LoadAcquire(record->length);
+    if (length == 0 || RecordSize(length) > size - offset) return nullptr;
+    if (RecordCrc(*record, data + offset + sizeof(RecordHeader), length) != record->crc) return nullptr;
+    return record;
+}
+
+const SegmentHeader* GetSegmentHeader(const MappedFile& file) {
+    if (!file.IsOpen() || file.GetSize() < kSegmentDataOffset) return nullptr;
+    
+    auto header = reinterpret_cast<const SegmentHeader*>(file.GetData());
+    if (header->magic != kSegmentMagic || header->version != kSegmentVersion) return nullptr;
+    if (header->segmentBytes != file.GetSize()) return nullptr;
+    return header;
+}
+
+SegmentTail FindSegmentTail(const uint8_t* data, size_t size) {
+    auto header = reinterpret_cast<const SegmentHeader*>(data);
+    SegmentTail tail;
+    
+    uint32_t indexCount = std::min<uint32_t>(LoadAcquire(header->indexCount), kSegmentIndexCapacity);
+    for (; indexCount > 0; indexCount--) {
+        const auto& entry = header->index[indexCount - 1];
+        const RecordHeader* record = ValidateRecord(data, size, entry.offset);
+        if (record && record->timestampUs == entry.timestampUs) break;
+    }
+    tail.indexCount = indexCount;
+    
+    size_t offset = kSegmentDataOffset;
+    if (indexCount > 0) {
+        offset = header->index[indexCount - 1].offset;
+        tail.recordCount = header->index[indexCount - 1].record;
+    }
+    
+    int64_t previous = std::numeric_limits<int64_t>::min();
+    while (const RecordHeader* record = ValidateRecord(data, size, offset)) {
+        if (record->timestampUs < previous) break;
+        previous = record->timestampUs;
+        offset += RecordSize(record->length);
+        tail.recordCount++;
+    }
+    
+    tail.endOffset = offset;
+    tail.lastTimestampUs = tail.recordCount > 0 ? previous : 0;
+    return tail;
+}
+
+std::string GetSegmentFileName(uint64_t sequence) {
+    std::string digits = std::to_string(sequence);
+    if (digits.size() < kSequenceDigits) digits.insert(0, kSequenceDigits - digits.size(), '0');
+    return std::string(kSegmentPrefix) + digits + std::string(kSegmentSuffix);
+}
+
+std::vector<std::pair<uint64_t, std::filesystem::path>> ListSegments(const std::filesystem::path& directory) {
+    std::vector<std::pair<uint64_t, std::filesystem::path>> segments;
+    
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= kSegmentPrefix.size() + kSegmentSuffix.size()) continue;
+        if (!name.starts_with(kSegmentPrefix) || !name.ends_with(kSegmentSuffix)) continue;
+        
+        const char* first = name.data() + kSegmentPrefix.size();
+        const char* last = name.data() + name.size() - kSegmentSuffix.size();
+        uint64_t sequence = 0;
+        auto [end, parseError] = std::from_chars(first, last, sequence);
+        if (parseError != std::errc() || end != last) continue;
+        
+        segments.emplace_back(sequence, entry.path());
+    }
+    
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+}
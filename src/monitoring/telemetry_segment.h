@@ -0,0 +1,91 @@
+#pragma once
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Monitor {
+
+// On-disk layout of a telemetry segment: a fixed-size file holding a
+// header with the segment's time index, then records back to back from
+// kSegmentDataOffset. Segment files are preallocated and never grow; the
+// zeroes after the last record read as the end of the segment.
+constexpr uint32_t kSegmentMagic = 0x47455354;     // "TSEG"
+constexpr uint32_t kSegmentVersion = 1;
+constexpr size_t kSegmentIndexCapacity = 4096;
+constexpr size_t kRecordAlignment = 8;
+
+constexpr uint32_t kRecordKeyframe = 1;
+
+// Keyframes are indexed as they are written. A reader seeks to the last
+// keyframe at or before the time it wants and decodes forward from there.
+struct SegmentIndexEntry {
+    int64_t timestampUs;
+    uint32_t offset;
+    uint32_t record;                 // ordinal within the segment
+};
+
+// The writer updates the tail fields after every record, but they may lag
+// the records or, after a power loss, run ahead of them; FindSegmentTail
+// is what decides where the segment ends.
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sequence;
+    uint64_t segmentBytes;
+    int64_t firstTimestampUs;
+    int64_t lastTimestampUs;
+    uint64_t endOffset;              // just past the last complete record
+    uint32_t recordCount;
+    uint32_t indexCount;
+    uint32_t sealed;                 // closed cleanly; the tail fields hold
+    uint32_t reserved[3];
+    SegmentIndexEntry index[kSegmentIndexCapacity];
+};
+
+// `length` is stored last, with release order, so a record with a nonzero
+// length is complete as far as this process is concerned; the CRC covers
+// the rest of the header and the payload against torn writes on disk.
+struct RecordHeader {
+    uint32_t length;                 // payload bytes; 0 marks the end
+    uint32_t crc;
+    int64_t timestampUs;             // wall clock, microseconds since the epoch
+    uint32_t changed;                // collectors that published since the last record
+    uint32_t flags;                  // kRecordKeyframe: every section follows, not just `changed`
+};
+
+constexpr size_t kSegmentDataOffset = (sizeof(SegmentHeader) + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+
+constexpr size_t RecordSize(size_t payloadBytes) {
+    return (sizeof(RecordHeader) + payloadBytes + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+
+uint32_t RecordCrc(const RecordHeader& header, const uint8_t* payload, uint32_t length);
+
+// The record at `offset` if it is complete and intact, else nullptr.
+const RecordHeader* ValidateRecord(const uint8_t* data, size_t size, size_t offset);
+
+// The header if `file` is a segment this build can read, else nullptr.
+const SegmentHeader* GetSegmentHeader(const MappedFile& file);
+
+struct SegmentTail {
+    uint64_t endOffset = kSegmentDataOffset;
+    int64_t lastTimestampUs = 0;
+    uint32_t recordCount = 0;
+    uint32_t indexCount = 0;          // entries that point at intact records
+};
+
+// Walks forward from the last index entry that still points at an intact
+// record and stops at the first record that is missing, torn or older than
+// the one before it. Costs at most one keyframe interval of records.
+SegmentTail FindSegmentTail(const uint8_t* data, size_t size);
+
+std::string GetSegmentFileName(uint64_t sequence);
+
+// Segment files in `directory` with their sequence numbers, oldest first.
+std::vector<std::pair<uint64_t, std::filesystem::path>> ListSegments(const std::filesystem::path& directory);
+
+}
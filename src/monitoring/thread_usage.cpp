@@ -0,0 +1,23 @@
+#include "thread_usage.h"
+
+namespace Monitor {
+
+namespace {
+
+thread_local uint64_t t_allocations = 0;
+
+}
+
+void CountAllocation() {
+    t_allocations++;
+}
+
+ThreadUsage ReadThreadUsage() {
+    ThreadUsage usage;
+    usage.cpuTimeNs = ThreadCpuTimeNs();
+    usage.syscalls = ThreadSyscalls();
+    usage.allocations = t_allocations;
+    return usage;
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+namespace Monitor {
+
+// Resources the calling thread has used so far, for the engine's
+// accounting of its own cost. Differences between two reads on the same
+// thread give the cost of the work in between.
+struct ThreadUsage {
+    int64_t cpuTimeNs = 0;
+    uint64_t syscalls = 0;      // 0 on platforms that do not count them
+    uint64_t allocations = 0;   // operator new calls; 0 without the allocation counter
+};
+
+ThreadUsage ReadThreadUsage();
+
+// Called by the operator new replacement in allocation_counter.cpp, which
+// only executables built with PCOPTIMIZER_COUNT_ALLOCATIONS link.
+void CountAllocation();
+
+// Platform parts, in the backend directories.
+int64_t ThreadCpuTimeNs();
+uint64_t ThreadSyscalls();
+
+}
@@ -0,0 +1,73 @@
+#include "volatility_tracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Monitor {
+
+namespace {
+
+// A column is stable while it moves less than 2% of its value, or less than
+// half a unit (a percent, a degree, a MHz, a MB/s) for values near zero.
+constexpr float kStableChange = 0.02f;
+constexpr float kNoiseFloor = 0.5f;
+
+// A step this many times the column's usual step is a sudden change.
+constexpr float kSpikeFactor = 4.0f;
+constexpr float kStepSmoothing = 0.1f;
+
+constexpr int kStableRunsPerBackoff = 5;
+
+}
+
+void VolatilityTracker::Reset() {
+    m_previous.clear();
+    m_averageStep.clear();
+    m_stableRuns = 0;
+    m_backoff.store(1, std::memory_order_relaxed);
+}
+
+bool VolatilityTracker::Update(std::span<const float> row) {
+    if (m_previous.size() != row.size()) {
+        m_previous.assign(row.begin(), row.end());
+        m_averageStep.assign(row.size(), 0.0f);
+        m_stableRuns = 0;
+        return false;
+    }
+    
+    bool stable = true;
+    bool spike = false;
+    
+    for (size_t i = 0; i < row.size(); i++) {
+        float previous = m_previous[i];
+        float current = row[i];
+        m_previous[i] = current;
+        if (std::isnan(previous) || std::isnan(current)) continue;
+        
+        float step = std::fabs(current - previous);
+        float noise = std::max(kNoiseFloor, kStableChange * std::max(std::fabs(current), std::fabs(previous)));
+        if (step > noise) {
+            stable = false;
+            spike |= step > kSpikeFactor * m_averageStep[i];
+        }
+        m_averageStep[i] += kStepSmoothing * (step - m_averageStep[i]);
+    }
+    
+    int backoff = m_backoff.load(std::memory_order_relaxed);
+    int next = backoff;
+    
+    if (spike) {
+        next = 1;
+        m_stableRuns = 0;
+    } else if (!stable) {
+        m_stableRuns = 0;
+    } else if (++m_stableRuns >= kStableRunsPerBackoff) {
+        next = std::min(backoff * 2, kMaxBackoff);
+        m_stableRuns = 0;
+    }
+    
+    if (next == backoff) return false;
+    m_backoff.store(next, std::memory_order_relaxed);
+    return true;
+}
+
+}
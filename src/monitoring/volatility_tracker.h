@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <span>
+#include <vector>
+
+namespace Monitor {
+
+// Decides how far a collector may stretch its sampling period from how much
+// its history row moves between samples. A run of samples in which every
+// column stays within noise doubles the back-off; a column jumping well
+// past its usual step resets it, so the next sample comes at the base
+// period again. Fed from the collector's own lane only; the back-off may be
+// read from anywhere.
+class VolatilityTracker {
+public:
+    static constexpr int kMaxBackoff = 8;
+    
+    // Returns true when the back-off changed.
+    bool Update(std::span<const float> row);
+    
+    int GetBackoff() const { return m_backoff.load(std::memory_order_relaxed); }
+    
+    // Forgets the previous row and returns to the base period.
+    void Reset();
+    
+private:
+    std::vector<float> m_previous;
+    std::vector<float> m_averageStep;   // smoothed |change| per column
+    int m_stableRuns = 0;
+    std::atomic<int> m_backoff{1};
+};
+
+}
@@ -4,6 +4,7 @@
 #include "network_optimizer.h"
 #include "quantum_tweaker.h"
 #include <spdlog/spdlog.h>
+#include <chrono>
 #include <fstream>
 #include <nlohmann/json.hpp>
 
@@ -20,6 +21,7 @@ ProfileManager& ProfileManager::Get() {
 }
 
 bool ProfileManager::ApplyProfile(ProfileType type) {
+    auto start = std::chrono::steady_clock::now();
     m_currentProfile = type;
     
     switch (type) {
@@ -37,6 +39,8 @@ bool ProfileManager::ApplyProfile(ProfileType type) {
             break;
     }
     
+    m_applyTimesUs.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
     return true;
 }
 
@@ -3,6 +3,7 @@
 #include <map>
 #include <vector>
 #include <Windows.h>
+#include "../monitoring/hdr_histogram.h"
 
 namespace Optimizer {
 
@@ -42,6 +43,9 @@ public:
     
     ProfileType GetCurrentProfileType() const { return m_currentProfile; }
     
+    // Wall time of every ApplyProfile call, in microseconds.
+    const Monitor::SharedHistogram& GetApplyTimes() const { return m_applyTimesUs; }
+    
 private:
     ProfileManager() = default;
     
@@ -51,6 +55,7 @@ private:
     void ApplyBalancedProfile();
     
     ProfileType m_currentProfile = ProfileType::Balanced;
+    Monitor::SharedHistogram m_applyTimesUs;
 };
 
 }
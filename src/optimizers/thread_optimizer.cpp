@@ -1,4 +1,5 @@
 #include "thread_optimizer.h"
+#include "../monitoring/monitoring_engine.h"
 #include <TlHelp32.h>
 #include <spdlog/spdlog.h>
 
@@ -7,6 +8,18 @@
 
 namespace Optimizer {
 
+namespace {
+
+DWORD_PTR MaskOf(const std::vector<int>& cpus) {
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    return mask;
+}
+
+}
+
 ThreadOptimizer& ThreadOptimizer::Get() {
     static ThreadOptimizer instance;
     return instance;
@@ -128,6 +141,7 @@ std::vector<ProcessInfo> ThreadOptimizer::GetProcessList() {
 
 std::vector<ThreadInfo> ThreadOptimizer::GetThreadsForProcess(DWORD pid) {
     std::vector<ThreadInfo> threads;
+    auto sched = Monitor::MonitoringEngine::Get().GetThreadSchedInfo(pid);
     
     HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
     if (hSnapshot == INVALID_HANDLE_VALUE) {
@@ -145,6 +159,18 @@ std::vector<ThreadInfo> ThreadOptimizer::GetThreadsForProcess(DWORD pid) {
                 info.name = "Thread " + std::to_string(te32.th32ThreadID);
                 info.affinityMask = 0;
                 info.priority = 0;
+                info.cpuUsage = 0.0f;
+                info.runDelayPercent = 0.0f;
+                info.contextSwitchesPerSec = 0.0f;
+                info.migrationsPerSec = 0.0f;
+                
+                for (const auto& thread : sched) {
+                    if (thread.tid != te32.th32ThreadID) continue;
+                    info.cpuUsage = thread.cpuUsage;
+                    info.runDelayPercent = thread.runDelayPercent;
+                    info.contextSwitchesPerSec = thread.voluntarySwitchesPerSec + thread.involuntarySwitchesPerSec;
+                    info.migrationsPerSec = thread.migrationsPerSec;
+                }
                 
                 HANDLE hThread = OpenThread(THREAD_QUERY_INFORMATION, FALSE, te32.th32ThreadID);
                 if (hThread) {
@@ -173,4 +199,16 @@ int ThreadOptimizer::GetCoreCount() {
     return sysInfo.dwNumberOfProcessors;
 }
 
+DWORD_PTR ThreadOptimizer::GetCoreClassMask(Monitor::CoreClass coreClass) {
+    auto topology = Monitor::MonitoringEngine::Get().GetTopology();
+    DWORD_PTR mask = MaskOf(topology->GetCpus(coreClass)) & GetSystemAffinityMask();
+    return mask ? mask : GetSystemAffinityMask();
+}
+
+DWORD_PTR ThreadOptimizer::GetPrimaryThreadMask() {
+    auto topology = Monitor::MonitoringEngine::Get().GetTopology();
+    DWORD_PTR mask = MaskOf(topology->GetPrimaryThreads()) & GetSystemAffinityMask();
+    return mask ? mask : GetSystemAffinityMask();
+}
+
 }
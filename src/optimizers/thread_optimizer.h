@@ -1,4 +1,5 @@
 #pragma once
+#include "../monitoring/cpu_topology.h"
 #include <Windows.h>
 #include <string>
 #include <vector>
@@ -12,11 +13,17 @@ struct ProcessInfo {
     int priority;
 };
 
+// Scheduling fields are filled while the owning process is watched through
+// MonitoringEngine::SetThreadWatch, and are zero otherwise.
 struct ThreadInfo {
     DWORD tid;
     std::string name;
     DWORD_PTR affinityMask;
     int priority;
+    float cpuUsage;
+    float runDelayPercent;
+    float contextSwitchesPerSec;
+    float migrationsPerSec;
 };
 
 class ThreadOptimizer {
@@ -35,6 +42,12 @@ public:
     DWORD_PTR GetSystemAffinityMask();
     int GetCoreCount();
     
+    // Affinity masks built from the CPU topology, limited to processor
+    // group 0 like the rest of this class. Fall back to the system mask
+    // when the topology has no CPU of the requested kind.
+    DWORD_PTR GetCoreClassMask(Monitor::CoreClass coreClass);
+    DWORD_PTR GetPrimaryThreadMask();
+    
 private:
     ThreadOptimizer() = default;
 };
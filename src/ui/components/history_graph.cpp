@@ -0,0 +1,56 @@
+#include "history_graph.h"
+#include <algorithm>
+#include <cmath>
+
+namespace UI {
+
+void HistoryGraph::Render(
+    const char* id,
+    std::span<const HistoryGraphLine> lines,
+    const ImVec2& size,
+    float minY,
+    float maxY
+) {
+    ImGui::PushID(id);
+    
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 end(pos.x + size.x, pos.y + size.y);
+    
+    drawList->AddRectFilled(pos, end, IM_COL32(20, 20, 26, 255), 6.0f);
+    
+    for (int i = 1; i < 4; i++) {
+        float y = pos.y + size.y * i / 4.0f;
+        drawList->AddLine(ImVec2(pos.x, y), ImVec2(end.x, y), IM_COL32(255, 255, 255, 20));
+    }
+    
+    float range = std::max(maxY - minY, 1e-6f);
+    int pixels = std::max(2, static_cast<int>(size.x));
+    
+    for (const auto& line : lines) {
+        size_t count = line.values.size();
+        if (count < 2) continue;
+        
+        size_t step = std::max<size_t>(1, count / pixels);
+        size_t points = (count - 1) / step + 1;
+        
+        for (size_t p = 0; p < points; p++) {
+            float value = line.values[p * step];
+            if (std::isnan(value)) {
+                drawList->PathStroke(line.color, ImDrawFlags_None, 2.0f);
+                continue;
+            }
+            
+            float t = std::clamp((value - minY) / range, 0.0f, 1.0f);
+            float x = pos.x + size.x * p / static_cast<float>(points - 1);
+            drawList->PathLineTo(ImVec2(x, end.y - t * size.y));
+        }
+        
+        drawList->PathStroke(line.color, ImDrawFlags_None, 2.0f);
+    }
+    
+    ImGui::Dummy(size);
+    ImGui::PopID();
+}
+
+}
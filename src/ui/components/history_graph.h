@@ -0,0 +1,26 @@
+#pragma once
+#include <imgui.h>
+#include <span>
+#include "../../monitoring/metric_history.h"
+
+namespace UI {
+
+struct HistoryGraphLine {
+    Monitor::RingSpan<float> values;
+    ImU32 color;
+};
+
+// Draws series straight from MetricHistory spans; nothing is copied into
+// per-widget buffers. Long series are decimated to one point per pixel.
+class HistoryGraph {
+public:
+    static void Render(
+        const char* id,
+        std::span<const HistoryGraphLine> lines,
+        const ImVec2& size,
+        float minY,
+        float maxY
+    );
+};
+
+}
@@ -2,8 +2,9 @@
 #include "../components/custom_button.h"
 #include "../components/custom_dropdown.h"
 #include "../components/ui_common.h"
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <iterator>
+#include <string>
 
 namespace UI {
 
@@ -13,13 +14,6 @@ CPUWidget::CPUWidget()
     m_config.size = ImVec2(600, 400);
     m_config.position = ImVec2(20, 20);
     
-    auto cpuInfo = Monitor::MonitoringEngine::Get().GetCPUInfo();
-    int coreCount = static_cast<int>(cpuInfo.size());
-    
-    m_usageSeries.reserve(coreCount);
-    m_frequencySeries.reserve(coreCount);
-    m_temperatureSeries.reserve(coreCount);
-    
     ImU32 colors[] = {
         IM_COL32(0, 150, 255, 255),
         IM_COL32(255, 100, 0, 255),
@@ -31,32 +25,58 @@ CPUWidget::CPUWidget()
         IM_COL32(255, 0, 255, 255)
     };
     
-    for (int i = 0; i < coreCount; i++) {
-        std::ostringstream label;
-        label << "Core " << i;
-        
-        ImU32 color = colors[i % 8];
+    m_coreColors.assign(std::begin(colors), std::end(colors));
+    
+    m_subscription = Monitor::MonitoringEngine::Get().Subscribe(Monitor::CollectorBit(Monitor::CollectorId::CPU));
+    UpdateStats();
+}
+
+CPUWidget::~CPUWidget() {
+    Monitor::MonitoringEngine::Get().Unsubscribe(m_subscription);
+}
+
+bool CPUWidget::ResolveMetrics() {
+    if (!m_coreMetrics[0].empty()) return true;
+    
+    const auto& history = Monitor::MonitoringEngine::Get().GetHistory();
+    const char* metrics[] = {"usage", "frequency", "temperature", "cState"};
+    
+    for (int core = 0;; core++) {
+        std::string prefix = "cpu.core" + std::to_string(core) + ".";
+        auto usage = history.Find(prefix + metrics[0]);
+        if (!usage) break;
         
-        m_usageSeries.emplace_back(label.str(), color);
-        m_frequencySeries.emplace_back(label.str(), color);
-        m_temperatureSeries.emplace_back(label.str(), color);
+        for (int mode = 0; mode < static_cast<int>(DisplayMode::Count); mode++) {
+            m_coreMetrics[mode].push_back(history.Find(prefix + metrics[mode]));
+        }
     }
+    
+    return !m_coreMetrics[0].empty();
 }
 
 void CPUWidget::Update(float deltaTime) {
-    m_updateTimer += deltaTime;
+    // Samples are recorded by the monitoring engine; Render reads them from
+    // the shared history.
+    (void)deltaTime;
+    ResolveMetrics();
+    if (!m_topology) m_topology = Monitor::MonitoringEngine::Get().GetTopology();
+    if (Monitor::MonitoringEngine::Get().PollSubscription(m_subscription)) UpdateStats();
+}
+
+void CPUWidget::UpdateStats() {
+    auto snapshot = Monitor::MonitoringEngine::Get().GetSnapshot();
+    const auto& cpuInfo = snapshot->cpu;
     
-    if (m_updateTimer >= m_updateInterval) {
-        m_updateTimer = 0.0f;
-        
-        auto cpuInfo = Monitor::MonitoringEngine::Get().GetCPUInfo();
-        
-        for (size_t i = 0; i < cpuInfo.size() && i < m_usageSeries.size(); i++) {
-            m_usageSeries[i].AddPoint(cpuInfo[i].usage);
-            m_frequencySeries[i].AddPoint(cpuInfo[i].frequency);
-            m_temperatureSeries[i].AddPoint(cpuInfo[i].temperature);
-        }
+    m_cpuCount = static_cast<int>(cpuInfo.size());
+    m_avgUsage = 0.0f;
+    m_maxUsage = 0.0f;
+    
+    for (const auto& core : cpuInfo) {
+        m_avgUsage += core.usage;
+        m_maxUsage = std::max(m_maxUsage, core.usage);
     }
+    
+    if (m_cpuCount > 0) m_avgUsage /= m_cpuCount;
 }
 
 void CPUWidget::Render() {
@@ -69,7 +89,7 @@ void CPUWidget::Render() {
     
     ImGui::BeginGroup();
     
-    std::vector<std::string> modes = {"Usage %", "Frequency MHz", "Temperature °C"};
+    std::vector<std::string> modes = {"Usage %", "Frequency MHz", "Temperature °C", "Deep C-state %"};
     int selectedMode = static_cast<int>(m_displayMode);
     
     if (CustomDropdown::RenderSimple("##display_mode", selectedMode, modes, ImVec2(150, 30))) {
@@ -78,31 +98,41 @@ void CPUWidget::Render() {
     
     ImGui::Spacing();
     
-    std::vector<GraphSeries>* currentSeries = &m_usageSeries;
     float minY = 0.0f;
     float maxY = 100.0f;
     
     switch (m_displayMode) {
         case DisplayMode::Usage:
-            currentSeries = &m_usageSeries;
             maxY = 100.0f;
             break;
         case DisplayMode::Frequency:
-            currentSeries = &m_frequencySeries;
             maxY = 5000.0f;
             break;
         case DisplayMode::Temperature:
-            currentSeries = &m_temperatureSeries;
             maxY = 100.0f;
             break;
+        case DisplayMode::DeepIdle:
+            maxY = 100.0f;
+            break;
+        default:
+            break;
+    }
+    
+    m_lines.clear();
+    if (ResolveMetrics()) {
+        int64_t since = Monitor::MetricHistory::NowUs() - static_cast<int64_t>(m_historySeconds * 1e6f);
+        const auto& metrics = m_coreMetrics[static_cast<int>(m_displayMode)];
+        
+        for (size_t i = 0; i < metrics.size(); i++) {
+            if (!metrics[i]) continue;
+            m_lines.push_back({metrics[i].ReadSince(since).values, m_coreColors[i % m_coreColors.size()]});
+        }
     }
     
-    CustomGraph::Render(
+    HistoryGraph::Render(
         "##cpu_graph",
-        *currentSeries,
+        m_lines,
         ImVec2(contentSize.x - 20, 200),
-        GraphType::FilledLine,
-        true,
         minY,
         maxY
     );
@@ -119,9 +149,7 @@ void CPUWidget::Render() {
 }
 
 void CPUWidget::RenderStats() {
-    auto cpuInfo = Monitor::MonitoringEngine::Get().GetCPUInfo();
-    
-    if (cpuInfo.empty()) {
+    if (m_cpuCount == 0) {
         ImGui::TextColored(
             ImGui::ColorConvertU32ToFloat4(Theme::Get().colorTextSecondary),
             "No CPU data available"
@@ -129,23 +157,17 @@ void CPUWidget::RenderStats() {
         return;
     }
     
-    float avgUsage = 0.0f;
-    float maxUsage = 0.0f;
-    
-    for (const auto& core : cpuInfo) {
-        avgUsage += core.usage;
-        maxUsage = std::max(maxUsage, core.usage);
-    }
-    
-    avgUsage /= cpuInfo.size();
-    
     ImGui::Columns(3, "cpu_stats", false);
     
     ImGui::TextColored(
         ImGui::ColorConvertU32ToFloat4(Theme::Get().colorTextSecondary),
-        "Total Cores"
+        "Cores / Threads"
     );
-    ImGui::Text("%d", static_cast<int>(cpuInfo.size()));
+    if (m_topology) {
+        ImGui::Text("%d / %d", static_cast<int>(m_topology->GetCores().size()), static_cast<int>(m_topology->GetCpus().size()));
+    } else {
+        ImGui::Text("%d", m_cpuCount);
+    }
     
     ImGui::NextColumn();
     
@@ -153,7 +175,7 @@ void CPUWidget::RenderStats() {
         ImGui::ColorConvertU32ToFloat4(Theme::Get().colorTextSecondary),
         "Avg Usage"
     );
-    ImGui::Text("%.1f%%", avgUsage);
+    ImGui::Text("%.1f%%", m_avgUsage);
     
     ImGui::NextColumn();
     
@@ -161,9 +183,16 @@ void CPUWidget::RenderStats() {
         ImGui::ColorConvertU32ToFloat4(Theme::Get().colorTextSecondary),
         "Max Usage"
     );
-    ImGui::Text("%.1f%%", maxUsage);
+    ImGui::Text("%.1f%%", m_maxUsage);
     
     ImGui::Columns(1);
+    
+    if (m_topology) {
+        ImGui::TextColored(
+            ImGui::ColorConvertU32ToFloat4(Theme::Get().colorTextSecondary),
+            "%s", m_topology->GetFingerprint().c_str()
+        );
+    }
 }
 
 }
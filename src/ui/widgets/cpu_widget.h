@@ -1,7 +1,8 @@
 #pragma once
 #include "base_widget.h"
-#include "../components/custom_graph.h"
+#include "../components/history_graph.h"
 #include "../../monitoring/monitoring_engine.h"
+#include <memory>
 #include <vector>
 
 namespace UI {
@@ -9,7 +10,7 @@ namespace UI {
 class CPUWidget : public BaseWidget {
 public:
     CPUWidget();
-    ~CPUWidget() override = default;
+    ~CPUWidget() override;
     
     void Update(float deltaTime) override;
     void Render() override;
@@ -18,20 +19,34 @@ private:
     void RenderHeader();
     void RenderCoreGraphs();
     void RenderStats();
-    
-    std::vector<GraphSeries> m_usageSeries;
-    std::vector<GraphSeries> m_frequencySeries;
-    std::vector<GraphSeries> m_temperatureSeries;
+    bool ResolveMetrics();
+    void UpdateStats();
     
     enum class DisplayMode {
         Usage,
         Frequency,
-        Temperature
+        Temperature,
+        DeepIdle,
+        Count
     };
     
+    // Per-core columns in the engine's "cpu" history table, one list per
+    // display mode. Resolved once the table exists.
+    std::vector<Monitor::MetricRef> m_coreMetrics[static_cast<int>(DisplayMode::Count)];
+    std::vector<ImU32> m_coreColors;
+    std::vector<HistoryGraphLine> m_lines;
+    
+    std::shared_ptr<const Monitor::CpuTopology> m_topology;
+    
+    // Summary of the latest CPU sample, refreshed when the subscription
+    // reports one.
+    int m_subscription = 0;
+    int m_cpuCount = 0;
+    float m_avgUsage = 0.0f;
+    float m_maxUsage = 0.0f;
+    
     DisplayMode m_displayMode = DisplayMode::Usage;
-    float m_updateTimer = 0.0f;
-    const float m_updateInterval = 1.0f;
+    const float m_historySeconds = 60.0f;
 };
 
 }
@@ -4,28 +4,19 @@
 namespace UI {
 
 GPUWidget::GPUWidget()
-    : BaseWidget("gpu_monitor", "GPU Monitor", WidgetType::GPUMonitor),
-      m_coreClockSeries("Core Clock", IM_COL32(0, 150, 255, 255)),
-      m_memoryClockSeries("Memory Clock", IM_COL32(255, 150, 0, 255)),
-      m_temperatureSeries("Temperature", IM_COL32(255, 0, 100, 255)),
-      m_usageSeries("Usage", IM_COL32(0, 255, 150, 255))
+    : BaseWidget("gpu_monitor", "GPU Monitor", WidgetType::GPUMonitor)
 {
     m_config.size = ImVec2(600, 400);
     m_config.position = ImVec2(640, 20);
 }
 
 void GPUWidget::Update(float deltaTime) {
-    m_updateTimer += deltaTime;
-    
-    if (m_updateTimer >= m_updateInterval) {
-        m_updateTimer = 0.0f;
-        
-        auto gpuInfo = Monitor::MonitoringEngine::Get().GetGPUInfo();
-        
-        m_coreClockSeries.AddPoint(gpuInfo.coreClock);
-        m_memoryClockSeries.AddPoint(gpuInfo.memoryClock);
-        m_temperatureSeries.AddPoint(gpuInfo.temperature);
-        m_usageSeries.AddPoint(gpuInfo.usage);
+    (void)deltaTime;
+    
+    if (!m_coreClock) {
+        const auto& history = Monitor::MonitoringEngine::Get().GetHistory();
+        m_coreClock = history.Find("gpu.coreClock");
+        m_memoryClock = history.Find("gpu.memoryClock");
     }
 }
 
@@ -39,7 +30,8 @@ void GPUWidget::Render() {
     
     ImGui::BeginGroup();
     
-    auto gpuInfo = Monitor::MonitoringEngine::Get().GetGPUInfo();
+    auto snapshot = Monitor::MonitoringEngine::Get().GetSnapshot();
+    const auto& gpuInfo = snapshot->gpu;
     
     ImGui::TextColored(
         ImGui::ColorConvertU32ToFloat4(Theme::Get().colorText),
@@ -48,13 +40,21 @@ void GPUWidget::Render() {
     
     ImGui::Spacing();
     
-    std::vector<GraphSeries> clockSeries = {m_coreClockSeries, m_memoryClockSeries};
-    CustomGraph::Render(
+    int64_t since = Monitor::MetricHistory::NowUs() - static_cast<int64_t>(m_historySeconds * 1e6f);
+    HistoryGraphLine clockLines[2];
+    size_t lineCount = 0;
+    
+    if (m_coreClock) {
+        clockLines[lineCount++] = {m_coreClock.ReadSince(since).values, IM_COL32(0, 150, 255, 255)};
+    }
+    if (m_memoryClock) {
+        clockLines[lineCount++] = {m_memoryClock.ReadSince(since).values, IM_COL32(255, 150, 0, 255)};
+    }
+    
+    HistoryGraph::Render(
         "##gpu_clocks",
-        clockSeries,
+        std::span<const HistoryGraphLine>(clockLines, lineCount),
         ImVec2(contentSize.x * 0.65f - 20, 150),
-        GraphType::Line,
-        true,
         0.0f,
         3000.0f
     );
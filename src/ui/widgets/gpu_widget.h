@@ -1,6 +1,6 @@
 #pragma once
 #include "base_widget.h"
-#include "../components/custom_graph.h"
+#include "../components/history_graph.h"
 #include "../components/custom_progress.h"
 #include "../../monitoring/monitoring_engine.h"
 
@@ -15,13 +15,10 @@ public:
     void Render() override;
     
 private:
-    GraphSeries m_coreClockSeries;
-    GraphSeries m_memoryClockSeries;
-    GraphSeries m_temperatureSeries;
-    GraphSeries m_usageSeries;
+    Monitor::MetricRef m_coreClock;
+    Monitor::MetricRef m_memoryClock;
     
-    float m_updateTimer = 0.0f;
-    const float m_updateInterval = 1.0f;
+    const float m_historySeconds = 60.0f;
 };
 
 }
@@ -8,13 +8,23 @@ RAMWidget::RAMWidget()
 {
     m_config.size = ImVec2(400, 250);
     m_config.position = ImVec2(20, 440);
+    
+    auto& engine = Monitor::MonitoringEngine::Get();
+    m_subscription = engine.Subscribe(Monitor::CollectorBit(Monitor::CollectorId::RAM));
+    m_ram = engine.GetSnapshot()->ram;
+}
+
+RAMWidget::~RAMWidget() {
+    Monitor::MonitoringEngine::Get().Unsubscribe(m_subscription);
 }
 
 void RAMWidget::Update(float deltaTime) {
-    m_updateTimer += deltaTime;
+    (void)deltaTime;
     
-    if (m_updateTimer >= m_updateInterval) {
-        m_updateTimer = 0.0f;
+    // Copies only when the RAM collector published since the last frame.
+    auto& engine = Monitor::MonitoringEngine::Get();
+    if (engine.PollSubscription(m_subscription)) {
+        m_ram = engine.GetSnapshot()->ram;
     }
 }
 
@@ -28,7 +38,7 @@ void RAMWidget::Render() {
     
     ImGui::BeginGroup();
     
-    auto ramInfo = Monitor::MonitoringEngine::Get().GetRAMInfo();
+    const auto& ramInfo = m_ram;
     
     ImGui::TextColored(
         ImGui::ColorConvertU32ToFloat4(Theme::Get().colorText),
@@ -8,14 +8,14 @@ namespace UI {
 class RAMWidget : public BaseWidget {
 public:
     RAMWidget();
-    ~RAMWidget() override = default;
+    ~RAMWidget() override;
     
     void Update(float deltaTime) override;
     void Render() override;
     
 private:
-    float m_updateTimer = 0.0f;
-    const float m_updateInterval = 1.0f;
+    int m_subscription = 0;
+    Monitor::RAMInfo m_ram{};
 };
 
 }